@@ -46,10 +46,23 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   if (page->IsDirty())
     FlushPage(r_page_id);
   // 3.     Delete R from the page table and insert P.
+  replacer_->Pin(frame_id);
   page_table_.erase(r_page_id);
   page_table_[page_id] = frame_id;
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  disk_manager_->ReadPage(page_id, page->data_);
+  bool compressed;
+  if (!disk_manager_->ReadPage(page_id, page->data_, &compressed)) {
+    // 校验失败的页不能交给上层使用，归还该帧
+    page_table_.erase(page_id);
+    page->ResetMemory();
+    page->page_id_ = INVALID_PAGE_ID;
+    page->pin_count_ = 0;
+    page->is_dirty_ = false;
+    free_list_.push_back(frame_id);
+    return nullptr;
+  }
+  if (compressed)
+    compressed_pages_.insert(page_id);
   page->pin_count_ = 1;
   page->page_id_ = page_id;
   page->is_dirty_ = false;
@@ -69,15 +82,34 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
     frame_id = free_list_.front();
     free_list_.pop_front();
   } else {
-    frame_id = replacer_->Victim(&frame_id);
+    replacer_->Victim(&frame_id);
   }
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   p = &pages_[frame_id];
+  if (p->IsDirty())
+    FlushPage(p->page_id_);
+  page_table_.erase(p->page_id_);  // 被替换的页不能继续留在 page table 中
+  replacer_->Pin(frame_id);
   p->ResetMemory();
   p->pin_count_ = 1;
   p->is_dirty_ = false;
   // 4.   Set the page ID output parameter. Return a pointer to P.
   page_id = disk_manager_->AllocatePage();
+  // 无锁读取的 b+ 树读者可能在页被释放后取入了它，此时沿用它所在的帧，读者 unpin 的仍是同一帧
+  auto iter = page_table_.find(page_id);
+  if (iter != page_table_.end()) {
+    p->pin_count_ = 0;
+    p->page_id_ = INVALID_PAGE_ID;
+    free_list_.push_back(frame_id);
+    frame_id = iter->second;
+    p = &pages_[frame_id];
+    replacer_->Pin(frame_id);
+    p->ResetMemory();
+    p->pin_count_++;
+    p->is_dirty_ = false;
+    compressed_pages_.erase(page_id);
+    return p;
+  }
   p->page_id_ = page_id;
   page_table_[page_id] = frame_id;
   return p;
@@ -88,16 +120,24 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
-  if (page_table_.find(page_id) == page_table_.end())
+  if (page_table_.find(page_id) == page_table_.end()) {
+    // 不在缓冲池中的页（从未读入或已被换出）同样要在磁盘上释放
+    compressed_pages_.erase(page_id);
+    DeallocatePage(page_id);
     return true;
+  }
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   auto page = &pages_[page_table_[page_id]];
   if (page->pin_count_ > 0)
     return false;
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  // 空闲的帧不能再被 replacer 选中
+  replacer_->Pin(page_table_[page_id]);
   free_list_.emplace_back(page_table_[page_id]);
   page_table_.erase(page_id);
+  compressed_pages_.erase(page_id);  // 该页号再次分配时可能属于其它对象
   page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
   page->is_dirty_ = false;
   DeallocatePage(page_id);
   return true;
@@ -110,11 +150,11 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {   //取消
   Page* p = &pages_[page_table_[page_id]];
   if (is_dirty)
     FlushPage(page_id);
-  replacer_->Unpin(page_table_[page_id]);
   if (p->pin_count_ > 0)
     p->pin_count_--;
-  else
-    p->pin_count_ = 0;
+  // 只有没有任何使用者时才能被替换
+  if (p->pin_count_ == 0)
+    replacer_->Unpin(page_table_[page_id]);
   return true;
 }
 
@@ -124,7 +164,7 @@ bool BufferPoolManager::FlushPage(page_id_t page_id) {  //将数据页转储到
     return false;
   if (page_table_.find(page_id) != page_table_.end()) {
     auto page = &pages_[page_table_[page_id]];
-    disk_manager_->WritePage(page_id, page->data_);
+    disk_manager_->WritePage(page_id, page->data_, compressed_pages_.count(page_id) != 0);
     return true;
   }
   return false;
@@ -143,6 +183,11 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
   return disk_manager_->IsPageFree(page_id);
 }
 
+void BufferPoolManager::SetCompressed(page_id_t page_id) {
+  lock_guard<recursive_mutex> lock_guard(latch_);
+  compressed_pages_.insert(page_id);
+}
+
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
   bool res = true;
@@ -75,7 +75,9 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
       auto table_heap = TableHeap::Create(buffer_pool_manager_,
                                           (int)table_meta->GetFirstPageId(),
                                           table_meta->GetSchema(),
-                                          log_manager_, lock_manager_, heap);
+                                          log_manager_, lock_manager_, heap,
+                                          table_meta->GetLayout(), table_meta->GetDictionaries(),
+                                          table_meta->GetCompression());
       auto table_info = TableInfo::Create(heap);
       table_info->Init(table_meta, table_heap);
       table_names_.insert(std::make_pair(table_meta->GetTableName(), page.first));
@@ -109,15 +111,18 @@ CatalogManager::~CatalogManager() {
 }
 
 dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema,
-                                    Transaction *txn, TableInfo *&table_info) {
+                                    Transaction *txn, TableInfo *&table_info, TableLayout layout,
+                                    const std::vector<uint32_t> &dictionary_columns, TableCompression compression) {
   if (table_names_.find(table_name) != table_names_.end()) {    //输入表名已存在
     return DB_TABLE_ALREADY_EXIST;
   }
   page_id_t page_id;
   auto page = buffer_pool_manager_->NewPage(page_id);
   auto heap = new SimpleMemHeap();
-  auto table_heap = TableHeap::Create(buffer_pool_manager_, schema, nullptr, log_manager_, lock_manager_, heap);
-  auto table_meta = TableMetadata::Create(catalog_meta_->GetNextTableId(), table_name, table_heap->GetFirstPageId(), schema, heap); //分配表的空间
+  auto table_heap = TableHeap::Create(buffer_pool_manager_, schema, nullptr, log_manager_, lock_manager_, heap, layout,
+                                      dictionary_columns, compression);
+  auto table_meta = TableMetadata::Create(catalog_meta_->GetNextTableId(), table_name, table_heap->GetFirstPageId(), schema, heap, layout,
+                                          table_heap->GetDictionaryColumns(), compression); //分配表的空间
   table_info = TableInfo::Create(heap); //通过堆维护表的相关信息
   table_info->Init(table_meta, table_heap);
   table_names_.insert(std::make_pair(table_name, table_meta->GetTableId()));
@@ -160,11 +165,12 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   // bruh
   auto columns = table_info->GetSchema()->GetColumns();
   size_t size = key_map.size();
+  // 含有唯一列的 key 一定唯一，否则 key 之后附加 row id 建立非唯一索引
+  bool unique = false;
   for (auto &key : index_keys) {
     for (uint32_t i = 0; i < columns.size(); i++) {
       if (columns[i]->GetName() == key) {
-        if (!columns[i]->IsUnique())
-          return DB_FAILED;
+        unique = unique || columns[i]->IsUnique();
         key_map.emplace_back(i);
       }
     }
@@ -173,9 +179,32 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
     }
     size++;
   }
-  auto index_meta = IndexMetadata::Create(catalog_meta_->GetNextIndexId(), index_name, table_info->GetTableId(), key_map, heap);
+  // 选择能容纳所有 key 的最小的 key 类型
+  auto key_type = ChooseIndexKeyType(Schema::ShallowCopySchema(table_info->GetSchema(), key_map, heap), unique);
+  if (key_type == kKeyInvalid)
+    return DB_KEY_TOO_LONG;
+  auto index_meta = IndexMetadata::Create(catalog_meta_->GetNextIndexId(), index_name, table_info->GetTableId(), key_map,
+                                          heap, key_type, unique);
   index_info = IndexInfo::Create(heap);
   index_info->Init(index_meta, table_info, buffer_pool_manager_);
+  // 扫描整张表，排序后自底向上建树，建好之后才登记到 catalog，失败时不留下空索引
+  auto result = index_info->GetIndex()->BulkLoad([&](const IndexEntryEmitter &emit) {
+    vector<Field> fields;
+    for (auto iter = table_info->GetTableHeap()->Begin(nullptr);
+         iter != table_info->GetTableHeap()->End(); ++iter) {
+      for (auto& i : key_map) {
+        fields.emplace_back(*iter->GetField(i));
+      }
+      emit(Row(fields), (*iter).GetRowId());
+      fields.clear();
+    }
+  }, txn);
+  if (result != DB_SUCCESS) {
+    index_info->GetIndex()->Destroy();
+    delete index_info;
+    index_info = nullptr;
+    return result;
+  }
   index_names_[table_name].insert(std::make_pair(index_name, index_meta->GetIndexId()));
   indexes_.insert(std::make_pair(index_meta->GetIndexId(), index_info));
   page_id_t page_id;
@@ -185,16 +214,6 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   index_meta->SerializeTo(page->GetData());
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page_id, true);
-
-  vector<Field> fields;
-  for (auto iter = table_info->GetTableHeap()->Begin(nullptr);
-       iter != table_info->GetTableHeap()->End(); ++iter) {
-    for (auto& i : key_map) {
-      fields.emplace_back(*iter->GetField(i));
-    }
-    index_info->GetIndex()->InsertEntry(Row(fields), (*iter).GetRowId(), nullptr);
-    fields.clear();
-  }
   return DB_SUCCESS;
 }
 
@@ -224,16 +243,19 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
     return DB_TABLE_NOT_EXIST;
   }
   auto table_info = tables_[table_names_[table_name]];
+  // DropIndex 会从 index_names_ 中删除，先取出所有索引名
+  vector<string> index_names;
   for (auto &index_id : index_names_[table_name]) {
-    DropIndex(table_name, index_id.first);
+    index_names.emplace_back(index_id.first);
   }
+  for (auto &index_name : index_names) {
+    DropIndex(table_name, index_name);
+  }
+  index_names_.erase(table_name);
   auto page_id = catalog_meta_->GetTableMetaPages()->at(table_info->GetTableId());
   buffer_pool_manager_->DeletePage(page_id);
   auto table_heap = table_info->GetTableHeap();
-  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
-    auto page = iter->GetRowId().GetPageId();
-    buffer_pool_manager_->DeletePage(page);
-  }
+  table_heap->FreeHeap();  // 边遍历边删除页会读到已释放的页
   delete table_info;
   tables_.erase(table_names_[table_name]);
   catalog_meta_->GetTableMetaPages()->erase(table_names_[table_name]);
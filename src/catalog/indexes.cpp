@@ -2,9 +2,9 @@
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name,
                                      const table_id_t table_id, const vector<uint32_t> &key_map,
-                                     MemHeap *heap) {
+                                     MemHeap *heap, IndexKeyType key_type, bool unique) {
   void *buf = heap->Allocate(sizeof(IndexMetadata));
-  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map);
+  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map, key_type, unique);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -24,11 +24,15 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_UINT32(buf + offset, key_id);
     offset += sizeof(uint32_t);
   }
+  MACH_WRITE_UINT32(buf + offset, key_type_);
+  offset += sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf + offset, !unique_);
+  offset += sizeof(uint32_t);
   return offset;
 }
 
 uint32_t IndexMetadata::GetSerializedSize() const {
-  return sizeof(uint32_t) * 5 + index_name_.size() + sizeof(uint32_t) * key_map_.size(); //与上述过程一致
+  return sizeof(uint32_t) * 7 + index_name_.size() + sizeof(uint32_t) * key_map_.size(); //与上述过程一致
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, MemHeap *heap) {
@@ -50,6 +54,10 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, M
     offset += sizeof(uint32_t);
     key_map.emplace_back(key_id);
   }
-  index_meta = IndexMetadata::Create(index_id, index_name, table_id, key_map, heap);
+  auto key_type = static_cast<IndexKeyType>(MACH_READ_UINT32(buf + offset));  // 旧的元数据页此处为 0
+  offset += sizeof(uint32_t);
+  bool unique = MACH_READ_UINT32(buf + offset) == 0;  // 旧的索引都是唯一索引，元数据页此处为 0
+  offset += sizeof(uint32_t);
+  index_meta = IndexMetadata::Create(index_id, index_name, table_id, key_map, heap, key_type, unique);
   return offset;
 }
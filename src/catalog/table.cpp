@@ -13,12 +13,25 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   offset += sizeof(int32_t);
   schema_->SerializeTo(buf + offset);
   offset += schema_->GetSerializedSize();   // offset相当于内存往前推进的大小
+  MACH_WRITE_UINT32(buf + offset, layout_);
+  offset += sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf + offset, dictionaries_.size());  // 字典列的个数及每个字典的首页
+  offset += sizeof(uint32_t);
+  for (auto &dictionary : dictionaries_) {
+    MACH_WRITE_UINT32(buf + offset, dictionary.column_idx_);
+    offset += sizeof(uint32_t);
+    MACH_WRITE_INT32(buf + offset, dictionary.first_page_id_);
+    offset += sizeof(int32_t);
+  }
+  MACH_WRITE_UINT32(buf + offset, compression_);
+  offset += sizeof(uint32_t);
   return offset;
 }
 
 uint32_t TableMetadata::GetSerializedSize() const {
   return sizeof(uint32_t) + sizeof(uint32_t) + table_name_.size() +
-         sizeof(int32_t) + schema_->GetSerializedSize();  // 根据序列化函数offset依次的变化累加即可
+         sizeof(int32_t) + schema_->GetSerializedSize() + sizeof(uint32_t) +
+         sizeof(uint32_t) + dictionaries_.size() * (sizeof(uint32_t) + sizeof(int32_t)) + sizeof(uint32_t);  // 根据序列化函数offset依次的变化累加即可
 }
 
 /**
@@ -40,7 +53,22 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
   auto schema = (Schema*)heap->Allocate(sizeof(Schema));
   Schema::DeserializeFrom(buf + offset, schema, heap);
   offset += schema->GetSerializedSize();
-  table_meta = TableMetadata::Create(table_id, table_name, root_page_id, schema, heap);
+  auto layout = static_cast<TableLayout>(MACH_READ_UINT32(buf + offset));  // 旧的元数据页此处为 0
+  offset += sizeof(uint32_t);
+  uint32_t dictionary_count = MACH_READ_UINT32(buf + offset);
+  offset += sizeof(uint32_t);
+  std::vector<DictionaryColumn> dictionaries;
+  for (uint32_t i = 0; i < dictionary_count; i++) {
+    uint32_t column_idx = MACH_READ_UINT32(buf + offset);
+    offset += sizeof(uint32_t);
+    page_id_t first_page_id = MACH_READ_INT32(buf + offset);
+    offset += sizeof(int32_t);
+    dictionaries.push_back(DictionaryColumn{column_idx, first_page_id});
+  }
+  auto compression = static_cast<TableCompression>(MACH_READ_UINT32(buf + offset));
+  offset += sizeof(uint32_t);
+  table_meta = TableMetadata::Create(table_id, table_name, root_page_id, schema, heap, layout, dictionaries,
+                                     compression);
   return offset;
 }
 
@@ -50,11 +78,16 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name,
-                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap) {
+                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                                     TableLayout layout, const std::vector<DictionaryColumn> &dictionaries,
+                                     TableCompression compression) {
   // allocate space for table metadata
   void *buf = heap->Allocate(sizeof(TableMetadata));
-  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema);
+  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema, layout, dictionaries, compression);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                             TableLayout layout, std::vector<DictionaryColumn> dictionaries,
+                             TableCompression compression)
+        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema),
+          layout_(layout), dictionaries_(std::move(dictionaries)), compression_(compression) {}
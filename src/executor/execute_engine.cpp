@@ -1,5 +1,6 @@
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
+#include "storage/parallel_scan.h"
 
 ExecuteEngine::ExecuteEngine() {
 
@@ -18,6 +19,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       return ExecuteShowDatabases(ast, context);
     case kNodeUseDB:
       return ExecuteUseDatabase(ast, context);
+    case kNodeCheckDB:
+      return ExecuteCheckDatabase(ast, context);
     case kNodeShowTables:
       return ExecuteShowTables(ast, context);
     case kNodeCreateTable:
@@ -175,6 +178,27 @@ dberr_t ExecuteEngine::ExecuteUseDatabase(pSyntaxNode ast, ExecuteContext *conte
   }
 }
 
+dberr_t ExecuteEngine::ExecuteCheckDatabase(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteCheckDatabase" << std::endl;
+#endif
+  if (current_db_.empty()) {
+    printf("No database selected.\n");
+    return DB_FAILED;
+  }
+  // 并行校验所有已分配页的校验和
+  vector<page_id_t> corrupted;
+  clock_t start = clock();
+  uint32_t checked = dbs_[current_db_]->disk_mgr_->CheckPages(corrupted);
+  clock_t end = clock();
+  for (auto page_id : corrupted) {
+    printf("Page %d does not match its checksum.\n", page_id);
+  }
+  printf("%u page(s) checked, %d corrupted in %lf s.\n", checked, static_cast<int>(corrupted.size()),
+         (double)(end - start) / CLOCKS_PER_SEC);
+  return corrupted.empty() ? DB_SUCCESS : DB_FAILED;
+}
+
 dberr_t ExecuteEngine::ExecuteShowTables(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteShowTables" << std::endl;
@@ -242,10 +266,15 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     string name(column_list->child_->val_);
     string type(column_list->child_->next_->val_);
     float length = 0;
-    if (type == "char") {
+    if (type == "char" || type == "varchar") {
+      if (column_list->child_->next_->child_ == nullptr) {
+        printf("Invalid char length.\n");
+        return DB_FAILED;
+      }
       length = stof(column_list->child_->next_->child_->val_);
       if (length <= -numeric_limits<float>::epsilon()  // negative
-          || fabs(length-(int)length) > numeric_limits<float>::epsilon()) {  // not int
+          || fabs(length-(int)length) > numeric_limits<float>::epsilon()  // not int
+          || length >= VARCHAR_MAX_LEN) {  // too long
         printf("Invalid char length.\n");
         return DB_FAILED;
       }
@@ -256,25 +285,84 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
       columns.emplace_back(new Column(name, kTypeChar,
                                       static_cast<uint32_t>(length), index++,
                                       !is_primary, is_unique));
+    } else if (type == "varchar") {
+      columns.emplace_back(new Column(name, kTypeVarchar,
+                                      static_cast<uint32_t>(length), index++,
+                                      !is_primary, is_unique));
     } else if (type == "int") {
       columns.emplace_back(new Column(name, kTypeInt,
                                       index++, !is_primary, is_unique));
-    } else {
+    } else if (type == "float") {
       columns.emplace_back(new Column(name, kTypeFloat,
                                       index++, !is_primary, is_unique));
+    } else if (type == "bigint") {
+      columns.emplace_back(new Column(name, kTypeBigInt,
+                                      index++, !is_primary, is_unique));
+    } else if (type == "double") {
+      columns.emplace_back(new Column(name, kTypeDouble,
+                                      index++, !is_primary, is_unique));
+    } else if (type == "date") {
+      columns.emplace_back(new Column(name, kTypeDate,
+                                      index++, !is_primary, is_unique));
+    } else if (type == "timestamp") {
+      columns.emplace_back(new Column(name, kTypeTimestamp,
+                                      index++, !is_primary, is_unique));
+    } else {
+      printf("Unknown column type %s.\n", type.c_str());
+      return DB_FAILED;
     }
     column_list = column_list->next_;
   }
+  // table options: with (layout = pax, dictionary = column, compression = lz)
+  TableLayout layout = kLayoutNSM;
+  TableCompression compression = kCompressionNone;
+  vector<uint32_t> dictionary_columns;
+  if (ast->child_->next_->next_) {
+    auto option = ast->child_->next_->next_->child_;
+    while (option) {
+      string option_name(option->child_->val_);
+      string option_value(option->child_->next_->val_);
+      auto column = find_if(columns.begin(), columns.end(), [&](Column *c) { return c->GetName() == option_value; });
+      if (option_name == "layout" && (option_value == "pax" || option_value == "nsm")) {
+        layout = option_value == "pax" ? kLayoutPAX : kLayoutNSM;
+      } else if (option_name == "compression" && (option_value == "lz" || option_value == "none")) {
+        compression = option_value == "lz" ? kCompressionLZ : kCompressionNone;
+      } else if (option_name == "dictionary" && column != columns.end() && Type::IsCharType((*column)->GetType()) &&
+                 find(dictionary_columns.begin(), dictionary_columns.end(), column - columns.begin()) ==
+                 dictionary_columns.end()) {
+        // 取值较少的 char 列按字典编码存储
+        dictionary_columns.push_back(column - columns.begin());
+      } else {
+        printf("Invalid table option %s = %s.\n", option_name.c_str(), option_value.c_str());
+        return DB_FAILED;
+      }
+      option = option->next_;
+    }
+  }
+  auto schema = new Schema(columns);
+  if (layout == kLayoutPAX && PaxLayout(schema).GetCapacity() == 0) {
+    printf("Row of table %s is too large for pax layout.\n", table_name.c_str());
+    return DB_FAILED;
+  }
   // create table
-  db->catalog_mgr_->CreateTable(table_name, new Schema(columns),
-                                nullptr, table_info);
+  db->catalog_mgr_->CreateTable(table_name, schema,
+                                nullptr, table_info, layout, dictionary_columns, compression);
   // 针对 unique 的列创建索引
   for (auto & column : columns) {
     if (column->IsUnique()) {
       IndexInfo* index_info = nullptr;
       vector<string> key(1, column->GetName());
-      db->catalog_mgr_->CreateIndex(table_name, column->GetName(),
-                                    key, nullptr, index_info);
+      auto dberr = db->catalog_mgr_->CreateIndex(table_name, column->GetName(), key, nullptr, index_info);
+      if (dberr != DB_SUCCESS) {
+        // 没有索引就无法保证 unique，整张表不创建
+        if (dberr == DB_KEY_TOO_LONG)
+          printf("Cannot create index on column %s, its values are too long.\n", column->GetName().c_str());
+        else
+          printf("Failed to create index on column %s.\n", column->GetName().c_str());
+        db->catalog_mgr_->DropTable(table_name);
+        printf("Table %s is not created.\n", table_name.c_str());
+        return dberr;
+      }
     }
   }
   clock_t end = clock();
@@ -377,9 +465,18 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     keys_ = keys_->next_;
   }
   auto dberr = db->catalog_mgr_->CreateIndex(table_name, index_name, keys, nullptr, index_info);
-  if (dberr == DB_FAILED) {
-    printf("Cannot create index %s on un-unique key.\n", index_name.c_str());
-    return DB_FAILED;
+  if (dberr == DB_KEY_TOO_LONG) {
+    printf("Cannot create index %s on key longer than 256 bytes.\n", index_name.c_str());
+    return dberr;
+  } else if (dberr == DB_TABLE_NOT_EXIST) {
+    printf("Table %s does not exist.\n", table_name.c_str());
+    return dberr;
+  } else if (dberr == DB_COLUMN_NAME_NOT_EXIST) {
+    printf("Some key of index %s is not a column of table %s.\n", index_name.c_str(), table_name.c_str());
+    return dberr;
+  } else if (dberr != DB_SUCCESS) {
+    printf("Failed to create index %s.\n", index_name.c_str());
+    return dberr;
   }
   clock_t end = clock();
   printf("Index %s created in %lf s.\n", index_name.c_str(), (double)(end - start) / CLOCKS_PER_SEC);
@@ -419,206 +516,285 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context
   return DB_SUCCESS;
 }
 
-using INDEX_KEY_TYPE = GenericKey<32>;
-using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
-using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
-
 /**
- * 用于执行 where 的查询
- * @param condition 需要操作的
- * @param range 搜索的范围，如果为空就是全局，不然就是在 range 中进行搜索
- * @param info 表的信息，用于类型判断
- * @param indexes 索引，用于加速搜索
- * @return
+ * 将字面量转换为 column 类型的 field 并追加到 fields 中，char 值补 0 到列的长度，varchar 值保持原长
+ * @return 日期或时间的格式不正确，或者字符串超过列的长度时返回 false
  */
-dberr_t ExecuteQuery(pSyntaxNode& condition, vector<RowId>& range, TableInfo* info, vector<IndexInfo*> indexes) {
-  IndexInfo* idx = nullptr;
-  // 寻找用于加速的索引
-  for (auto& index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumn(0)->GetName() == condition->child_->val_ &&
-        index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      idx = index;
+static bool ParseValue(const Column *column, const string &value, vector<Field> &fields) {
+  switch (column->GetType()) {
+    case kTypeInt:
+      fields.emplace_back(Field(kTypeInt, stoi(value)));
+      break;
+    case kTypeFloat:
+      fields.emplace_back(Field(kTypeFloat, stof(value)));
+      break;
+    case kTypeBigInt:
+      fields.emplace_back(Field(kTypeBigInt, static_cast<int64_t>(stoll(value))));
+      break;
+    case kTypeDouble:
+      fields.emplace_back(Field(kTypeDouble, stod(value)));
       break;
+    case kTypeDate: {
+      int32_t days;
+      if (!TypeDate::Parse(value.c_str(), days)) {
+        printf("Invalid date %s, expect yyyy-mm-dd.\n", value.c_str());
+        return false;
+      }
+      fields.emplace_back(Field(kTypeDate, days));
+      break;
+    }
+    case kTypeTimestamp: {
+      int64_t micros;
+      if (!TypeTimestamp::Parse(value.c_str(), micros)) {
+        printf("Invalid timestamp %s, expect yyyy-mm-dd hh:mm:ss.\n", value.c_str());
+        return false;
+      }
+      fields.emplace_back(Field(kTypeTimestamp, micros));
+      break;
+    }
+    default: {
+      if (value.size() > column->GetLength()) {
+        printf("Value %s is too long for column %s.\n", value.c_str(), column->GetName().c_str());
+        return false;
+      }
+      string padded(value);
+      if (column->GetType() == kTypeChar)
+        padded.resize(column->GetLength(), '\0');
+      fields.emplace_back(Field(column->GetType(), const_cast<char *>(padded.data()),
+                                static_cast<uint32_t>(padded.size()), true));
     }
   }
+  return true;
+}
+
+/**
+ * 用于执行 where 的一个条件
+ * @param condition 需要操作的
+ * @param range 搜索的范围，global 时忽略它在全表中搜索，不然就是在 range 中进行搜索
+ * @param info 表的信息，用于类型判断
+ * @return 列不存在或者值的格式不正确时失败，并输出错误信息
+ */
+dberr_t ExecuteQuery(pSyntaxNode& condition, vector<RowId>& range, bool global, TableInfo* info) {
   uint32_t column_idx;
-  if (info->GetSchema()->GetColumnIndex(condition->child_->val_, column_idx) == DB_COLUMN_NAME_NOT_EXIST)
-    return DB_FAILED;
+  if (info->GetSchema()->GetColumnIndex(condition->child_->val_, column_idx) == DB_COLUMN_NAME_NOT_EXIST) {
+    printf("Not exist column name %s.\n", condition->child_->val_);
+    return DB_COLUMN_NAME_NOT_EXIST;
+  }
   auto column = info->GetSchema()->GetColumn(column_idx);
   vector<Field> key_value;
   // 构造用于搜索的 keys
   if (condition->child_->next_->type_ != kNodeNull) {
-    char* value = (char*)malloc(column->GetLength()+1);
-    memset(value, 0, column->GetLength()+1);
-    strcpy(value, condition->child_->next_->val_);
-    if (column->GetType() == kTypeInt)
-      key_value.emplace_back(Field(kTypeInt, stoi(value)));
-    else if (column->GetType() == kTypeFloat)
-      key_value.emplace_back(Field(kTypeFloat, stof(value)));
-    else if (column->GetType() == kTypeChar)
-      key_value.emplace_back(Field(kTypeChar, value, column->GetLength(), true));
+    if (!ParseValue(column, condition->child_->next_->val_, key_value))
+      return DB_FAILED;
   } else {
     key_value.emplace_back(Field(column->GetType()));
   }
 
-  if (range.empty() && idx && strcmp(condition->val_, "<>") != 0) {
-    // 全局搜索并且不是不等于的搜索
-    auto btreeidx = reinterpret_cast<BP_TREE_INDEX*>(idx->GetIndex());
-    INDEX_KEY_TYPE key;
-    key.SerializeFromKey(Row(key_value), idx->GetIndexKeySchema());
-    // 使用索引的各种情况的搜索
-    if (strcmp(condition->val_, "=") == 0) {
-      btreeidx->ScanKey(Row(key_value), range, nullptr);
-    } else if (strcmp(condition->val_, ">") == 0) {
-      bool it = true;
-      for (auto iter = btreeidx->GetBeginIterator(key); iter != btreeidx->GetEndIterator(); ++iter) {
-        if (it) {
-          it = false;
-          continue;
-        }
-        range.emplace_back((*iter).second);
-      }
-    } else if (strcmp(condition->val_, "<") == 0) {
-      for (auto iter = btreeidx->GetBeginIterator(); iter != btreeidx->GetBeginIterator(key); ++iter) {
-        range.emplace_back((*iter).second);
-      }
-    } else if (strcmp(condition->val_, ">=") == 0) {
-      for (auto iter = btreeidx->GetBeginIterator(key); iter != btreeidx->GetEndIterator(); ++iter) {
-        range.emplace_back((*iter).second);
-      }
-    } else if (strcmp(condition->val_, "<=") == 0) {
-      for (auto iter = btreeidx->GetBeginIterator(); iter != btreeidx->GetBeginIterator(key); ++iter) {
-        range.emplace_back((*iter).second);
+  if (global) {
+    // 全局搜索，多线程并行扫描，根据 zone map 跳过不可能满足条件的页
+    // 每个线程按 batch 读取条件涉及的一列并批量求值
+    auto table_heap = info->GetTableHeap();
+    const char *op = condition->val_;
+    range = ParallelScan(table_heap).Filter(
+        [&](page_id_t page_id) { return table_heap->GetZoneMap().MayMatch(page_id, column_idx, op, key_value[0]); },
+        column_idx, op, key_value[0], nullptr);
+  } else {
+    // 针对特定范围的遍历搜索，按 batch 读取上一次的结果
+    vector<RowId> new_range;
+    RowBatch batch(info->GetSchema(), {column_idx});
+    auto consume = [&](RowBatch &full) {
+      full.Filter(0, condition->val_, key_value[0]);
+      for (uint32_t i = 0; i < full.GetSelectedCount(); i++) {
+        new_range.emplace_back(full.GetRowId(full.GetSelection()[i]));
       }
-      range.emplace_back((*btreeidx->GetBeginIterator(key)).second);
-    } else {
+    };
+    info->GetTableHeap()->FetchBatch(range, batch, consume, nullptr);
+    if (batch.GetSize() > 0)
+      consume(batch);
+    range = new_range;
+  }
+  return DB_SUCCESS;
+}
+
+/**
+ * 搜索 and 连接的一组条件，结果写入 range
+ * 选出用上条件最多的索引：key 的前几列都有等值条件，下一列还可以有上下界，例如索引 (tenant_id, created_at)
+ * 上的 tenant_id = 1 and created_at >= 5 and created_at < 9 只扫描索引中的一段，其余的条件在扫描到的行上逐个过滤
+ * @return 列不存在或者值的格式不正确时失败，并输出错误信息
+ */
+static dberr_t ExecuteConjunction(vector<pSyntaxNode> &conditions, vector<RowId> &range, TableInfo *info,
+                                  const vector<IndexInfo *> &indexes) {
+  // 能用索引加速的条件：等值或范围比较，值不为 null
+  vector<uint32_t> columns(conditions.size());
+  vector<vector<Field>> values(conditions.size());
+  for (size_t i = 0; i < conditions.size(); i++) {
+    auto condition = conditions[i];
+    if (info->GetSchema()->GetColumnIndex(condition->child_->val_, columns[i]) != DB_SUCCESS) {
+      printf("Not exist column name %s.\n", condition->child_->val_);
+      return DB_COLUMN_NAME_NOT_EXIST;
+    }
+    const char *op = condition->val_;
+    if (condition->child_->next_->type_ == kNodeNull || strcmp(op, "<>") == 0 || strcmp(op, "is") == 0 ||
+        strcmp(op, "not") == 0)
+      continue;
+    if (!ParseValue(info->GetSchema()->GetColumn(columns[i]), condition->child_->next_->val_, values[i]))
       return DB_FAILED;
+  }
+  auto find = [&](uint32_t column, const char *op) {
+    for (size_t i = 0; i < conditions.size(); i++) {
+      if (!values[i].empty() && columns[i] == column && strncmp(conditions[i]->val_, op, strlen(op)) == 0)
+        return static_cast<int>(i);
     }
-
-  } else if (range.empty()){
-    // 无索引的全局搜索或不等于搜索
-    if (strcmp(condition->val_, "=") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter!= info->GetTableHeap()->End(); ++iter) {
-        if ((*iter).GetField(column_idx)->CompareEquals(key_value[0]) == CmpBool::kTrue) {
-          range.emplace_back(iter->GetRowId());
-        }
-      }
-    } else if (strcmp(condition->val_, ">") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter!= info->GetTableHeap()->End(); ++iter) {
-        if ((*iter).GetField(column_idx)->CompareGreaterThan(key_value[0]) == CmpBool::kTrue) {
-          range.emplace_back(iter->GetRowId());
-        }
-      }
-    } else if (strcmp(condition->val_, "<") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter != info->GetTableHeap()->End(); ++iter) {
-        if ((*iter).GetField(column_idx)->CompareLessThan(key_value[0]) == CmpBool::kTrue) {
-          range.emplace_back(iter->GetRowId());
-        }
-      }
-    } else if (strcmp(condition->val_, ">=") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter!= info->GetTableHeap()->End(); ++iter) {
-        if ((*iter).GetField(column_idx)->CompareGreaterThanEquals(key_value[0]) == CmpBool::kTrue) {
-          range.emplace_back(iter->GetRowId());
-        }
-      }
-    } else if (strcmp(condition->val_, "<=") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter != info->GetTableHeap()->End(); ++iter) {
-        if ((*iter).GetField(column_idx)->CompareLessThanEquals(key_value[0]) == CmpBool::kTrue) {
-          range.emplace_back(iter->GetRowId());
-        }
-      }
-    } else if (strcmp(condition->val_, "<>") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter!= info->GetTableHeap()->End(); ++iter) {
-        if ((*iter).GetField(column_idx)->CompareNotEquals(key_value[0]) == CmpBool::kTrue) {
-          range.emplace_back(iter->GetRowId());
-        }
+    return -1;
+  };
+  IndexInfo *best = nullptr;
+  vector<int> best_equal;
+  int best_lower = -1, best_upper = -1;
+  for (auto index : indexes) {
+    vector<int> equal;
+    int lower = -1, upper = -1;
+    for (auto column : index->GetKeyMapping()) {
+      int i = find(column, "=");
+      if (i < 0) {
+        // 等值前缀之后的一列可以有范围条件
+        lower = find(column, ">");
+        upper = find(column, "<");
+        break;
       }
-    } else if (strcmp(condition->val_, "is") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter!= info->GetTableHeap()->End(); ++iter) {
-        if ((*iter).GetField(column_idx)->IsNull()) {
-          range.emplace_back(iter->GetRowId());
-        }
+      equal.emplace_back(i);
+    }
+    // 等值的列越多越好，其次是范围的上下界越多越好
+    int bounds = (lower >= 0) + (upper >= 0);
+    int best_bounds = (best_lower >= 0) + (best_upper >= 0);
+    if ((!equal.empty() || bounds > 0) && (!best || equal.size() > best_equal.size() ||
+                                           (equal.size() == best_equal.size() && bounds > best_bounds))) {
+      best = index;
+      best_equal = equal;
+      best_lower = lower;
+      best_upper = upper;
+    }
+  }
+  vector<bool> used(conditions.size(), false);
+  bool global = true;
+  if (best) {
+    vector<Field> lo_fields, hi_fields;
+    for (auto i : best_equal) {
+      lo_fields.emplace_back(values[i][0]);
+      hi_fields.emplace_back(values[i][0]);
+      used[i] = true;
+    }
+    bool lo_inclusive = true, hi_inclusive = true;
+    if (best_lower >= 0 || best_upper >= 0) {
+      auto column = best->GetIndexKeySchema()->GetColumn(best_equal.size());
+      if (best_lower >= 0) {
+        lo_fields.emplace_back(values[best_lower][0]);
+        lo_inclusive = strcmp(conditions[best_lower]->val_, ">=") == 0;
+        used[best_lower] = true;
+      } else if (column->IsNullable()) {
+        // null 排在最前面，不满足任何比较，从它们之后开始
+        lo_fields.emplace_back(Field(column->GetType()));
+        lo_inclusive = false;
       }
-    } else if (strcmp(condition->val_, "not") == 0) {
-      for (auto iter = info->GetTableHeap()->Begin(nullptr); iter != info->GetTableHeap()->End(); ++iter) {
-        if (!(*iter).GetField(column_idx)->IsNull()) {
-          range.emplace_back(iter->GetRowId());
-        }
+      if (best_upper >= 0) {
+        hi_fields.emplace_back(values[best_upper][0]);
+        hi_inclusive = strcmp(conditions[best_upper]->val_, "<=") == 0;
+        used[best_upper] = true;
       }
     }
+    Row lo_row(lo_fields), hi_row(hi_fields);
+    best->VisitIndex([&](auto *btreeidx) {
+      // 没有任何列的界就是树的一端
+      for (auto iter = btreeidx->ScanRange(lo_fields.empty() ? nullptr : &lo_row, lo_inclusive,
+                                           hi_fields.empty() ? nullptr : &hi_row, hi_inclusive);
+           iter != btreeidx->GetEndIterator(); ++iter) {
+        range.emplace_back((*iter).second);
+      }
+    });
+    global = false;
+  }
+  for (size_t i = 0; i < conditions.size(); i++) {
+    if (used[i])
+      continue;
+    if (ExecuteQuery(conditions[i], range, global, info) != DB_SUCCESS)
+      return DB_FAILED;
+    global = false;
+  }
+  return DB_SUCCESS;
+}
 
+/**
+ * 执行 where 子句，条件按 or 分成若干组，每组 and 连接的条件的搜索结果放入 row_ids 的一项
+ * @return 任何一个条件失败时失败，并输出错误信息
+ */
+static dberr_t ExecuteWhere(pSyntaxNode where, TableInfo *info, const vector<IndexInfo *> &indexes,
+                            vector<vector<RowId>> &row_ids) {
+  list<pSyntaxNode> conditions;
+  // 将所有的 where 都写入 list
+  while (where->child_) {
+    conditions.emplace_front(where);
+    where = where->child_;
+  }
+  vector<vector<pSyntaxNode>> groups;
+  for (auto condition : conditions) {
+    if (strcmp(condition->val_, "and") != 0 && strcmp(condition->val_, "or") != 0) {
+      // 不是 and 或者 or 的情况，第一个条件
+      if (groups.empty())
+        groups.emplace_back();
+      groups.back().emplace_back(condition);
+    } else if (strcmp(condition->val_, "and") == 0) {
+      // and 情况的条件，和前面的条件一起搜索
+      if (groups.empty())
+        groups.emplace_back();
+      groups.back().emplace_back(condition->child_->next_);
+    } else {
+      // or 情况的条件，新建一个搜索序列
+      groups.emplace_back();
+      groups.back().emplace_back(condition->child_->next_);
+    }
+  }
+  for (auto &group : groups) {
+    row_ids.emplace_back();
+    if (ExecuteConjunction(group, row_ids.back(), info, indexes) != DB_SUCCESS)
+      return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
 
-  } else {
-    // 针对特定范围的遍历搜索
-    vector<RowId> new_range;
-    if (strcmp(condition->val_, "=") == 0) {
-      for (auto iter: range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (r.GetField(column_idx)->CompareEquals(key_value[0]) == CmpBool::kTrue) {
-          new_range.emplace_back(iter);
-        }
-      }
-    } else if (strcmp(condition->val_, ">") == 0) {
-      for (auto iter: range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (r.GetField(column_idx)->CompareGreaterThan(key_value[0]) == CmpBool::kTrue) {
-          new_range.emplace_back(iter);
-        }
-      }
-    } else if (strcmp(condition->val_, "<") == 0) {
-      for (auto iter: range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (r.GetField(column_idx)->CompareLessThan(key_value[0]) == CmpBool::kTrue) {
-          new_range.emplace_back(iter);
-        }
-      }
-    } else if (strcmp(condition->val_, ">=") == 0) {
-      for (auto iter: range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (r.GetField(column_idx)->CompareGreaterThanEquals(key_value[0]) == CmpBool::kTrue) {
-          new_range.emplace_back(iter);
-        }
-      }
-    } else if (strcmp(condition->val_, "<=") == 0) {
-      for (auto iter: range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (r.GetField(column_idx)->CompareLessThanEquals(key_value[0]) == CmpBool::kTrue) {
-          new_range.emplace_back(iter);
-        }
-      }
-    } else if (strcmp(condition->val_, "<>") == 0) {
-      for (auto iter: range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (r.GetField(column_idx)->CompareNotEquals(key_value[0]) == CmpBool::kTrue) {
-          new_range.emplace_back(iter);
-        }
-      }
-    } else if (strcmp(condition->val_, "is") == 0) {
-      for (auto iter: range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (r.GetField(column_idx)->IsNull()) {
-          new_range.emplace_back(iter);
-        }
-      }
-    } else if (strcmp(condition->val_, "not") == 0) {
-      for (auto iter : range) {
-        Row r(iter);
-        info->GetTableHeap()->GetTuple(&r, nullptr);
-        if (!r.GetField(column_idx)->IsNull()) {
-          new_range.emplace_back(iter);
-        }
+/**
+ * 输出 batch 中被选中的行
+ * @return 输出的行数
+ */
+static int PrintBatch(const RowBatch &batch) {
+  for (uint32_t i = 0; i < batch.GetSelectedCount(); i++) {
+    uint32_t row = batch.GetSelection()[i];
+    printf("│");
+    for (uint32_t j = 0; j < batch.GetColumnCount(); j++) {
+      auto &column = batch.GetColumn(j);
+      if (column.IsNull(row)) {
+        printf("NULL      │");
+      } else if (column.GetType() == kTypeInt) {
+        printf("%-10d│", column.GetInts()[row]);
+      } else if (column.GetType() == kTypeFloat) {
+        printf("%-10f│", column.GetFloats()[row]);
+      } else if (column.GetType() == kTypeBigInt) {
+        printf("%-10ld│", column.GetBigInts()[row]);
+      } else if (column.GetType() == kTypeDouble) {
+        printf("%-10f│", column.GetDoubles()[row]);
+      } else if (column.GetType() == kTypeDate) {
+        char buf[TypeDate::MAX_TEXT_LEN];
+        TypeDate::Format(column.GetInts()[row], buf);
+        printf("%-10s│", buf);
+      } else if (column.GetType() == kTypeTimestamp) {
+        char buf[TypeTimestamp::MAX_TEXT_LEN];
+        TypeTimestamp::Format(column.GetBigInts()[row], buf);
+        printf("%-10s│", buf);
+      } else {
+        printf("%-10.*s│", static_cast<int>(column.GetCharLength(row)), column.GetChars(row));
       }
     }
-    range = new_range;
+    printf("\n");
   }
-  return DB_SUCCESS;
+  return static_cast<int>(batch.GetSelectedCount());
 }
 
 dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
@@ -648,48 +824,26 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
     printf("Table %s not found.\n", table_name.c_str());
     return DB_TABLE_NOT_EXIST;
   }
+  // 被投影的列，没有指定时输出所有列
+  vector<uint32_t> projection;
+  for (auto &column_name : column_names) {
+    uint32_t column_idx;
+    if (table_info->GetSchema()->GetColumnIndex(column_name, column_idx) != DB_SUCCESS) {
+      printf("Not exist column name %s.\n", column_name.c_str());
+      return DB_FAILED;
+    }
+    projection.emplace_back(column_idx);
+  }
+  if (column_names.empty()) {
+    for (uint32_t i = 0; i < table_info->GetSchema()->GetColumnCount(); i++)
+      projection.emplace_back(i);
+  }
 
   if (ast->child_->next_->next_) {  // have where clause
     vector<IndexInfo*> indexes;
     db->catalog_mgr_->GetTableIndexes(table_name, indexes);
-    list<pSyntaxNode> conditions;
-    auto where = ast->child_->next_->next_->child_;
-    // 将所有的 where 都写入 list
-    while (where->child_) {
-      conditions.emplace_front(where);
-      where = where->child_;
-    }
-    while (!conditions.empty()) {
-      auto condition = conditions.front();
-      conditions.pop_front();
-      if (strcmp(condition->val_, "and") != 0 && strcmp(condition->val_, "or") != 0) {
-        // 不是 and 或者 or 的情况，进行条件搜索
-        if (row_ids.empty())
-          row_ids.emplace_back(vector<RowId>());
-        if (ExecuteQuery(condition, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", condition->child_->val_);
-          return DB_FAILED;
-        }
-      } else if (strcmp(condition->val_, "and") == 0) {
-        // and 情况的搜索，根据上一次搜索的结果继续搜索
-        if (row_ids.empty())
-          row_ids.emplace_back(vector<RowId>());
-        auto right = condition->child_->next_;
-        if (ExecuteQuery(right, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", right->child_->val_);
-          return DB_FAILED;
-        }
-      } else if (strcmp(condition->val_, "or") == 0) {
-        // or 情况的搜索，新建一个搜索序列开始搜索
-        auto right = condition->child_->next_;
-        vector<RowId> new_row_id;
-        row_ids.emplace_back(new_row_id);
-        if (ExecuteQuery(right, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", right->child_->val_);
-          return DB_FAILED;
-        }
-      }
-    }
+    if (ExecuteWhere(ast->child_->next_->next_->child_, table_info, indexes, row_ids) != DB_SUCCESS)
+      return DB_FAILED;
   }
   // 将所有的搜索序列合在一起进行 or 的操作
   for (auto& row_id : row_ids) {
@@ -734,64 +888,19 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
     }
     printf("──────────┤\n");
   }
+  // 按 batch 读取被投影的列并输出
+  auto table_heap = table_info->GetTableHeap();
+  RowBatch batch(table_info->GetSchema(), projection);
+  auto print = [&](RowBatch &full) { row_count += PrintBatch(full); };
   if (!ast->child_->next_->next_) {
-    for (auto iter = table_info->GetTableHeap()->Begin(nullptr); iter != table_info->GetTableHeap()->End(); ++iter) {
-      printf("│");
-      row_count++;
-      Row r = *iter;
-      if (column_names.empty()) {
-        for (auto& field : r.GetFields()) {
-          if (field->IsNull()) {
-            printf("NULL      │");
-          } else {
-            printf("%-10s│", field->GetData());
-          }
-        }
-        printf("\n");
-      } else {
-        for (auto& column_name : column_names) {
-          uint32_t column_idx;
-          table_info->GetSchema()->GetColumnIndex(column_name, column_idx);
-          auto field = r.GetField(column_idx);
-          if (field->IsNull()) {
-            printf("NULL      │");
-          } else {
-            printf("%-10s│", field->GetData());
-          }
-        }
-        printf("\n");
-      }
+    for (auto page_id : table_heap->GetPageIds()) {
+      table_heap->ScanBatch(page_id, batch, print, nullptr);
     }
   } else {
-    for (auto& row_id : ans) {
-      printf("│");
-      row_count++;
-      Row r(row_id);
-      table_info->GetTableHeap()->GetTuple(&r, nullptr);
-      if (column_names.empty()) {
-        for (auto& field : r.GetFields()) {
-          if (field->IsNull()) {
-            printf("NULL      │");
-          } else {
-            printf("%-10s│", field->GetData());
-          }
-        }
-        printf("\n");
-      } else {
-        for (auto& column_name : column_names) {
-          uint32_t column_idx;
-          table_info->GetSchema()->GetColumnIndex(column_name, column_idx);
-          auto field = r.GetField(column_idx);
-          if (field->IsNull()) {
-            printf("NULL      │");
-          } else {
-            printf("%-10s│", field->GetData());
-          }
-        }
-        printf("\n");
-      }
-    }
+    table_heap->FetchBatch(vector<RowId>(ans.begin(), ans.end()), batch, print, nullptr);
   }
+  if (batch.GetSize() > 0)
+    print(batch);
   clock_t end = clock();
   printf("└");
   if (column_names.empty()) {
@@ -848,8 +957,11 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
   vector<string> unique_col;
   auto column = schema->GetColumns();
   for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
-    if ((types[i] == kNodeNumber && column[i]->GetType() == kTypeChar) ||
-        (types[i] == kNodeString && column[i]->GetType() != kTypeChar) ||
+    // char 和日期时间用字符串表示，其余类型用数字表示
+    bool is_text = Type::IsCharType(column[i]->GetType()) || column[i]->GetType() == kTypeDate ||
+                   column[i]->GetType() == kTypeTimestamp;
+    if ((types[i] == kNodeNumber && is_text) ||
+        (types[i] == kNodeString && !is_text) ||
         (types[i] == kNodeNull && !column[i]->IsNullable())) {
       printf("Invalid type for column %s.\n", column[i]->GetName().c_str());
       return DB_FAILED;
@@ -864,19 +976,10 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
   // 依据 column 信息和构建新的 row
   vector<Field> fields;
   for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
-    char* value = (char*)malloc(schema->GetColumn(i)->GetLength()+1);
-    memset(value, 0, schema->GetColumn(i)->GetLength()+1);
-    strcpy(value, row_values[i].c_str());
     if (types[i] == kNodeNull) {
       fields.emplace_back(Field(column[i]->GetType()));
-    } else if (column[i]->GetType() == kTypeChar) {
-      fields.emplace_back(Field(kTypeChar, value,
-                                column[i]->GetLength(),
-                                (column[i]->GetLength() != 0)));
-    } else if (column[i]->GetType() == kTypeInt) {
-      fields.emplace_back(Field(kTypeInt, stoi(value)));
-    } else {
-      fields.emplace_back(Field(kTypeFloat, stof(value)));
+    } else if (!ParseValue(column[i], row_values[i], fields)) {
+      return DB_FAILED;
     }
   }
   Row r(fields);
@@ -889,6 +992,7 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
     return DB_FAILED;
   }
 
+  vector<IndexInfo *> inserted;
   if (!unique_col.empty()) {
 #ifndef IDX_TEST
     // simper traverse
@@ -920,6 +1024,7 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
             table_heap->ApplyDelete(r.GetRowId(), nullptr);
             return DB_FAILED;
           }
+          inserted.emplace_back(index);
           flag = true;
         }
       }
@@ -931,6 +1036,16 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
     }
 #endif
   }
+  // 唯一列的索引在查重时已经插入，其余的索引（非唯一索引和多列索引）在这里插入
+  for (auto &index : indexes) {
+    if (std::find(inserted.begin(), inserted.end(), index) != inserted.end())
+      continue;
+    vector<Field> index_fields;
+    for (auto &j : index->GetKeyMapping()) {
+      index_fields.emplace_back(*r.GetField(j));
+    }
+    index->GetIndex()->InsertEntry(Row(index_fields), r.GetRowId(), nullptr);
+  }
 
   clock_t end = clock();
   printf("1 row inserted in %lf s.\n", (double)(end - start) / CLOCKS_PER_SEC);
@@ -960,41 +1075,8 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
   vector<IndexInfo*> indexes;
   db->catalog_mgr_->GetTableIndexes(table_name, indexes);
   if (ast->child_->next_) {  // have where clause
-    list<pSyntaxNode> conditions;
-    auto where = ast->child_->next_->child_;
-    while (where->child_) {
-      conditions.emplace_front(where);
-      where = where->child_;
-    }
-    // 同搜索一样的代码和思路
-    while (!conditions.empty()) {
-      auto condition = conditions.front();
-      conditions.pop_front();
-      if (strcmp(condition->val_, "and") != 0 && strcmp(condition->val_, "or") != 0) {
-        if (row_ids.empty())
-          row_ids.emplace_back(vector<RowId>());
-        if (ExecuteQuery(condition, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", condition->child_->val_);
-          return DB_FAILED;
-        }
-      } else if (strcmp(condition->val_, "and") == 0) {
-        if (row_ids.empty())
-          row_ids.emplace_back(vector<RowId>());
-        auto right = condition->child_->next_;
-        if (ExecuteQuery(right, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", right->child_->val_);
-          return DB_FAILED;
-        }
-      } else if (strcmp(condition->val_, "or") == 0) {
-        auto right = condition->child_->next_;
-        vector<RowId> new_row_id;
-        row_ids.emplace_back(new_row_id);
-        if (ExecuteQuery(right, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", right->child_->val_);
-          return DB_FAILED;
-        }
-      }
-    }
+    if (ExecuteWhere(ast->child_->next_->child_, table_info, indexes, row_ids) != DB_SUCCESS)
+      return DB_FAILED;
   }
   for (auto& row_id : row_ids) {
     for (auto& id : row_id) {
@@ -1073,46 +1155,18 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
       return DB_FAILED;
     }
     value_map[index] = values_table->child_->next_->val_;
+    // 先检查一次格式，更新时不会再失败
+    vector<Field> check;
+    if (!ParseValue(table_info->GetSchema()->GetColumn(index), value_map[index], check))
+      return DB_FAILED;
     values_table = values_table->next_;
   }
   // 思路同搜索
   if (ast->child_->next_->next_) {  // have where clause
     vector<IndexInfo*> indexes;
     db->catalog_mgr_->GetTableIndexes(table_name, indexes);
-    list<pSyntaxNode> conditions;
-    auto where = ast->child_->next_->next_->child_;
-    while (where->child_) {
-      conditions.emplace_front(where);
-      where = where->child_;
-    }
-    while (!conditions.empty()) {
-      auto condition = conditions.front();
-      conditions.pop_front();
-      if (strcmp(condition->val_, "and") != 0 && strcmp(condition->val_, "or") != 0) {
-        if (row_ids.empty())
-          row_ids.emplace_back(vector<RowId>());
-        if (ExecuteQuery(condition, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", condition->child_->val_);
-          return DB_FAILED;
-        }
-      } else if (strcmp(condition->val_, "and") == 0) {
-        if (row_ids.empty())
-          row_ids.emplace_back(vector<RowId>());
-        auto right = condition->child_->next_;
-        if (ExecuteQuery(right, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", right->child_->val_);
-          return DB_FAILED;
-        }
-      } else if (strcmp(condition->val_, "or") == 0) {
-        auto right = condition->child_->next_;
-        vector<RowId> new_row_id;
-        row_ids.emplace_back(new_row_id);
-        if (ExecuteQuery(right, row_ids.back(), table_info, indexes) == DB_FAILED) {
-          printf("Not exist column name %s.\n", right->child_->val_);
-          return DB_FAILED;
-        }
-      }
-    }
+    if (ExecuteWhere(ast->child_->next_->next_->child_, table_info, indexes, row_ids) != DB_SUCCESS)
+      return DB_FAILED;
   }
   for (auto& row_id : row_ids) {
     for (auto& id : row_id) {
@@ -1141,50 +1195,50 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
       for (uint32_t i = 0; i < table_info->GetSchema()->GetColumnCount(); ++i) {
         // 创建对应的 fields 更新
         if (value_map.find(i) != value_map.end()) {
-          if (table_info->GetSchema()->GetColumn(i)->GetType() == kTypeInt) {
-            fields.emplace_back(Field(kTypeInt, stoi(value_map[i])));
-          } else if (table_info->GetSchema()->GetColumn(i)->GetType() == kTypeFloat) {
-            fields.emplace_back(Field(kTypeFloat, stof(value_map[i])));
-          } else {
-            fields.emplace_back(Field(kTypeChar, (char*)value_map[i].c_str(),
-                                        table_info->GetSchema()->GetColumn(i)->GetLength(), true));
-          }
+          ParseValue(table_info->GetSchema()->GetColumn(i), value_map[i], fields);
         } else {
           fields.emplace_back(*iter->GetField(i));
         }
       }
+      // 对于 index 先删除原先的 entry
+      for (auto &index : indexes) {
+        vector<Field> index_fields;
+        for (auto &i : index->GetKeyMapping()) {
+          index_fields.emplace_back(*iter->GetField(i));
+        }
+        index->GetIndex()->RemoveEntry(Row(index_fields), iter->GetRowId(), nullptr);
+      }
       auto new_row = new Row(fields);
       new_row->SetRowId(iter->GetRowId());
       table_info->GetTableHeap()->UpdateTuple(*new_row, iter->GetRowId(), nullptr);
+      // 更新后的元组可能被移到别的位置，用新的 row id 插入 entry
+      for (auto &index : indexes) {
+        vector<Field> index_fields;
+        for (auto &i : index->GetKeyMapping()) {
+          index_fields.emplace_back(*new_row->GetField(i));
+        }
+        index->GetIndex()->InsertEntry(Row(index_fields), new_row->GetRowId(), nullptr);
+      }
     }
   } else {
     for (auto& r_id : ans) {
       row_count++;
       auto iter = new Row(r_id);
       table_info->GetTableHeap()->GetTuple(iter, nullptr);
-      if (ans.size() == 1) {
-        // 对于 index 先删除原先的 entry
-        for (auto &index : indexes) {
-          auto key_map = index->GetKeyMapping();
-          vector<Field> index_fields;
-          for (auto &i : key_map) {
-            index_fields.emplace_back(*iter->GetField(i));
-          }
-          index->GetIndex()->RemoveEntry(Row(index_fields), iter->GetRowId(), nullptr);
+      // 对于 index 先删除原先的 entry
+      for (auto &index : indexes) {
+        auto key_map = index->GetKeyMapping();
+        vector<Field> index_fields;
+        for (auto &i : key_map) {
+          index_fields.emplace_back(*iter->GetField(i));
         }
+        index->GetIndex()->RemoveEntry(Row(index_fields), iter->GetRowId(), nullptr);
       }
       // 创建对应的 fields 更新
       vector<Field> fields;
       for (uint32_t i = 0; i < table_info->GetSchema()->GetColumnCount(); ++i) {
         if (value_map.find(i) != value_map.end()) {
-          if (table_info->GetSchema()->GetColumn(i)->GetType() == kTypeInt) {
-            fields.emplace_back(Field(kTypeInt, stoi(value_map[i])));
-          } else if (table_info->GetSchema()->GetColumn(i)->GetType() == kTypeFloat) {
-            fields.emplace_back(Field(kTypeFloat, stof(value_map[i])));
-          } else {
-              fields.emplace_back(Field(kTypeChar, (char*)value_map[i].c_str(),
-                                        table_info->GetSchema()->GetColumn(i)->GetLength(), true));
-            }
+          ParseValue(table_info->GetSchema()->GetColumn(i), value_map[i], fields);
         } else {
           fields.emplace_back(*iter->GetField(i));
         }
@@ -1192,16 +1246,14 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
       auto new_row = new Row(fields);
       new_row->SetRowId(iter->GetRowId());
       table_info->GetTableHeap()->UpdateTuple(*new_row, iter->GetRowId(), nullptr);
-      if (ans.size() == 1) {
-        // 更新新的 entry
-        for (auto &index : indexes) {
-          auto key_map = index->GetKeyMapping();
-          vector<Field> index_fields;
-          for (auto &i : key_map) {
-            index_fields.emplace_back(*new_row->GetField(i));
-          }
-          index->GetIndex()->InsertEntry(Row(index_fields), new_row->GetRowId(), nullptr);
+      // 更新新的 entry，多行更新时唯一列已在前面被拒绝
+      for (auto &index : indexes) {
+        auto key_map = index->GetKeyMapping();
+        vector<Field> index_fields;
+        for (auto &i : key_map) {
+          index_fields.emplace_back(*new_row->GetField(i));
         }
+        index->GetIndex()->InsertEntry(Row(index_fields), new_row->GetRowId(), nullptr);
       }
     }
   }
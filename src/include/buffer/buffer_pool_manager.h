@@ -4,6 +4,7 @@
 #include <list>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "buffer/lru_replacer.h"
 #include "page/page.h"
@@ -30,6 +31,12 @@ public:
 
   bool IsPageFree(page_id_t page_id);
 
+  /**
+   * Store the page compressed from now on, see DiskManager::WritePage. Pages read compressed from disk are
+   * marked when they are fetched, owners of compressed pages mark the pages they create or load.
+   */
+  void SetCompressed(page_id_t page_id);
+
   bool CheckAllUnpinned();
 
 private:
@@ -52,6 +59,7 @@ private:
   Replacer *replacer_;                                      // to find an unpinned page for replacement
   std::list<frame_id_t> free_list_;                         // to find a free page for replacement
   recursive_mutex latch_;                                   // to protect shared data structure
+  std::unordered_set<page_id_t> compressed_pages_;          // pages written compressed
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -71,7 +71,12 @@ public:
 
   ~CatalogManager();
 
-  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info);
+  /**
+   * @param dictionary_columns Char columns stored dictionary encoded, see Dictionary
+   */
+  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info,
+                      TableLayout layout = kLayoutNSM, const std::vector<uint32_t> &dictionary_columns = {},
+                      TableCompression compression = kCompressionNone);
 
   dberr_t GetTable(const std::string &table_name, TableInfo *&table_info);
 
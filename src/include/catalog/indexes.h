@@ -2,6 +2,7 @@
 #define MINISQL_INDEXES_H
 
 #include <memory>
+#include <type_traits>
 
 #include "catalog/table.h"
 #include "index/generic_key.h"
@@ -14,7 +15,7 @@ class IndexMetadata {
 public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name,
                                const table_id_t table_id, const std::vector<uint32_t> &key_map,
-                               MemHeap *heap);
+                               MemHeap *heap, IndexKeyType key_type, bool unique = true);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -32,12 +33,18 @@ public:
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  inline IndexKeyType GetKeyType() const { return key_type_; }
+
+  inline bool IsUnique() const { return unique_; }
+
 private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name,
-                         const table_id_t table_id, const std::vector<uint32_t> &key_map)
-                        : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                         const table_id_t table_id, const std::vector<uint32_t> &key_map, IndexKeyType key_type,
+                         bool unique)
+                        : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map),
+                          key_type_(key_type), unique_(unique) {}
 
 private:
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
@@ -45,6 +52,8 @@ private:
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_;  /** The mapping of index key to tuple key */
+  IndexKeyType key_type_;
+  bool unique_;  /** false if the row id is a part of the keys in the tree */
 };
 
 /**
@@ -83,16 +92,30 @@ public:
 
   inline const std::vector<uint32_t> &GetKeyMapping() const { return meta_data_->key_map_; }
 
+  inline IndexKeyType GetKeyType() const { return meta_data_->key_type_; }
+
+  /**
+   * Call func with the index as a pointer to its BPlusTreeIndex type, see DispatchIndexKeyType
+   */
+  template<typename Func>
+  inline auto VisitIndex(Func &&func) {
+    return DispatchIndexKeyType(GetKeyType(), [&](auto *tag) {
+      return func(reinterpret_cast<decltype(tag)>(index_));
+    });
+  }
+
 private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, table_info_{nullptr},
                          key_schema_{nullptr}, heap_(new SimpleMemHeap()) {}
 
   Index *CreateIndex(BufferPoolManager *buffer_pool_manager) {
-    using INDEX_KEY_TYPE = GenericKey<32>;
-    using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
-    using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
-    void *buf = heap_->Allocate(sizeof(BP_TREE_INDEX));
-    return new(buf)BP_TREE_INDEX(meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
+    // 按元数据中的 key 类型实例化对应的 b+ 树
+    return DispatchIndexKeyType(GetKeyType(), [&](auto *tag) -> Index * {
+      using BP_TREE_INDEX = std::remove_pointer_t<decltype(tag)>;
+      void *buf = heap_->Allocate(sizeof(BP_TREE_INDEX));
+      return new(buf)BP_TREE_INDEX(meta_data_->GetIndexId(), key_schema_, buffer_pool_manager,
+                                   meta_data_->IsUnique());
+    });
   }
 
 private:
@@ -18,7 +18,10 @@ public:
   static uint32_t DeserializeFrom(char *buf, TableMetadata *&table_meta, MemHeap *heap);
 
   static TableMetadata *Create(table_id_t table_id, std::string table_name,
-                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap);
+                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                               TableLayout layout = kLayoutNSM,
+                               const std::vector<DictionaryColumn> &dictionaries = {},
+                               TableCompression compression = kCompressionNone);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -28,11 +31,17 @@ public:
 
   inline Schema *GetSchema() const { return schema_; }
 
+  inline TableLayout GetLayout() const { return layout_; }
+
+  inline const std::vector<DictionaryColumn> &GetDictionaries() const { return dictionaries_; }
+
+  inline TableCompression GetCompression() const { return compression_; }
 
 private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                TableLayout layout, std::vector<DictionaryColumn> dictionaries, TableCompression compression);
 
 private:
   static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
@@ -40,6 +49,9 @@ private:
   std::string table_name_;
   page_id_t root_page_id_;
   Schema *schema_;
+  TableLayout layout_;  /** stored after schema, tables created before layouts were introduced read as 0 (NSM) */
+  std::vector<DictionaryColumn> dictionaries_;  /** stored after layout, older tables read a count of 0 */
+  TableCompression compression_;  /** stored after dictionaries, older tables read 0 (none) */
 };
 
 /**
@@ -17,7 +17,11 @@ static constexpr int PAGE_SIZE = 4096;               // size of a data page in b
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 8192;// default size of buffer pool
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;    // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = UINT16_MAX;       // max length of varchar
+static constexpr uint32_t TOAST_THRESHOLD = PAGE_SIZE / 16;   // char values longer than this are stored out of line
+static constexpr uint32_t BATCH_SIZE = 1024;                  // max number of rows in a row batch
+static constexpr double INDEX_FILL_FACTOR = 0.9;              // fraction of each b+ tree page filled by bulk loading
+static constexpr size_t INDEX_BULK_LOAD_MEMORY = 32 << 20;    // bytes of entries sorted in memory by bulk loading
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
@@ -50,6 +50,8 @@ private:
 
   dberr_t ExecuteUseDatabase(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteCheckDatabase(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteShowTables(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *context);
@@ -1,10 +1,15 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
@@ -13,6 +18,11 @@
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * Operation of a writer which descends the tree, decides when a page is safe
+ */
+enum class TreeOperation { kInsert, kRemove };
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
@@ -22,11 +32,21 @@
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Concurrent operations by latch crabbing
+ *
+ * Writers take write latches from the root down and release all ancestors
+ * once a child is safe, that is an insert or remove in it can not split or
+ * merge it. root_latch_ serializes writers which change root_page_id_ and is
+ * released with the ancestors. Leaves are only latched from left to right.
+ * Readers and iterators never latch, they read a page optimistically and
+ * validate its version afterwards (see Page::GetVersion), so lookups do not
+ * write the latches of the root and inner pages which all threads pass.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  friend INDEXITERATOR_TYPE;
 
 public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
@@ -38,6 +58,10 @@ public:
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  // Build this empty B+ tree bottom-up from count pairs in ascending key order,
+  // next returns the pairs one by one, each page is filled to fill_factor.
+  bool BulkLoad(size_t count, const std::function<bool(MappingType &)> &next, double fill_factor);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
@@ -48,10 +72,15 @@ public:
 
   INDEXITERATOR_TYPE Begin(const KeyType &key);
 
+  // iterate the pairs between lo and hi in ascending order, or descending if reverse,
+  // a null bound leaves that side of the range open
+  INDEXITERATOR_TYPE Range(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive,
+                           bool reverse = false);
+
   INDEXITERATOR_TYPE End();
 
-  // expose for test purpose
-  Page *FindLeafPage(const KeyType &key, bool leftMost = false);
+  // expose for test purpose, the leaf page is pinned and read optimistically
+  Page *FindLeafPage(const KeyType &key, uint64_t &version, bool leftMost = false, bool rightMost = false);
 
   // used to check whether all pages are unpinned
   bool Check();
@@ -71,27 +100,52 @@ public:
   }
 
 private:
+  /**
+   * Pages write latched by one insert or remove, released together when it ends
+   */
+  struct LatchContext {
+    bool root_latched_{false};
+    std::deque<Page *> pages_;          // latched and pinned pages
+    std::vector<page_id_t> deleted_;    // pages deleted once all pages are released
+  };
+
+  Page *FindLeafPage(const KeyType &key, bool leftMost, TreeOperation operation, LatchContext *context);
+
+  Page *FindLastLeafPage(const KeyType &key, TreeOperation operation);
+
+  Page *FindLastLeafPage(const KeyType &key, uint64_t &version);
+
+  bool IsSafe(BPlusTreePage *node, TreeOperation operation) const;
+
+  Page *GetLatchedPage(LatchContext &context, page_id_t page_id) const;
+
+  void ReleaseAncestors(LatchContext &context);
+
+  void ReleaseAll(LatchContext &context);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, LatchContext &context);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+                        LatchContext &context);
 
   template<typename N>
-  N *Split(N *node);
+  N *Split(N *node, LatchContext &context, const KeyType *key = nullptr);
+
+  void SetPrevPageId(page_id_t page_id, page_id_t prev_page_id);
 
   template<typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, LatchContext &context);
 
   template<typename N>
   bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+                int index, LatchContext &context);
 
   template<typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, int index, LatchContext &context);
 
-  bool AdjustRoot(BPlusTreePage *node);
+  bool AdjustRoot(BPlusTreePage *node, LatchContext &context);
 
   void UpdateRootPageId(int insert_record = 0);
 
@@ -102,12 +156,17 @@ private:
 
   // member variable
   index_id_t index_id_;
-  page_id_t root_page_id_ = INVALID_PAGE_ID;
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
-  int last_page_id_;
+  // 最近插入的叶子，只在持有该叶子写锁时修改，删除该叶子前清除，因此等于某页时该页一定是本树的叶子
+  std::atomic<page_id_t> last_page_id_{INVALID_PAGE_ID};
+  // 删除时仍被读者 pin 住的页
+  std::mutex deleted_latch_;
+  std::vector<page_id_t> deleted_pages_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
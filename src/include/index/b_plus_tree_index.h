@@ -2,6 +2,7 @@
 #define MINISQL_B_PLUS_TREE_INDEX_H
 
 #include "index/b_plus_tree.h"
+#include "index/generic_key.h"
 #include "index/index.h"
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
@@ -9,7 +10,8 @@
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
 public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
@@ -17,6 +19,14 @@ public:
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
 
+  dberr_t BulkLoad(const IndexEntryScanner &scan, Transaction *txn) override;
+
+  /**
+   * Sort the entries of scan in runs of at most memory_budget bytes, spill the runs to temporary files
+   * and merge them, then build the tree bottom-up with each page filled to fill_factor
+   */
+  dberr_t BulkLoad(const IndexEntryScanner &scan, Transaction *txn, double fill_factor, size_t memory_budget);
+
   dberr_t Destroy() override;
 
   INDEXITERATOR_TYPE GetBeginIterator();
@@ -25,11 +35,83 @@ public:
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  /**
+   * Iterate the entries whose keys lie between lo and hi, in key order or in reverse order. A null bound
+   * leaves that side of the range open. A bound of the first columns of the key schema compares with the
+   * same columns of the keys, eg: (a, b) >= (1) starts from the first key with a = 1. The iterator equals GetEndIterator() right after the last entry
+   * in the range, so a scan costs one descent of the tree plus the leaves holding the range
+   */
+  INDEXITERATOR_TYPE ScanRange(const Row *lo, bool lo_inclusive, const Row *hi, bool hi_inclusive,
+                               bool reverse = false);
+
+  /**
+   * Serialize a bound of the entries of key, every entry of a smaller key is less than the lower bound and
+   * every entry of a larger key is greater than the upper bound. key may hold only the first columns of the
+   * key schema, then its entries are those starting with it. Both bounds are the key of its only entry for
+   * a full key of a unique index, and lie before and after the entries of key otherwise
+   */
+  void SerializeBound(const Row &key, bool upper, KeyType &bound) const;
+
 protected:
+  // key of the entry in the tree, the row id is a part of it in a non-unique index
+  void SerializeKey(const Row &key, const RowId &row_id, KeyType &index_key) const;
+
   // comparator for key
   KeyComparator comparator_;
   // container
   BPLUSTREE_TYPE container_;
 };
 
+/**
+ * Key type of a b+ tree index, chosen from the key schema when the index is created
+ */
+enum IndexKeyType : uint32_t {
+  kKeyGeneric32 = 0,  /** also the key type of indexes created before key types were chosen */
+  kKeyGeneric4,
+  kKeyGeneric8,
+  kKeyGeneric16,
+  kKeyGeneric64,
+  kKeyInt32,
+  kKeyInt64,
+  kKeyGeneric128,
+  kKeyGeneric256,
+  kKeyInvalid
+};
+
+/**
+ * @return the smallest key type which holds every key of key_schema, followed by the row id if the index is
+ * not unique. Integer keys for a single not null integer column of a unique index, kKeyInvalid if the keys
+ * are too large
+ */
+IndexKeyType ChooseIndexKeyType(const Schema *key_schema, bool unique = true);
+
+/**
+ * Call func with a null pointer of the BPlusTreeIndex type of key_type, so that an operation is compiled
+ * for each key type and dispatched once, eg: DispatchIndexKeyType(key_type, [&](auto *tag) { ... })
+ */
+template<typename Func>
+inline auto DispatchIndexKeyType(IndexKeyType key_type, Func &&func) {
+  switch (key_type) {
+    case kKeyGeneric4:
+      return func(static_cast<BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4>> *>(nullptr));
+    case kKeyGeneric8:
+      return func(static_cast<BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8>> *>(nullptr));
+    case kKeyGeneric16:
+      return func(static_cast<BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16>> *>(nullptr));
+    case kKeyGeneric64:
+      return func(static_cast<BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>> *>(nullptr));
+    case kKeyGeneric128:
+      return func(static_cast<BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128>> *>(nullptr));
+    case kKeyGeneric256:
+      return func(static_cast<BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256>> *>(nullptr));
+    case kKeyInt32:
+      return func(static_cast<BPlusTreeIndex<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>> *>(nullptr));
+    case kKeyInt64:
+      return func(static_cast<BPlusTreeIndex<IntegerKey<int64_t>, RowId, IntegerComparator<int64_t>> *>(nullptr));
+    default:
+      ASSERT(key_type == kKeyGeneric32, "Invalid index key type.");
+      return func(static_cast<BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>> *>(nullptr));
+  }
+}
+
 #endif //MINISQL_B_PLUS_TREE_INDEX_H
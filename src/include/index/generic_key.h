@@ -3,25 +3,37 @@
 
 #include <cstring>
 
+#include "index/key_codec.h"
 #include "record/row.h"
 #include "record/field.h"
 
+/**
+ * Index key of at most KeySize bytes, encoded by KeyCodec and padded with zeros
+ */
 template<size_t KeySize>
 class GenericKey {
 public:
   inline void SerializeFromKey(const Row &key, Schema *schema) {
     // initialize to 0
-    uint32_t size = key.GetSerializedSize(schema);
-    ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= KeySize, "Index key size exceed max key size.");
+    ASSERT(KeyCodec::GetEncodedSize(key, schema) <= KeySize, "Index key size exceed max key size.");
     memset(data, 0, KeySize);
-    key.SerializeTo(data, schema);
+    KeyCodec::Encode(key, schema, data);
   }
 
-  inline void DeserializeToKey(Row &key, Schema *schema) const {
-    uint32_t ofs = key.DeserializeFrom(const_cast<char *>(data), schema);
-    ASSERT(ofs <= KeySize, "Index key size exceed max key size.");
-    return;
+  // key of a non-unique index, the row id follows the encoded key
+  inline void SerializeFromKey(const Row &key, const RowId &row_id, Schema *schema) {
+    uint32_t size = KeyCodec::GetEncodedSize(key, schema);
+    ASSERT(size + KeyCodec::ROW_ID_SIZE <= KeySize, "Index key size exceed max key size.");
+    memset(data, 0, KeySize);
+    KeyCodec::Encode(key, schema, data);
+    KeyCodec::EncodeRowId(row_id, data + size);
+  }
+
+  // bound of the keys starting with the encoded key, key may hold only the first columns of schema
+  inline void SerializeBound(const Row &key, bool upper, Schema *schema) {
+    ASSERT(KeyCodec::GetEncodedSize(key, schema) <= KeySize, "Index key size exceed max key size.");
+    memset(data, upper ? 0xff : 0, KeySize);
+    KeyCodec::Encode(key, schema, data);
   }
 
   // compare
@@ -54,24 +66,8 @@ class GenericComparator {
 public:
   inline int operator()(const GenericKey<KeySize> &lhs,
                         const GenericKey<KeySize> &rhs) const {
-    int column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    lhs.DeserializeToKey(lhs_key, key_schema_);
-    rhs.DeserializeToKey(rhs_key, key_schema_);
-
-    for (int i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue)
-        return -1;
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue)
-        return 1;
-    }
-    // equals
-    return 0;
+    // 编码后的 key 按字节比较即可
+    return memcmp(lhs.data, rhs.data, KeySize);
   }
 
   GenericComparator(const GenericComparator &other) {
@@ -85,4 +81,44 @@ private:
   Schema *key_schema_;
 };
 
+/**
+ * Key of a single not null integer column, int32_t for int and date, int64_t for bigint and timestamp
+ */
+template<typename T>
+class IntegerKey {
+public:
+  inline void SerializeFromKey(const Row &key, Schema *schema) {
+    ASSERT(key.GetFieldCount() == 1 && schema->GetColumnCount() == 1, "Integer key has one column.");
+    value_ = static_cast<T>(KeyCodec::GetInteger(*key.GetField(0)));
+  }
+
+  inline void SerializeFromKey(const Row &key, const RowId &row_id, Schema *schema) {
+    ASSERT(false, "Integer keys are only chosen for unique indexes.");
+    SerializeFromKey(key, schema);
+  }
+
+  // the key of a single column has no shorter prefix, it is the bound of itself
+  inline void SerializeBound(const Row &key, bool upper, Schema *schema) { SerializeFromKey(key, schema); }
+
+  inline bool operator==(const IntegerKey &other) { return value_ == other.value_; }
+
+  friend std::ostream &operator<<(std::ostream &os, const IntegerKey &key) {
+    os << key.value_;
+    return os;
+  }
+
+  T value_;
+};
+
+template<typename T>
+class IntegerComparator {
+public:
+  inline int operator()(const IntegerKey<T> &lhs, const IntegerKey<T> &rhs) const {
+    return (lhs.value_ > rhs.value_) - (lhs.value_ < rhs.value_);
+  }
+
+  // constructor, integer keys compare without the schema
+  IntegerComparator(Schema *key_schema) {}
+};
+
 #endif  // MINISQL_GENERIC_KEY_H
@@ -1,16 +1,27 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <functional>
 #include <memory>
 
 #include "common/dberr.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
+/**
+ * Receives the (key, row id) entries of an index one by one
+ */
+using IndexEntryEmitter = std::function<void(const Row &key, RowId row_id)>;
+
+/**
+ * Produces every entry of an index by calling emit, eg: a scan of the indexed table
+ */
+using IndexEntryScanner = std::function<void(const IndexEntryEmitter &emit)>;
+
 class Index {
 public:
-  explicit Index(index_id_t index_id, IndexSchema *key_schema)
-          : index_id_(index_id), key_schema_(key_schema) {}
+  explicit Index(index_id_t index_id, IndexSchema *key_schema, bool unique = true)
+          : index_id_(index_id), key_schema_(key_schema), unique_(unique) {}
 
   virtual ~Index() {}
 
@@ -18,13 +29,27 @@ public:
 
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
+  /**
+   * Append the row ids of all entries of key to result, a unique index has at most one. key may hold only
+   * the first columns of the key schema, then all entries starting with it are appended
+   */
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) = 0;
 
+  /**
+   * Build an empty index from all entries produced by scan, entries may come in any order.
+   * A unique index only keeps the first entry of duplicated keys, as InsertEntry does
+   */
+  virtual dberr_t BulkLoad(const IndexEntryScanner &scan, Transaction *txn) = 0;
+
   virtual dberr_t Destroy() = 0;
 
+  /** @return false if several entries may have the same key */
+  inline bool IsUnique() const { return unique_; }
+
 protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
+  bool unique_;
 };
 
 #endif //MINISQL_INDEX_H
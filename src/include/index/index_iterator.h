@@ -5,20 +5,40 @@
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * Iterator over the leaves of a b+ tree, the current leaf is pinned but not
+ * latched. The current pair is copied out of the leaf and validated against
+ * the leaf version. If a writer has changed the leaf, the iterator finds its
+ * position again from the root by the last key it returned.
+ * A reverse iterator walks the leaves from right to left by their prev links.
+ * An iterator with an end key becomes End() at the first key beyond it, so a
+ * range scan reads no leaf after the range.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
 public:
   // you may define your own constructor based on your member variables
   explicit IndexIterator();
-  explicit IndexIterator(
-      BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf, BufferPoolManager *bpm, int index);
+  // points to the first key >= key (> key if not inclusive), or the first key of the tree if fromEdge,
+  // a reverse iterator points to the last key <= key (< key), or the last key of the tree if fromEdge
+  explicit IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                         const KeyType &key, bool fromEdge, bool inclusive = true, bool reverse = false,
+                         const KeyType *end = nullptr, bool end_inclusive = true);
+
+  // an iterator owns the pin of its leaf
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator &operator=(const IndexIterator &) = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
 
   ~IndexIterator();
 
   /** Return the key/value pair this iterator is currently pointing at. */
   const MappingType &operator*();
 
-  /** Move to the next key/value pair.*/
+  /** Move to the next key/value pair, the previous one for a reverse iterator.*/
   IndexIterator &operator++();
 
   /** Return whether two iterators are equal */
@@ -28,10 +48,33 @@ public:
   bool operator!=(const IndexIterator &itr) const;
 
 private:
+  // 从根重新找到 key_ 所在的位置
+  void Seek();
+
+  // 读出 index_ 处的键值对，当前叶子读完时移到右边（反向时左边）的叶子
+  void Load();
+
+  // 放开当前叶子，变为 End()
+  void Release();
+
   // add your own private member variables here
+ BPlusTree<KeyType, ValueType, KeyComparator> *tree_;
  BufferPoolManager* bpm_;
+ Page* page_;
  BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>* leaf_;
+ uint64_t version_;
  int index_;
+ MappingType item_;
+ // 重新定位用：from_edge_ 时从头（反向时从尾）开始，否则找第一个 >= key_ (inclusive_) 或 > key_ 的键
+ // 反向时找最后一个 <= key_ 或 < key_ 的键
+ KeyType key_;
+ bool from_edge_;
+ bool inclusive_;
+ bool reverse_;
+ // 范围的另一端，越过它之后迭代结束
+ bool has_end_;
+ KeyType end_;
+ bool end_inclusive_;
 };
 
 
@@ -0,0 +1,62 @@
+#ifndef MINISQL_KEY_CODEC_H
+#define MINISQL_KEY_CODEC_H
+
+#include <cstdint>
+
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Encoder of index keys into a binary form whose order is the order of the keys, so that keys are
+ * compared with memcmp instead of being deserialized into rows and compared field by field.
+ *
+ *  Key format, fields one after another:
+ *  -----------------------------------------
+ *  | Null flag (1) | Value (0+) | ... |
+ *  -----------------------------------------
+ *  Null flag is 0 for null and 1 otherwise, a null field has no value, so null sorts first.
+ *  int, date, bigint, timestamp: big endian with the sign bit flipped.
+ *  float, double: big endian IEEE bits, the sign bit is flipped for positive values and all bits are
+ *  flipped for negative values, -0 is encoded as 0.
+ *  char, varchar: the value with 0x00 escaped as 0x00 0x01, terminated by 0x00 0x00. Trailing zeros a
+ *  char value is padded with are dropped first.
+ *
+ *  No encoded field is a prefix of another one, so bytes after the end of the key do not affect the order,
+ *  and a key of the first columns of schema encodes to the common prefix of the keys starting with it.
+ *  Keys of a non-unique index are followed by the row id, page id and slot number in big endian, so that
+ *  its entries are distinct and the entries of a key are ordered by row id.
+ */
+class KeyCodec {
+public:
+  /**
+   * key holds the fields of all columns of schema, or of its first columns
+   * @return bytes written to buf, equal to GetEncodedSize(key)
+   */
+  static uint32_t Encode(const Row &key, Schema *schema, char *buf);
+
+  static uint32_t GetEncodedSize(const Row &key, Schema *schema);
+
+  static uint32_t EncodeField(const Field &field, char *buf);
+
+  static uint32_t GetEncodedSize(const Field &field);
+
+  static uint32_t EncodeRowId(const RowId &row_id, char *buf);
+
+  /**
+   * @return upper bound of the encoded size of keys of schema, assuming char values hold no zeros
+   */
+  static uint32_t GetMaxEncodedSize(const Schema *schema);
+
+  /**
+   * @return value of a not null int, date, bigint or timestamp field
+   */
+  static int64_t GetInteger(const Field &field);
+
+  static constexpr uint32_t ROW_ID_SIZE = 8;
+  static constexpr uint8_t KEY_NULL = 0;
+  static constexpr uint8_t KEY_NOT_NULL = 1;
+};
+
+#endif  // MINISQL_KEY_CODEC_H
@@ -0,0 +1,540 @@
+#ifndef MINISQL_B_PLUS_TREE_ENTRIES_H
+#define MINISQL_B_PLUS_TREE_ENTRIES_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "page/b_plus_tree_page.h"
+
+template<size_t KeySize>
+class GenericKey;
+
+template<typename T>
+class IntegerKey;
+
+template<typename T>
+class IntegerComparator;
+
+template<typename T>
+class BasicComparator;
+
+/**
+ * Keys compared byte by byte (GenericKey) are stored with variable length in b+ tree pages, other keys are
+ * stored as they are
+ */
+template<typename KeyType>
+struct IsVariableLengthKey : std::false_type {};
+
+template<size_t KeySize>
+struct IsVariableLengthKey<GenericKey<KeySize>> : std::true_type {};
+
+/**
+ * Keys which are a single integer compared by its natural order, int with BasicComparator or IntegerKey with
+ * IntegerComparator. They are searched as integers without calling the comparator
+ */
+template<typename KeyType, typename KeyComparator>
+struct IsIntegerKeyOrder : std::false_type {};
+
+template<>
+struct IsIntegerKeyOrder<int, BasicComparator<int>> : std::true_type {
+  using Integer = int;
+};
+
+template<typename T>
+struct IsIntegerKeyOrder<IntegerKey<T>, IntegerComparator<T>> : std::true_type {
+  using Integer = T;
+};
+
+// 无分支二分缩小到一个 cache line 之内的 key，再一次数完
+static constexpr int kIntegerSearchWindow = 64;
+
+/**
+ * @return the number of the first n keys which are < key, or <= key if Upper
+ */
+template<typename T, bool Upper>
+inline int CountIntegersBelow(const T *keys, int n, T key) {
+  int count = 0;
+  int i = 0;
+#ifdef __AVX2__
+  // 一条指令比较一个 256 位的块，比较结果的符号位压成掩码后数 1 的个数
+  static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Integer keys are 32 or 64 bits.");
+  constexpr int lanes = 32 / sizeof(T);
+  if constexpr (sizeof(T) == 4) {
+    __m256i probe = _mm256_set1_epi32(static_cast<int32_t>(key));
+    for (; i + lanes <= n; i += lanes) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+      // keys < key 即 key > keys，keys <= key 即 !(keys > key)
+      __m256i result = Upper ? _mm256_cmpgt_epi32(block, probe) : _mm256_cmpgt_epi32(probe, block);
+      int mask = _mm256_movemask_ps(_mm256_castsi256_ps(result));
+      count += Upper ? lanes - __builtin_popcount(mask) : __builtin_popcount(mask);
+    }
+  } else {
+    __m256i probe = _mm256_set1_epi64x(static_cast<int64_t>(key));
+    for (; i + lanes <= n; i += lanes) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+      __m256i result = Upper ? _mm256_cmpgt_epi64(block, probe) : _mm256_cmpgt_epi64(probe, block);
+      int mask = _mm256_movemask_pd(_mm256_castsi256_pd(result));
+      count += Upper ? lanes - __builtin_popcount(mask) : __builtin_popcount(mask);
+    }
+  }
+#endif
+  for (; i < n; i++)
+    count += Upper ? keys[i] <= key : keys[i] < key;
+  return count;
+}
+
+/**
+ * Binary search over sorted integers without branches on the keys
+ * @return the first index in [begin, end) whose key >= key, or > key if Upper
+ */
+template<typename T, bool Upper>
+inline int SearchIntegers(const T *keys, int begin, int end, T key) {
+  const T *base = keys + begin;
+  int n = end - begin;
+  // 结果总在 [base, base + n] 中，比较只决定 base 是否前移，编译成条件传送
+  while (n > kIntegerSearchWindow / static_cast<int>(sizeof(T))) {
+    int half = n / 2;
+    base = (Upper ? base[half] <= key : base[half] < key) ? base + half : base;
+    n -= half;
+  }
+  return static_cast<int>(base - keys) + CountIntegersBelow<T, Upper>(base, std::max(n, 0), key);
+}
+
+/**
+ * Key & value pairs of a b+ tree page in key order, stored in the Space bytes from the end of the page
+ * header to the end of the page. The page keeps the number of pairs and passes it in as size.
+ * Insert, Assign and SetKeyAt return false and leave the pairs unchanged if they do not fit.
+ */
+template<typename KeyType, typename ValueType, int Space, bool Variable = IsVariableLengthKey<KeyType>::value>
+class BPlusTreeEntries;
+
+/**
+ * Fixed length pairs split into an array of keys followed by an array of values, so that a search only
+ * reads the keys and the page is full by the number of pairs
+ */
+template<typename KeyType, typename ValueType, int Space>
+class BPlusTreeEntries<KeyType, ValueType, Space, false> {
+  static constexpr int kKeySize = sizeof(KeyType);
+  static constexpr int kValueSize = sizeof(ValueType);
+  static constexpr int kValueAlign = alignof(ValueType);
+
+  // 值数组按对齐补齐之后放不下时少放一个
+  static constexpr int Fit(int capacity) {
+    return (capacity * kKeySize + kValueAlign - 1) / kValueAlign * kValueAlign + capacity * kValueSize <= Space
+           ? capacity : capacity - 1;
+  }
+
+  static constexpr int kCapacity = Fit(Space / (kKeySize + kValueSize));
+
+public:
+  static constexpr bool kVariableLength = false;
+  static constexpr int kDataSize = Space;
+  // 留出一个位置，插入之后再分裂
+  static constexpr int kMaxSize = kCapacity - 1;
+
+  void Init() { static_assert(sizeof(*this) <= Space, "Pairs do not fit into the page."); }
+
+  KeyType KeyAt(int index) const { return keys_[index]; }
+
+  ValueType ValueAt(int index) const { return values_[index]; }
+
+  MappingType ItemAt(int index) const { return MappingType(keys_[index], values_[index]); }
+
+  void SetValueAt(int index, const ValueType &value) { values_[index] = value; }
+
+  bool SetKeyAt(int size, int index, const KeyType &key) {
+    keys_[index] = key;
+    return true;
+  }
+
+  bool CanSetKeyAt(int size, int index, const KeyType &key) const { return true; }
+
+  /**
+   * @return the first index in [begin, end) whose key >= key, or > key if upper
+   */
+  template<typename KeyComparator>
+  int Search(int begin, int end, const KeyType &key, const KeyComparator &comparator, bool upper) const {
+    // 无锁的读者可能读到错误的大小，只保证不越界
+    end = std::min(end, kCapacity);
+    if constexpr (IsIntegerKeyOrder<KeyType, KeyComparator>::value) {
+      using Integer = typename IsIntegerKeyOrder<KeyType, KeyComparator>::Integer;
+      const Integer *keys = reinterpret_cast<const Integer *>(keys_);
+      Integer probe = *reinterpret_cast<const Integer *>(&key);
+      return upper ? SearchIntegers<Integer, true>(keys, begin, end, probe)
+                   : SearchIntegers<Integer, false>(keys, begin, end, probe);
+    }
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      int result = comparator(keys_[mid], key);
+      if (result < 0 || (upper && result == 0))
+        begin = mid + 1;
+      else
+        end = mid;
+    }
+    return begin;
+  }
+
+  bool Insert(int size, int index, const KeyType &key, const ValueType &value) {
+    if (size > kMaxSize)
+      return false;
+    std::copy_backward(keys_ + index, keys_ + size, keys_ + size + 1);
+    std::copy_backward(values_ + index, values_ + size, values_ + size + 1);
+    keys_[index] = key;
+    values_[index] = value;
+    return true;
+  }
+
+  bool CanInsert(int size, const KeyType &key) const { return size <= kMaxSize; }
+
+  void Remove(int size, int index) {
+    std::copy(keys_ + index + 1, keys_ + size, keys_ + index);
+    std::copy(values_ + index + 1, values_ + size, values_ + index);
+  }
+
+  bool Assign(const MappingType *items, int size) {
+    if (size > kCapacity)
+      return false;
+    for (int i = 0; i < size; i++) {
+      keys_[i] = items[i].first;
+      values_[i] = items[i].second;
+    }
+    return true;
+  }
+
+  std::vector<MappingType> Items(int size) const {
+    std::vector<MappingType> items;
+    items.reserve(size);
+    for (int i = 0; i < size; i++)
+      items.emplace_back(keys_[i], values_[i]);
+    return items;
+  }
+
+  // 定长的页按条目数分裂
+  int SplitPoint(int size) const { return size / 2; }
+
+  int GetUsedSpace(int size) const { return size * (kKeySize + kValueSize); }
+
+  // 定长的 key 不截断
+  static KeyType Separator(const KeyType &left, const KeyType &right) { return right; }
+
+private:
+  KeyType keys_[kCapacity];
+  ValueType values_[kCapacity];
+};
+
+/**
+ * Variable length pairs in slots, the page is full by the bytes they take
+ *
+ *  ---------------------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | ... | SLOT(n) | FREE SPACE | ENTRY(i) | ... | ENTRY(j) | PREFIX |
+ *  ---------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 12 bytes in total):
+ *  -----------------------------------------------------
+ * | PrefixSize (4) | HeapOffset (4) | HeapSize (4) |
+ *  -----------------------------------------------------
+ *
+ *  Slots are in key order, a slot is the offset (2) and suffix size (2) of its entry. Entries grow from
+ *  the end of the page to the slots, an entry is the value followed by the key suffix. All keys of the page
+ *  start with the prefix, which is stored once at the end of the page, and the suffix is the rest of the key
+ *  without its trailing zeros. A key is the prefix and the suffix padded with zeros again.
+ *  Removed entries leave holes in the heap, which are reclaimed when the page is assigned again.
+ */
+template<typename KeyType, typename ValueType, int Space>
+class BPlusTreeEntries<KeyType, ValueType, Space, true> {
+  static constexpr int kHeaderSize = 3 * sizeof(uint32_t);
+  static constexpr int kSlotSize = 2 * sizeof(uint16_t);
+  static constexpr int kKeySize = sizeof(KeyType);
+  static constexpr int kValueSize = sizeof(ValueType);
+
+public:
+  static constexpr bool kVariableLength = true;
+  static constexpr int kDataSize = Space - kHeaderSize;
+  // 条目数的上限，只在 key 都等于前缀时才会达到
+  static constexpr int kMaxSize = kDataSize / (kSlotSize + kValueSize) - 1;
+  static constexpr int kMaxEntrySize = kSlotSize + kValueSize + kKeySize;
+
+  void Init() {
+    prefix_size_ = 0;
+    heap_offset_ = kDataSize;
+    heap_size_ = 0;
+  }
+
+  KeyType KeyAt(int index) const {
+    KeyType key;
+    char *buf = reinterpret_cast<char *>(&key);
+    int prefix = GetPrefixSize();
+    memcpy(buf, data_ + kDataSize - prefix, prefix);
+    int offset, suffix;
+    ReadSlot(index, offset, suffix);
+    suffix = std::min(suffix, kKeySize - prefix);
+    memcpy(buf + prefix, data_ + offset + kValueSize, suffix);
+    memset(buf + prefix + suffix, 0, kKeySize - prefix - suffix);
+    return key;
+  }
+
+  ValueType ValueAt(int index) const {
+    ValueType value;
+    int offset, suffix;
+    ReadSlot(index, offset, suffix);
+    memcpy(reinterpret_cast<char *>(&value), data_ + offset, kValueSize);
+    return value;
+  }
+
+  MappingType ItemAt(int index) const { return MappingType(KeyAt(index), ValueAt(index)); }
+
+  void SetValueAt(int index, const ValueType &value) {
+    int offset, suffix;
+    ReadSlot(index, offset, suffix);
+    memcpy(data_ + offset, reinterpret_cast<const char *>(&value), kValueSize);
+  }
+
+  bool SetKeyAt(int size, int index, const KeyType &key) {
+    std::vector<MappingType> items = Items(size);
+    items[index].first = key;
+    return Assign(items.data(), size);
+  }
+
+  bool CanSetKeyAt(int size, int index, const KeyType &key) const {
+    std::vector<MappingType> items = Items(size);
+    items[index].first = key;
+    int prefix;
+    return GetSpace(items.data(), size, prefix) <= kDataSize;
+  }
+
+  /**
+   * @return the first index in [begin, end) whose key >= key, or > key if upper
+   */
+  template<typename KeyComparator>
+  int Search(int begin, int end, const KeyType &key, const KeyComparator &comparator, bool upper) const {
+    // 前缀只拷贝一次，每次比较只拷贝后缀，再把上一个后缀多出的部分清零
+    KeyType probe;
+    char *buf = reinterpret_cast<char *>(&probe);
+    int prefix = GetPrefixSize();
+    memcpy(buf, data_ + kDataSize - prefix, prefix);
+    memset(buf + prefix, 0, kKeySize - prefix);
+    int dirty = prefix;
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      int offset, suffix;
+      ReadSlot(mid, offset, suffix);
+      suffix = std::min(suffix, kKeySize - prefix);
+      memcpy(buf + prefix, data_ + offset + kValueSize, suffix);
+      if (prefix + suffix < dirty)
+        memset(buf + prefix + suffix, 0, dirty - prefix - suffix);
+      dirty = prefix + suffix;
+      int result = comparator(probe, key);
+      if (result < 0 || (upper && result == 0))
+        begin = mid + 1;
+      else
+        end = mid;
+    }
+    return begin;
+  }
+
+  bool Insert(int size, int index, const KeyType &key, const ValueType &value) {
+    if (size > kMaxSize)
+      return false;
+    // 空页以第一个 key 为前缀
+    if (size == 0) {
+      MappingType item(key, value);
+      return Assign(&item, 1);
+    }
+    int prefix = prefix_size_;
+    int entry = kValueSize + GetSuffixSize(key, prefix);
+    bool shared = memcmp(&key, data_ + kDataSize - prefix, prefix) == 0;
+    if (shared && GetFreeSpace(size) < kSlotSize + entry)
+      return false;
+    if (!shared || static_cast<int>(heap_offset_) < (size + 1) * kSlotSize + entry) {
+      // key 不以前缀开头或者空闲空间不连续时重新排列整页
+      std::vector<MappingType> items = Items(size);
+      items.insert(items.begin() + index, MappingType(key, value));
+      return Assign(items.data(), size + 1);
+    }
+    heap_offset_ -= entry;
+    heap_size_ += entry;
+    WriteEntry(heap_offset_, key, value, prefix);
+    memmove(data_ + (index + 1) * kSlotSize, data_ + index * kSlotSize, (size - index) * kSlotSize);
+    WriteSlot(index, heap_offset_, entry - kValueSize);
+    return true;
+  }
+
+  /**
+   * @return true if key fits, it may not when the prefix becomes shorter, assuming every key grows by as
+   * much as the prefix shrinks
+   */
+  bool CanInsert(int size, const KeyType &key) const {
+    if (size > kMaxSize)
+      return false;
+    if (size == 0)
+      return true;
+    int prefix = prefix_size_;
+    int common = CommonPrefixSize(reinterpret_cast<const char *>(&key), data_ + kDataSize - prefix, prefix);
+    int grow = (prefix - common) * (size - 1);
+    return GetFreeSpace(size) >= grow + kSlotSize + kValueSize + GetSuffixSize(key, common);
+  }
+
+  void Remove(int size, int index) {
+    if (size == 1) {
+      Init();
+      return;
+    }
+    int offset, suffix;
+    ReadSlot(index, offset, suffix);
+    heap_size_ -= kValueSize + suffix;
+    memmove(data_ + index * kSlotSize, data_ + (index + 1) * kSlotSize, (size - index - 1) * kSlotSize);
+  }
+
+  /**
+   * Lay out the page again with items, the prefix is the common prefix of their keys
+   */
+  bool Assign(const MappingType *items, int size) {
+    int prefix;
+    if (GetSpace(items, size, prefix) > kDataSize)
+      return false;
+    int offset = kDataSize - prefix;
+    if (size > 0)
+      memcpy(data_ + offset, &items[0].first, prefix);
+    prefix_size_ = prefix;
+    heap_size_ = 0;
+    for (int i = 0; i < size; i++) {
+      int entry = kValueSize + GetSuffixSize(items[i].first, prefix);
+      offset -= entry;
+      heap_size_ += entry;
+      WriteEntry(offset, items[i].first, items[i].second, prefix);
+      WriteSlot(i, offset, entry - kValueSize);
+    }
+    heap_offset_ = offset;
+    return true;
+  }
+
+  std::vector<MappingType> Items(int size) const {
+    std::vector<MappingType> items;
+    items.reserve(size);
+    for (int i = 0; i < size; i++)
+      items.push_back(ItemAt(i));
+    return items;
+  }
+
+  /**
+   * @return the number of pairs kept by the left page of a split, so that both pages take about the same
+   * bytes
+   */
+  int SplitPoint(int size) const {
+    int total = GetUsedSpace(size) - GetPrefixSize();
+    int left = 0;
+    int keep = 0;
+    // 下一个条目放进左边之后离一半更远时停下
+    while (keep < size - 1) {
+      int offset, suffix;
+      ReadSlot(keep, offset, suffix);
+      int entry = kSlotSize + kValueSize + suffix;
+      if (keep > 0 && std::abs((left + entry) * 2 - total) > std::abs(left * 2 - total))
+        break;
+      left += entry;
+      keep++;
+    }
+    return keep;
+  }
+
+  int GetUsedSpace(int size) const { return size * kSlotSize + prefix_size_ + heap_size_; }
+
+  int GetFreeSpace(int size) const { return kDataSize - GetUsedSpace(size); }
+
+  int GetPrefixSize() const { return static_cast<int>(std::min<uint32_t>(prefix_size_, kKeySize)); }
+
+  /**
+   * @return true if key starts with the prefix of the page
+   */
+  bool HasPrefix(const KeyType &key) const {
+    return memcmp(&key, data_ + kDataSize - GetPrefixSize(), GetPrefixSize()) == 0;
+  }
+
+  /**
+   * Suffix truncation, left < right
+   * @return the shortest key separator with left < separator <= right, the bytes of right up to the first
+   * one different from left
+   */
+  static KeyType Separator(const KeyType &left, const KeyType &right) {
+    KeyType separator;
+    char *buf = reinterpret_cast<char *>(&separator);
+    int size = std::min(CommonPrefixSize(reinterpret_cast<const char *>(&left),
+                                         reinterpret_cast<const char *>(&right), kKeySize) + 1, kKeySize);
+    memcpy(buf, &right, size);
+    memset(buf + size, 0, kKeySize - size);
+    return separator;
+  }
+
+  /**
+   * @return bytes taken by items laid out in a page, and the prefix of their keys
+   */
+  static int GetSpace(const MappingType *items, int size, int &prefix) {
+    prefix = 0;
+    if (size == 0)
+      return 0;
+    // 超出最长的 key 之后都是 0，不必放进前缀
+    const char *first = reinterpret_cast<const char *>(&items[0].first);
+    int longest = 0;
+    prefix = kKeySize;
+    for (int i = 0; i < size; i++) {
+      prefix = CommonPrefixSize(first, reinterpret_cast<const char *>(&items[i].first), prefix);
+      longest = std::max(longest, GetTrimmedSize(items[i].first));
+    }
+    prefix = std::min(prefix, longest);
+    int space = prefix + size * (kSlotSize + kValueSize);
+    for (int i = 0; i < size; i++)
+      space += GetSuffixSize(items[i].first, prefix);
+    return space;
+  }
+
+private:
+  // 无锁的读者可能读到正在修改的页，读出的位置和长度只保证不越界，读到的内容由版本号校验
+  void ReadSlot(int index, int &offset, int &suffix) const {
+    uint16_t slot[2];
+    index = std::min(index, kDataSize / kSlotSize - 1);
+    memcpy(slot, data_ + index * kSlotSize, kSlotSize);
+    offset = std::min<int>(slot[0], kDataSize - kValueSize);
+    suffix = std::min<int>({slot[1], kKeySize, kDataSize - kValueSize - offset});
+  }
+
+  void WriteSlot(int index, int offset, int suffix) {
+    uint16_t slot[2] = {static_cast<uint16_t>(offset), static_cast<uint16_t>(suffix)};
+    memcpy(data_ + index * kSlotSize, slot, kSlotSize);
+  }
+
+  void WriteEntry(int offset, const KeyType &key, const ValueType &value, int prefix) {
+    memcpy(data_ + offset, reinterpret_cast<const char *>(&value), kValueSize);
+    memcpy(data_ + offset + kValueSize, reinterpret_cast<const char *>(&key) + prefix, GetSuffixSize(key, prefix));
+  }
+
+  static int GetTrimmedSize(const KeyType &key) {
+    const char *buf = reinterpret_cast<const char *>(&key);
+    int size = kKeySize;
+    while (size > 0 && buf[size - 1] == 0)
+      size--;
+    return size;
+  }
+
+  static int GetSuffixSize(const KeyType &key, int prefix) { return std::max(GetTrimmedSize(key) - prefix, 0); }
+
+  static int CommonPrefixSize(const char *lhs, const char *rhs, int size) {
+    int i = 0;
+    while (i < size && lhs[i] == rhs[i])
+      i++;
+    return i;
+  }
+
+  uint32_t prefix_size_;
+  uint32_t heap_offset_;
+  uint32_t heap_size_;
+  char data_[0];
+};
+
+#endif  // MINISQL_B_PLUS_TREE_ENTRIES_H
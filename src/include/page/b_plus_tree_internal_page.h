@@ -2,33 +2,54 @@
 #define MINISQL_B_PLUS_TREE_INTERNAL_PAGE_H
 
 #include <queue>
+#include <vector>
+
+#include "page/b_plus_tree_entries.h"
 #include "page/b_plus_tree_page.h"
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)) - 1)
+#define INTERNAL_PAGE_SIZE (BPlusTreeEntries<KeyType, ValueType, PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE>::kMaxSize)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
  * K(i) <= K < K(i+1).
  * NOTE: since the number of keys does not equal to number of child pointers,
  * the first key always remains invalid. That is to say, any search/lookup
- * should ignore the first key.
+ * should ignore the first key. It is kept equal to the key of this page in its
+ * parent, or empty in the left most page of a level, so that it shares the
+ * prefix of the other keys.
  *
  * Internal page format (keys are stored in increasing order):
  *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | PAGE_ID(1) | ... | PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *  Keys are kept apart from child pointers, a lookup only reads the keys.
+ *  Keys of variable length are stored in slots with the common prefix of the
+ *  page truncated, see page/b_plus_tree_entries.h
+ *
+ * Methods do not latch any page, the b+ tree write latches this page, its
+ * siblings and its parent before calling them. Parent page ids of the moved
+ * children are changed without their latches, since a parent page id is only
+ * read by a writer which holds the latch of that parent.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
+  using Entries = BPlusTreeEntries<KeyType, ValueType, PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE>;
+
 public:
+  // keys are stored with variable length, pages are full by bytes instead of pairs
+  static constexpr bool kVariableLength = Entries::kVariableLength;
+
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
 
   KeyType KeyAt(int index) const;
 
-  void SetKeyAt(int index, const KeyType &key);
+  // return false if the page has no room for key
+  bool SetKeyAt(int index, const KeyType &key);
+
+  bool CanSetKeyAt(int index, const KeyType &key) const;
 
   int ValueIndex(const ValueType &value) const;
 
@@ -38,16 +59,36 @@ public:
 
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
 
-  int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  // return false if the page has no room for new_key
+  bool InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+
+  bool CanInsert(const KeyType &new_key) const;
+
+  // append the last child, its parent page id is set by the caller, used by bulk loading
+  bool Append(const KeyType &new_key, const ValueType &new_value);
+
+  // whether bulk loading still appends new_key to this page filled to fill_factor
+  bool CanAppend(const KeyType &new_key, double fill_factor) const;
 
   void Remove(int index);
 
   ValueType RemoveAndReturnOnlyChild();
 
+  // an insert can not split this page
+  bool IsInsertSafe() const;
+
+  // a remove can not make this page underflow
+  bool IsRemoveSafe() const;
+
+  bool IsUnderflow() const;
+
   // Split and Merge utility methods
+  bool CanMoveAllTo(const BPlusTreeInternalPage *recipient, const KeyType &middle_key) const;
+
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
 
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager,
+                  const KeyType *new_key = nullptr);
 
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                         BufferPoolManager *buffer_pool_manager);
@@ -56,13 +97,13 @@ public:
                          BufferPoolManager *buffer_pool_manager);
 
 private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  void CopyNFrom(const MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
 
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
 
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  void CopyFirstFrom(const MappingType &pair, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
 
-  MappingType array_[0];
+  Entries entries_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_INTERNAL_PAGE_H
@@ -10,29 +10,38 @@
 
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | RID(1) | RID(2) | ... | RID(n)
  *  ----------------------------------------------------------------------
+ *  Keys are kept apart from record ids, a search only reads the keys.
+ *  Keys of variable length are stored in slots with the common prefix of the
+ *  page truncated, see page/b_plus_tree_entries.h
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  ------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4) |
+ *  ------------------------------------------------------------------
  */
 #include <utility>
 #include <vector>
 
+#include "page/b_plus_tree_entries.h"
 #include "page/b_plus_tree_page.h"
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType)) - 1)
+#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_SIZE (BPlusTreeEntries<KeyType, ValueType, PAGE_SIZE - LEAF_PAGE_HEADER_SIZE>::kMaxSize)
 
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
+  using Entries = BPlusTreeEntries<KeyType, ValueType, PAGE_SIZE - LEAF_PAGE_HEADER_SIZE>;
+
 public:
+  // keys are stored with variable length, pages are full by bytes instead of pairs
+  static constexpr bool kVariableLength = Entries::kVariableLength;
+
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
@@ -42,23 +51,45 @@ public:
 
   void SetNextPageId(page_id_t next_page_id);
 
+  page_id_t GetPrevPageId() const;
+
+  void SetPrevPageId(page_id_t prev_page_id);
+
   KeyType KeyAt(int index) const;
 
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
 
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+
+  // insert and delete methods, return false if the page has no room for key
+  bool Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator, int& index);
 
-  // insert and delete methods
-  int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator, int& index);
+  bool CanInsert(const KeyType &key) const;
 
   bool IsLast(const KeyType &key, const KeyComparator & comparator);
 
+  // append a pair whose key is greater than all keys of this page, used by bulk loading
+  bool Append(const KeyType &key, const ValueType &value);
+
+  // whether bulk loading still appends key to this page filled to fill_factor
+  bool CanAppend(const KeyType &key, double fill_factor) const;
+
   bool Lookup(const KeyType &key, ValueType &value, const KeyComparator &comparator, int& index) const;
 
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
 
+  // an insert can not split this page
+  bool IsInsertSafe() const;
+
+  // a remove can not make this page underflow
+  bool IsRemoveSafe() const;
+
+  bool IsUnderflow() const;
+
   // Split and Merge utility methods
-  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveHalfTo(BPlusTreeLeafPage *recipient, const KeyType *key, const KeyComparator &comparator);
+
+  bool CanMoveAllTo(const BPlusTreeLeafPage *recipient) const;
 
   void MoveAllTo(BPlusTreeLeafPage *recipient);
 
@@ -66,15 +97,19 @@ public:
 
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
+  // key which separates the leaf ending with left from the leaf starting with right in their parent
+  static KeyType Separator(const KeyType &left, const KeyType &right);
+
 private:
-  void CopyNFrom(MappingType *items, int size);
+  void CopyNFrom(const MappingType *items, int size);
 
   void CopyLastFrom(const MappingType &item);
 
   void CopyFirstFrom(const MappingType &item);
 
   page_id_t next_page_id_;
-  MappingType array_[0];
+  page_id_t prev_page_id_;
+  Entries entries_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_LEAF_PAGE_H
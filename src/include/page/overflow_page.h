@@ -0,0 +1,65 @@
+#ifndef MINISQL_OVERFLOW_PAGE_H
+#define MINISQL_OVERFLOW_PAGE_H
+/**
+ * Overflow page, holds a part of a char value which is too large to be stored inline in a table page.
+ * A value is stored in a chain of overflow pages, the tuple only keeps a ToastPointer to the first page.
+ *
+ *  Overflow page format:
+ *  ----------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | DataSize (4) | Data |
+ *  ----------------------------------------------------------------
+ **/
+
+#include <cstring>
+
+#include "common/macros.h"
+#include "page/page.h"
+
+class OverflowPage : public Page {
+public:
+  void Init(page_id_t page_id, page_id_t next_page_id) {
+    memcpy(GetData(), &page_id, sizeof(page_id));
+    SetNextPageId(next_page_id);
+    SetDataSize(0);
+  }
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  uint32_t GetDataSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+
+  /**
+   * Copy a part of the value into this page
+   */
+  void WriteData(const char *data, uint32_t size) {
+    ASSERT(size <= SIZE_MAX_DATA, "Overflow page data too large.");
+    memcpy(GetData() + SIZE_OVERFLOW_PAGE_HEADER, data, size);
+    SetDataSize(size);
+  }
+
+  /**
+   * Copy the part of the value in this page to buf
+   * @return bytes copied
+   */
+  uint32_t ReadData(char *buf) {
+    uint32_t size = GetDataSize();
+    memcpy(buf, GetData() + SIZE_OVERFLOW_PAGE_HEADER, size);
+    return size;
+  }
+
+private:
+  void SetDataSize(uint32_t size) { memcpy(GetData() + OFFSET_DATA_SIZE, &size, sizeof(uint32_t)); }
+
+  static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_DATA_SIZE = 12;
+
+public:
+  static constexpr size_t SIZE_OVERFLOW_PAGE_HEADER = 16;
+  static constexpr size_t SIZE_MAX_DATA = PAGE_SIZE - SIZE_OVERFLOW_PAGE_HEADER;
+};
+
+#endif  // MINISQL_OVERFLOW_PAGE_H
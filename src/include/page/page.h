@@ -1,9 +1,11 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <shared_mutex>
+#include <thread>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -38,11 +40,17 @@ public:
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch, the version becomes odd until it is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -50,6 +58,24 @@ public:
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Begin an optimistic read, which reads the page without latching it.
+   * @return the page version, waits while a writer holds the page write latch
+   */
+  inline uint64_t GetVersion() const {
+    uint64_t version;
+    while ((version = version_.load(std::memory_order_acquire)) & 1) {
+      std::this_thread::yield();
+    }
+    return version;
+  }
+
+  /** @return true if no writer has latched the page since its version was read, i.e. the data read is consistent. */
+  inline bool ValidateVersion(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,6 +104,8 @@ private:
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Incremented when the write latch is acquired and released. */
+  std::atomic<uint64_t> version_{0};
 };
 
 #endif  // MINISQL_PAGE_H
@@ -0,0 +1,157 @@
+#ifndef MINISQL_PAX_PAGE_H
+#define MINISQL_PAX_PAGE_H
+/**
+ * PAX (Partition Attributes Across) page format, tuples of a page are stored column by column:
+ *  ------------------------------------------------------------------------------------------
+ *  | HEADER | Live bitmap | Mark bitmap | Column_1 minipage | ... | Column_N minipage |
+ *  ------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in bytes):
+ *  -------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| SlotCount (4) | LiveCount (4) |
+ *  -------------------------------------------------------------------------------------------
+ *
+ *  Minipage format:
+ *  -------------------------------------------------------
+ *  | Null bitmap | Value_1 | Value_2 | ... | Value_cap |
+ *  -------------------------------------------------------
+ *  Every value in a minipage has the same width: int and float use their type size, char uses
+ *  a 2 bytes length followed by the declared length of the column. All regions are 8 bytes aligned.
+ *
+ *  Slot i is a visible tuple iff bit i of live bitmap is set and bit i of mark bitmap (MarkDelete) is not.
+ **/
+
+#include <cstring>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "page/page.h"
+#include "record/row.h"
+#include "transaction/lock_manager.h"
+#include "transaction/log_manager.h"
+#include "transaction/transaction.h"
+
+/**
+ * Offsets of bitmaps and minipages inside a pax page, computed once per table schema
+ */
+class PaxLayout {
+public:
+  explicit PaxLayout(const Schema *schema);
+
+  /**
+   * @return max number of tuples in a page, 0 if a single tuple does not fit in a page
+   */
+  inline uint32_t GetCapacity() const { return capacity_; }
+
+  inline uint32_t GetColumnCount() const { return static_cast<uint32_t>(types_.size()); }
+
+  /**
+   * @return true iff all values of the row fit into the fixed width slots
+   */
+  bool Fits(const Row &row) const;
+
+private:
+  friend class PaxPage;
+
+  uint32_t GetPageSize(uint32_t capacity) const;
+
+  static uint32_t BitmapSize(uint32_t capacity) { return (capacity + 63) / 64 * sizeof(uint64_t); }
+
+  static uint32_t Align(uint32_t size) { return (size + 7) & ~7u; }
+
+  uint32_t capacity_{0};
+  uint32_t live_bitmap_offset_{0};
+  uint32_t mark_bitmap_offset_{0};
+  std::vector<TypeId> types_;
+  std::vector<uint32_t> widths_;
+  std::vector<uint32_t> null_offsets_;
+  std::vector<uint32_t> data_offsets_;
+};
+
+class PaxPage : public Page {
+public:
+  void Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn);
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  uint32_t GetLiveCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_LIVE_COUNT); }
+
+  bool InsertTuple(Row &row, const PaxLayout &layout, Transaction *txn, LockManager *lock_manager,
+                   LogManager *log_manager);
+
+  bool MarkDelete(const RowId &rid, const PaxLayout &layout, Transaction *txn, LockManager *lock_manager,
+                  LogManager *log_manager);
+
+  /**
+   * Values have fixed width, so an update always happens in place
+   */
+  bool UpdateTuple(const Row &new_row, const RowId &rid, const PaxLayout &layout, Transaction *txn,
+                   LockManager *lock_manager, LogManager *log_manager);
+
+  void ApplyDelete(const RowId &rid, const PaxLayout &layout, Transaction *txn, LogManager *log_manager);
+
+  void RollbackDelete(const RowId &rid, const PaxLayout &layout, Transaction *txn, LogManager *log_manager);
+
+  bool GetTuple(Row *row, const PaxLayout &layout, Transaction *txn, LockManager *lock_manager);
+
+  /**
+   * Read a single column of a tuple, only the minipage of the column is touched.
+   * Char field does not own its data, it is valid as long as the page is pinned.
+   */
+  bool GetField(const RowId &rid, uint32_t column_idx, const PaxLayout &layout, Field &field);
+
+  bool GetFirstTupleRid(const PaxLayout &layout, RowId *first_rid);
+
+  bool GetNextTupleRid(const PaxLayout &layout, const RowId &cur_rid, RowId *next_rid);
+
+private:
+  uint32_t GetSlotCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_SLOT_COUNT); }
+
+  void SetSlotCount(uint32_t slot_count) { memcpy(GetData() + OFFSET_SLOT_COUNT, &slot_count, sizeof(uint32_t)); }
+
+  void SetLiveCount(uint32_t live_count) { memcpy(GetData() + OFFSET_LIVE_COUNT, &live_count, sizeof(uint32_t)); }
+
+  uint64_t *GetBitmap(uint32_t offset) { return reinterpret_cast<uint64_t *>(GetData() + offset); }
+
+  static bool TestBit(const uint64_t *bitmap, uint32_t i) { return (bitmap[i / 64] >> (i % 64)) & 1; }
+
+  static void SetBit(uint64_t *bitmap, uint32_t i) { bitmap[i / 64] |= (1ULL << (i % 64)); }
+
+  static void ClearBit(uint64_t *bitmap, uint32_t i) { bitmap[i / 64] &= ~(1ULL << (i % 64)); }
+
+  bool IsVisible(const PaxLayout &layout, uint32_t slot_num);
+
+  /**
+   * @return the first visible slot >= slot_num, or slot count if there is none
+   */
+  uint32_t FindVisibleSlot(const PaxLayout &layout, uint32_t slot_num);
+
+  void WriteTuple(const Row &row, uint32_t slot_num, const PaxLayout &layout);
+
+  void ReadField(uint32_t slot_num, uint32_t column_idx, const PaxLayout &layout, Field &field, bool manage_data);
+
+private:
+  static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_SLOT_COUNT = 16;
+  static constexpr size_t OFFSET_LIVE_COUNT = 20;
+
+public:
+  static constexpr size_t SIZE_PAX_PAGE_HEADER = 24;
+};
+
+#endif  // MINISQL_PAX_PAGE_H
@@ -12,9 +12,12 @@
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------
+ *  | TupleCount (4) | SlotBitmap (64) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------------------------------------------
+ *
+ *  Bit i of SlotBitmap is set iff slot i holds a tuple (including tuples marked as deleted),
+ *  so a free slot to reuse and the next used slot can be found a word at a time.
  **/
 
 #include <cstring>
@@ -57,6 +60,12 @@ public:
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Read a single column of a tuple without decoding the other columns.
+   * Char field does not own its data, it is valid as long as the page is pinned.
+   */
+  bool GetField(const RowId &rid, uint32_t column_idx, Schema *schema, Field &field);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
@@ -98,17 +107,43 @@ private:
 
   static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
 
+  uint64_t *GetSlotBitmap() { return reinterpret_cast<uint64_t *>(GetData() + OFFSET_SLOT_BITMAP); }
+
+  void SetSlotUsed(uint32_t slot_num, bool used) {
+    auto bitmap = GetSlotBitmap();
+    if (used) {
+      bitmap[slot_num / 64] |= (1ULL << (slot_num % 64));
+    } else {
+      bitmap[slot_num / 64] &= ~(1ULL << (slot_num % 64));
+    }
+  }
+
+  /**
+   * @return the first slot which holds no tuple, or tuple count if all slots are used
+   */
+  uint32_t FindFreeSlot();
+
+  /**
+   * @return the first used slot >= slot_num, or tuple count if there is none
+   */
+  uint32_t FindUsedSlot(uint32_t slot_num);
+
 private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t MAX_SLOT_NUM = 512;
+  static constexpr size_t SIZE_SLOT_BITMAP = MAX_SLOT_NUM / 8;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24 + SIZE_SLOT_BITMAP;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_SLOT_BITMAP = 24;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = SIZE_TABLE_PAGE_HEADER;
+  static constexpr size_t OFFSET_TUPLE_SIZE = SIZE_TABLE_PAGE_HEADER + 4;
+  // 每个元组至少占用 1 字节数据和一个 slot，slot 数不会超过 bitmap 的大小
+  static_assert((PAGE_SIZE - SIZE_TABLE_PAGE_HEADER) / (SIZE_TUPLE + 1) <= MAX_SLOT_NUM);
 
 public:
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
@@ -19,9 +19,10 @@
 %token <syntax_node> IDENTIFIER STRING NUMBER EQ NE LE GE
 
 %type <syntax_node> start sql
-%type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database
+%type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database sql_check_database
 %type <syntax_node> sql_show_tables sql_create_table sql_drop_table
 %type <syntax_node> column_definition_list column_definition column_type column_list
+%type <syntax_node> table_option_list table_option
 %type <syntax_node> sql_create_index sql_drop_index sql_show_indexes
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
 %type <syntax_node> sql_select select_columns column_values column_value operator
@@ -43,6 +44,7 @@ sql:
   | sql_drop_database { $$ = $1; }
   | sql_show_databases { $$ = $1; }
   | sql_use_database { $$ = $1; }
+  | sql_check_database { $$ = $1; }
   | sql_show_tables { $$ = $1; }
   | sql_create_table { $$ = $1; }
   | sql_drop_table { $$ = $1; }
@@ -87,6 +89,16 @@ sql_use_database:
   }
   ;
 
+sql_check_database:
+  IDENTIFIER DATABASE {
+    if (strcmp($1->val_, "check") != 0) {
+      yyerror("syntax error, expect check before database");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeCheckDB, NULL);
+  }
+  ;
+
 sql_show_tables:
   SHOW TABLES {
     $$ = CreateSyntaxNode(kNodeShowTables, NULL);
@@ -101,6 +113,44 @@ sql_create_table:
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, list_node);
   }
+  | CREATE TABLE IDENTIFIER '(' column_definition_list ')' IDENTIFIER '(' table_option_list ')' {
+    /* with is not a reserved word, check it here */
+    if (strcmp($7->val_, "with") != 0) {
+      yyerror("syntax error, expect with before table options");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeCreateTable, NULL);
+    pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
+    SyntaxNodeAddChildren(list_node, $5);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, list_node);
+    pSyntaxNode options_node = CreateSyntaxNode(kNodeTableOptions, NULL);
+    SyntaxNodeAddChildren(options_node, $9);
+    SyntaxNodeAddChildren($$, options_node);
+  }
+  ;
+
+table_option_list:
+  table_option ',' table_option_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | table_option {
+    $$ = $1;
+  }
+  ;
+
+table_option:
+  IDENTIFIER EQ IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeTableOption, NULL);
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | IDENTIFIER EQ NUMBER {
+    $$ = CreateSyntaxNode(kNodeTableOption, NULL);
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
   ;
 
 column_list:
@@ -151,6 +201,15 @@ column_type:
     $$ = CreateSyntaxNode(kNodeColumnType, "char");
     SyntaxNodeAddChildren($$, $3);
   }
+  | IDENTIFIER {
+    /* bigint, double, date, timestamp, checked by the executor */
+    $$ = CreateSyntaxNode(kNodeColumnType, $1->val_);
+  }
+  | IDENTIFIER '(' NUMBER ')' {
+    /* varchar */
+    $$ = CreateSyntaxNode(kNodeColumnType, $1->val_);
+    SyntaxNodeAddChildren($$, $3);
+  }
   ;
 
 sql_drop_table:
@@ -43,7 +43,10 @@ typedef enum {
   kNodeIndexType, /** type of index */
   kNodeTrxBegin, /** begin transaction command */
   kNodeTrxCommit, /** commit transaction command */
-  kNodeTrxRollback /** rollback transaction command */
+  kNodeTrxRollback, /** rollback transaction command */
+  kNodeTableOptions, /** table options of create table, eg: with (layout = pax) */
+  kNodeTableOption, /** table option, contains option name and option value */
+  kNodeCheckDB /** check database command */
 } SyntaxNodeType;
 
 /**
@@ -0,0 +1,69 @@
+#ifndef MINISQL_DICTIONARY_H
+#define MINISQL_DICTIONARY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/macros.h"
+
+/**
+ * Dictionary of a dictionary encoded char column.
+ *
+ * Every distinct value of the column is given a code in the order the values are first seen, tuples
+ * store the code instead of the value. Codes are never reused or reordered, so that stored tuples stay
+ * valid as the dictionary grows. Values are concatenated in one buffer and located by an offset array,
+ * the same form as the char values of a ColumnVector, so that predicates can be evaluated once per
+ * distinct value with the char kernels.
+ *
+ *  Serialized format:
+ *  -------------------------------------------------------------------------
+ *  | Magic (4) | Count (4) | CharsSize (4) | Offsets (4 * Count) | Chars |
+ *  -------------------------------------------------------------------------
+ */
+class Dictionary {
+public:
+  Dictionary() : offsets_(1, 0) {}
+
+  inline uint32_t GetSize() const { return static_cast<uint32_t>(offsets_.size() - 1); }
+
+  inline const char *GetValue(uint32_t code) const { return chars_.data() + offsets_[code]; }
+
+  inline uint32_t GetLength(uint32_t code) const { return offsets_[code + 1] - offsets_[code]; }
+
+  /**
+   * Concatenated values and offsets of value i, the value ends at the offset of value i + 1.
+   * Pointers are invalidated by Insert
+   */
+  inline const char *GetChars() const { return chars_.data(); }
+
+  inline const uint32_t *GetOffsets() const { return offsets_.data(); }
+
+  /**
+   * @return code of value, INVALID_CODE if value is not in this dictionary
+   */
+  uint32_t Find(const char *value, uint32_t len) const;
+
+  /**
+   * @param[out] inserted Set to true iff value is new to this dictionary
+   * @return code of value, a new code is appended if value is not in this dictionary
+   */
+  uint32_t Insert(const char *value, uint32_t len, bool &inserted);
+
+  uint32_t SerializeTo(char *buf) const;
+
+  uint32_t GetSerializedSize() const;
+
+  static uint32_t DeserializeFrom(char *buf, Dictionary &dictionary);
+
+  static constexpr uint32_t INVALID_CODE = UINT32_MAX;
+
+private:
+  static constexpr uint32_t DICTIONARY_MAGIC_NUM = 611205;
+  std::vector<char> chars_;
+  std::vector<uint32_t> offsets_;
+  std::unordered_map<std::string, uint32_t> codes_;  /** value -> code */
+};
+
+#endif  // MINISQL_DICTIONARY_H
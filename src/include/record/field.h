@@ -8,6 +8,14 @@
 #include "record/types.h"
 #include "record/type_id.h"
 
+/**
+ * Inline reference to a char value stored out of line in a chain of overflow pages, see TableHeap
+ */
+struct ToastPointer {
+  page_id_t first_page_id_;
+  uint32_t len_;
+};
+
 class Field {
   friend class Type;
 
@@ -17,18 +25,34 @@ class Field {
 
   friend class TypeFloat;
 
+  friend class TypeBigInt;
+
+  friend class TypeDouble;
+
+  friend class TypeDate;
+
+  friend class TypeTimestamp;
+
+  friend class RowCodec;
+
+  friend class KeyCodec;
+
+  friend class ColumnVector;
+
+  friend class TableHeap;
+
 public:
   explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
   ~Field() {
-    if (type_id_ == TypeId::kTypeChar && manage_data_) {
+    if (Type::IsCharType(type_id_) && manage_data_ && !is_inline_) {
       delete[] value_.chars_;
     }
   }
 
-  // integer
+  // integer, or date as days since 1970-01-01
   explicit Field(TypeId type, int32_t i) : type_id_(type) {
-    ASSERT(type == TypeId::kTypeInt, "Invalid type.");
+    ASSERT(type == TypeId::kTypeInt || type == TypeId::kTypeDate, "Invalid type.");
     value_.integer_ = i;
     len_ = Type::GetTypeSize(type);
   }
@@ -40,9 +64,23 @@ public:
     len_ = Type::GetTypeSize(type);
   }
 
-  // char
+  // bigint, or timestamp as microseconds since 1970-01-01 00:00:00
+  explicit Field(TypeId type, int64_t i) : type_id_(type) {
+    ASSERT(type == TypeId::kTypeBigInt || type == TypeId::kTypeTimestamp, "Invalid type.");
+    value_.bigint_ = i;
+    len_ = Type::GetTypeSize(type);
+  }
+
+  // double
+  explicit Field(TypeId type, double d) : type_id_(type) {
+    ASSERT(type == TypeId::kTypeDouble, "Invalid type.");
+    value_.double_ = d;
+    len_ = Type::GetTypeSize(type);
+  }
+
+  // char or varchar, if manage_data is false the field is a view of data, eg: a value in a page
   explicit Field(TypeId type, char *data, uint32_t len, bool manage_data) : type_id_(type), manage_data_(manage_data) {
-    ASSERT(type == TypeId::kTypeChar, "Invalid type.");
+    ASSERT(Type::IsCharType(type), "Invalid type.");
     if (data == nullptr) {
       is_null_ = true;
       len_ = 0;
@@ -51,8 +89,7 @@ public:
     } else {
       if (manage_data) {
         ASSERT(len < VARCHAR_MAX_LEN, "Field length exceeds max varchar length");
-        value_.chars_ = new char[len];
-        memcpy(value_.chars_, data, len);
+        CopyChars(data, len);
       } else {
         value_.chars_ = data;
       }
@@ -60,15 +97,22 @@ public:
     }
   }
 
+  // toasted char, the data of the field is the pointer until it is detoasted
+  explicit Field(TypeId type, const ToastPointer &pointer) : type_id_(type), manage_data_(true), is_toasted_(true) {
+    ASSERT(Type::IsCharType(type), "Invalid type.");
+    CopyChars(reinterpret_cast<const char *>(&pointer), sizeof(ToastPointer));
+    len_ = sizeof(ToastPointer);
+  }
+
   // copy constructor
   explicit Field(const Field &other) {
     type_id_ = other.type_id_;
     len_ = other.len_;
     is_null_ = other.is_null_;
     manage_data_ = other.manage_data_;
-    if (type_id_ == TypeId::kTypeChar && !is_null_ && manage_data_) {
-      value_.chars_ = new char[len_];
-      memcpy(value_.chars_, other.value_.chars_, len_);
+    is_toasted_ = other.is_toasted_;
+    if (Type::IsCharType(type_id_) && !is_null_ && manage_data_) {
+      CopyChars(other.GetChars(), len_);
     } else {
       value_ = other.value_;
     }
@@ -84,6 +128,25 @@ public:
     return is_null_;
   }
 
+  inline TypeId GetTypeId() const {
+    return type_id_;
+  }
+
+  /**
+   * @return true if the char value is still stored out of line, GetData() and GetLength() refer to the
+   * ToastPointer then, use TableHeap::Detoast to fetch the value
+   */
+  inline bool IsToasted() const {
+    return is_toasted_;
+  }
+
+  inline ToastPointer GetToastPointer() const {
+    ASSERT(is_toasted_, "Field is not toasted.");
+    ToastPointer pointer;
+    memcpy(&pointer, GetChars(), sizeof(ToastPointer));
+    return pointer;
+  }
+
   inline uint32_t GetLength() const {
     return Type::GetInstance(type_id_)->GetLength(*this);
   }
@@ -136,18 +199,45 @@ public:
     std::swap(first.len_, second.len_);
     std::swap(first.is_null_, second.is_null_);
     std::swap(first.manage_data_, second.manage_data_);
+    std::swap(first.is_toasted_, second.is_toasted_);
+    std::swap(first.is_inline_, second.is_inline_);
   }
 
+  /**
+   * Values of at most INLINE_CHARS_LEN bytes owned by a field are stored in the field itself
+   */
+  static constexpr uint32_t INLINE_CHARS_LEN = 16;
+
 protected:
+  inline const char *GetChars() const {
+    return is_inline_ ? value_.inline_chars_ : value_.chars_;
+  }
+
+  // 拷贝一份 char 值，短的值直接存放在 value_ 中，不需要分配内存
+  inline void CopyChars(const char *data, uint32_t len) {
+    is_inline_ = len <= INLINE_CHARS_LEN;
+    if (is_inline_) {
+      memcpy(value_.inline_chars_, data, len);
+    } else {
+      value_.chars_ = new char[len];
+      memcpy(value_.chars_, data, len);
+    }
+  }
+
   union Val {
     int32_t integer_;
     float float_;
+    int64_t bigint_;
+    double double_;
     char *chars_;
+    char inline_chars_[INLINE_CHARS_LEN];
   } value_;
   TypeId type_id_;
   uint32_t len_;
   bool is_null_{false};
   bool manage_data_{false};
+  bool is_toasted_{false};
+  bool is_inline_{false};     /** the char value is in value_.inline_chars_ */
 };
 
 
@@ -0,0 +1,50 @@
+#ifndef MINISQL_PREDICATE_KERNELS_H
+#define MINISQL_PREDICATE_KERNELS_H
+
+#include <cstdint>
+
+/**
+ * Compare operators of a where condition, is and not stand for is null and not null
+ */
+enum class CompareOp { kEqual, kNotEqual, kLessThan, kLessThanEqual, kGreaterThan, kGreaterThanEqual, kIsNull,
+                       kNotNull, kInvalid };
+
+CompareOp ParseCompareOp(const char *op);
+
+/**
+ * Predicate kernels, evaluate `values[i] <op> operand` for i in [0, count) into a bitmap.
+ * Bit i % 64 of matches[i / 64] is set iff value i matches, bits from count up to the end of the last
+ * word are cleared. Nulls are not considered here, the caller masks them out.
+ *
+ * Every kernel has an AVX2 version and a scalar version, the AVX2 one is chosen at runtime if the cpu
+ * supports it. op must be one of the six comparisons.
+ */
+class PredicateKernels {
+public:
+  static void FilterInt32(const int32_t *values, uint32_t count, CompareOp op, int32_t operand, uint64_t *matches);
+
+  static void FilterFloat(const float *values, uint32_t count, CompareOp op, float operand, uint64_t *matches);
+
+  static void FilterInt64(const int64_t *values, uint32_t count, CompareOp op, int64_t operand, uint64_t *matches);
+
+  static void FilterDouble(const double *values, uint32_t count, CompareOp op, double operand, uint64_t *matches);
+
+  /**
+   * Values of the same length width stored back to back, eg: values of a char(n) column
+   */
+  static void FilterFixedChars(const char *values, uint32_t width, uint32_t count, CompareOp op, const char *operand,
+                               uint32_t operand_len, uint64_t *matches);
+
+  /**
+   * Values of any length, value i is chars[offsets[i], offsets[i + 1])
+   */
+  static void FilterChars(const char *chars, const uint32_t *offsets, uint32_t count, CompareOp op,
+                          const char *operand, uint32_t operand_len, uint64_t *matches);
+
+  /**
+   * @return true if the AVX2 kernels are used
+   */
+  static bool UseAvx2();
+};
+
+#endif  // MINISQL_PREDICATE_KERNELS_H
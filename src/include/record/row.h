@@ -10,16 +10,7 @@
 #include "utils/mem_heap.h"
 
 /**
- *  Row format:
- * -------------------------------------------
- * | Header | Field-1 | ... | Field-N |
- * -------------------------------------------
- *  Header format:
- * --------------------------------------------
- * | Field Nums | Null bitmap |
- * -------------------------------------------
- *  
- *
+ * Row format is defined by RowCodec, rows are encoded and decoded by the codec of their schema.
  */
 class Row {
 public:
@@ -27,7 +18,7 @@ public:
    * Row used for insert
    * Field integrity should check by upper level
    */
-  explicit Row(std::vector<Field> &fields) : heap_(new SimpleMemHeap) {
+  explicit Row(std::vector<Field> &fields) : heap_(&arena_) {
     // deep copy
     for (auto &field : fields) {
       void *buf = heap_->Allocate(sizeof(Field));
@@ -43,12 +34,18 @@ public:
   /**
    * Row used for deserialize and update
    */
-  Row(RowId rid) : rid_(rid), heap_(new SimpleMemHeap) {}
+  Row(RowId rid) : rid_(rid), heap_(&arena_) {}
+
+  /**
+   * Row whose fields are allocated from heap, which is shared by many rows (eg: an arena of a scan)
+   * and must outlive the row
+   */
+  Row(RowId rid, MemHeap *heap) : rid_(rid), heap_(heap) {}
 
   /**
    * Row copy function
    */
-  Row(const Row &other) : heap_(new SimpleMemHeap) {
+  Row(const Row &other) : heap_(&arena_) {
     if (!fields_.empty()) {
       for (auto &field : fields_) {
         heap_->Free(field);
@@ -63,7 +60,10 @@ public:
   }
 
   virtual ~Row() {
-    delete heap_;
+    // field 的内存由 heap 统一释放，这里只需析构
+    for (auto field : fields_) {
+      field->~Field();
+    }
   }
 
   /**
@@ -93,13 +93,24 @@ public:
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
+  /**
+   * Append a copy of field to the row, used when decoding tuples from non-row page formats
+   */
+  inline void AppendField(const Field &field) {
+    void *buf = heap_->Allocate(sizeof(Field));
+    fields_.push_back(new(buf)Field(field));
+  }
+
 private:
   Row &operator=(const Row &other) = delete;
 
 private:
   RowId rid_{};
   std::vector<Field *> fields_;   /** Make sure that all fields are created by mem heap */
-  MemHeap *heap_{nullptr};
+  ArenaMemHeap arena_{ROW_ARENA_CHUNK_SIZE};
+  MemHeap *heap_{nullptr};        /** arena_ of the row itself, or a heap borrowed from the caller */
+
+  static constexpr size_t ROW_ARENA_CHUNK_SIZE = 256;
 };
 
 #endif //MINISQL_TUPLE_H
@@ -0,0 +1,159 @@
+#ifndef MINISQL_ROW_BATCH_H
+#define MINISQL_ROW_BATCH_H
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "record/dictionary.h"
+#include "record/field.h"
+#include "record/predicate_kernels.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Values of one column of a batch of rows, stored in a typed contiguous array plus a null bitmap.
+ * Fixed width values are at data + i * width, char values are concatenated in a separate buffer and
+ * located by an offset array. A null value still takes its slot.
+ *
+ * A char column with a dictionary stores the codes of its values as ints instead, chars are read from
+ * the dictionary and predicates are evaluated on the codes.
+ */
+class ColumnVector {
+public:
+  explicit ColumnVector(TypeId type);
+
+  inline TypeId GetType() const { return type_; }
+
+  inline uint32_t GetSize() const { return size_; }
+
+  inline bool IsNull(uint32_t idx) const { return (nulls_[idx / 64] >> (idx % 64)) & 1; }
+
+  inline const uint64_t *GetNullBitmap() const { return nulls_; }
+
+  /**
+   * Values of int and date columns, codes of the values of a column with a dictionary
+   */
+  inline const int32_t *GetInts() const { return reinterpret_cast<const int32_t *>(data_.data()); }
+
+  inline const float *GetFloats() const { return reinterpret_cast<const float *>(data_.data()); }
+
+  /**
+   * Values of bigint and timestamp columns, date columns are read by GetInts
+   */
+  inline const int64_t *GetBigInts() const { return reinterpret_cast<const int64_t *>(data_.data()); }
+
+  inline const double *GetDoubles() const { return reinterpret_cast<const double *>(data_.data()); }
+
+  inline const char *GetChars(uint32_t idx) const {
+    return dictionary_ ? dictionary_->GetValue(GetInts()[idx]) : chars_.data() + char_offsets_[idx];
+  }
+
+  inline uint32_t GetCharLength(uint32_t idx) const {
+    return dictionary_ ? dictionary_->GetLength(GetInts()[idx]) : char_offsets_[idx + 1] - char_offsets_[idx];
+  }
+
+  inline const Dictionary *GetDictionary() const { return dictionary_; }
+
+  /**
+   * Store codes of dictionary instead of char values, fields appended after are int codes.
+   * Only called on an empty char column
+   */
+  void SetDictionary(const Dictionary *dictionary);
+
+  /**
+   * Append a copy of field, a toasted field must be detoasted before
+   */
+  void Append(const Field &field);
+
+  /**
+   * Evaluate `value <op> operand` for all values, see PredicateKernels. Null values never match
+   * except for is null.
+   * @param matches Bitmap of BATCH_SIZE bits, bit i is set iff value i matches
+   */
+  void Filter(const char *op, const Field &operand, uint64_t *matches) const;
+
+  void Reset();
+
+private:
+  /**
+   * Filter of a column with a dictionary, null values are masked by the caller
+   */
+  void FilterCodes(CompareOp op, const Field &operand, uint64_t *matches) const;
+
+private:
+  TypeId type_;
+  uint32_t width_;
+  uint32_t size_{0};
+  uint64_t nulls_[BATCH_SIZE / 64];
+  std::vector<char> data_;             /** fixed width values */
+  std::vector<uint32_t> char_offsets_; /** begin of char value i, the value ends at the begin of value i + 1 */
+  std::vector<char> chars_;
+  uint32_t char_width_{0};
+  bool uniform_chars_{true};           /** all char values have char_width_ bytes, eg: values of char(n) */
+  const Dictionary *dictionary_{nullptr};
+};
+
+/**
+ * A batch of up to BATCH_SIZE rows stored column by column, the unit of work of scans, filters and output.
+ *
+ * A batch holds a subset of the columns of a table, only the columns an operator needs are copied in.
+ * The selection vector lists the positions of the rows which are still alive, filters shrink it
+ * instead of moving values, so that the columns are written only once. Filters evaluate a whole
+ * column into a bitmap with the SIMD kernels and intersect it with the selection.
+ */
+class RowBatch {
+public:
+  /**
+   * @param schema Schema of the rows appended to the batch
+   * @param column_ids Columns of the schema stored in the batch, column j of the batch is column_ids[j] of the row
+   */
+  RowBatch(const Schema *schema, std::vector<uint32_t> column_ids);
+
+  inline uint32_t GetSize() const { return static_cast<uint32_t>(rids_.size()); }
+
+  inline bool IsFull() const { return rids_.size() == BATCH_SIZE; }
+
+  inline uint32_t GetColumnCount() const { return static_cast<uint32_t>(columns_.size()); }
+
+  inline const std::vector<uint32_t> &GetColumnIds() const { return column_ids_; }
+
+  inline const ColumnVector &GetColumn(uint32_t idx) const { return columns_[idx]; }
+
+  inline const RowId &GetRowId(uint32_t idx) const { return rids_[idx]; }
+
+  /**
+   * Positions of the selected rows in ascending order, all rows are selected after they are appended
+   */
+  inline const uint16_t *GetSelection() const { return selection_; }
+
+  inline uint32_t GetSelectedCount() const { return selected_count_; }
+
+  /**
+   * Append the stored columns of row, fields of these columns must be detoasted
+   */
+  void Append(const Row &row);
+
+  /**
+   * Values of column are appended as codes of dictionary, see ColumnVector::SetDictionary
+   */
+  void SetDictionary(uint32_t column_idx, const Dictionary *dictionary);
+
+  /**
+   * Keep only the selected rows whose value of column satisfies `value <op> operand`
+   * @param op Compare operator, is and not stand for is null and not null
+   */
+  void Filter(uint32_t column_idx, const char *op, const Field &operand);
+
+  void Reset();
+
+private:
+  std::vector<uint32_t> column_ids_;
+  std::vector<ColumnVector> columns_;
+  std::vector<RowId> rids_;
+  uint64_t selected_bits_[BATCH_SIZE / 64]{};
+  uint16_t selection_[BATCH_SIZE];
+  uint32_t selected_count_{0};
+};
+
+#endif  // MINISQL_ROW_BATCH_H
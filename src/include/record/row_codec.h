@@ -0,0 +1,94 @@
+#ifndef MINISQL_ROW_CODEC_H
+#define MINISQL_ROW_CODEC_H
+
+#include <vector>
+
+#include "record/column.h"
+#include "record/field.h"
+#include "utils/mem_heap.h"
+
+/**
+ *  Row format:
+ * ------------------------------------------------------------------------
+ * | Version (1) | Null bitmap | Fixed values | Offset table | Char values |
+ * ------------------------------------------------------------------------
+ *  Null bitmap has 1 bit per column.
+ *  Fixed values are values of all other columns at offsets precomputed from the schema, a null value still
+ *  takes its slot so that the offsets do not depend on the row.
+ *  Offset table has a 2 bytes entry per char column, holding the end offset of its value in the row,
+ *  the value starts at the end of the previous char value. The highest bit of the entry is set if
+ *  the value is a ToastPointer.
+ *
+ *  So any single field is located without decoding the fields before it.
+ *  Rows written before the version byte was introduced are still readable.
+ */
+
+/**
+ * Encoder and decoder of rows of one schema, compiled when the schema is created.
+ *
+ * The codec keeps a flat array of column types and offsets, so encoding and decoding do not go
+ * through the virtual Type interface nor the columns of the schema. Schemas without char columns
+ * take a specialized path: every field is a load or store at a constant offset and the size of
+ * a row is a constant.
+ */
+class RowCodec {
+public:
+  explicit RowCodec(const std::vector<Column *> &columns);
+
+  /**
+   * @return bytes written to buf, equal to GetSerializedSize(fields)
+   */
+  uint32_t Encode(const std::vector<Field *> &fields, char *buf) const;
+
+  /**
+   * Append the fields of the row in buf to fields, fields are allocated from heap
+   * @return bytes read from buf
+   */
+  uint32_t Decode(char *buf, std::vector<Field *> &fields, MemHeap *heap) const;
+
+  /**
+   * Decode a single field of the row in buf
+   * @param manage_data If false, char field points to buf instead of copying the value
+   */
+  void DecodeField(char *buf, uint32_t column_idx, Field &field, bool manage_data) const;
+
+  uint32_t GetSerializedSize(const std::vector<Field *> &fields) const;
+
+  /**
+   * For a fixed width column the offset of its value, for a char column the offset of its entry in the
+   * offset table. Offsets are relative to the start of the row.
+   */
+  inline uint32_t GetFieldOffset(uint32_t column_idx) const { return slots_[column_idx].offset_; }
+
+  /**
+   * @return size of the fixed part of a row: header, fixed width values and the offset table
+   */
+  inline uint32_t GetFixedSize() const { return fixed_size_; }
+
+  inline bool IsAllFixed() const { return all_fixed_; }
+
+private:
+  struct Slot {
+    TypeId type_;
+    uint32_t offset_;
+    uint32_t begin_offset_;   /** char only, offset of the entry holding the begin of the value, 0 for the first */
+  };
+
+  template<bool ALL_FIXED>
+  uint32_t EncodeRow(const std::vector<Field *> &fields, char *buf) const;
+
+  template<bool ALL_FIXED>
+  uint32_t DecodeRow(char *buf, std::vector<Field *> &fields, MemHeap *heap) const;
+
+  Field *DecodeSlot(char *buf, uint32_t idx, MemHeap *heap, bool manage_data) const;
+
+  uint32_t DecodeLegacy(char *buf, std::vector<Field *> &fields, MemHeap *heap) const;
+
+  static constexpr size_t FIELD_ARENA_SIZE = 64;
+
+  std::vector<Slot> slots_;
+  uint32_t fixed_size_{0};
+  bool all_fixed_{true};
+};
+
+#endif  // MINISQL_ROW_CODEC_H
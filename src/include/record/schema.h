@@ -4,13 +4,14 @@
 #include "common/macros.h"
 #include "glog/logging.h"
 #include "record/column.h"
+#include "record/row_codec.h"
 
 #ifndef MINISQL_SCHEMA_H
 #define MINISQL_SCHEMA_H
 
 class Schema {
 public:
-  explicit Schema(const std::vector<Column *> columns) : columns_(std::move(columns)) {}
+  explicit Schema(const std::vector<Column *> columns) : columns_(std::move(columns)), codec_(columns_) {}
 
   inline const std::vector<Column *> &GetColumns() const { return columns_; }
 
@@ -28,6 +29,11 @@ public:
 
   inline uint32_t GetColumnCount() const { return static_cast<uint32_t>(columns_.size()); }
 
+  /**
+   * @return codec of rows of this schema, compiled when the schema is created
+   */
+  inline const RowCodec &GetRowCodec() const { return codec_; }
+
   /**
    * Shallow copy schema, only used in index
    *
@@ -75,6 +81,7 @@ public:
 private:
   static constexpr uint32_t SCHEMA_MAGIC_NUM = 200715;
   std::vector<Column *> columns_;   /** don't need to delete pointer to column */
+  RowCodec codec_;
 };
 
 using IndexSchema = Schema;
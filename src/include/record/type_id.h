@@ -6,7 +6,12 @@ enum TypeId {
   kTypeInt,
   kTypeFloat,
   kTypeChar,
-  KMaxTypeId = kTypeChar
+  kTypeBigInt,
+  kTypeDouble,
+  kTypeDate,
+  kTypeTimestamp,
+  kTypeVarchar,
+  KMaxTypeId = kTypeVarchar
 };
 
 #endif //MINISQL_TYPE_ID_H
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cmath>
 #include <exception>
+#include <string>
 #include "record/type_id.h"
 #include "common/config.h"
 #include "utils/mem_heap.h"
@@ -32,12 +33,29 @@ public:
         return sizeof(float);
       case kTypeChar:
         return 0;
+      case kTypeBigInt:
+        return sizeof(int64_t);
+      case kTypeDouble:
+        return sizeof(double);
+      case kTypeDate:
+        return sizeof(int32_t);
+      case kTypeTimestamp:
+        return sizeof(int64_t);
+      case kTypeVarchar:
+        return 0;
       default:
         break;
     }
     throw "Unknown field type.";
   }
 
+  /**
+   * @return true for char and varchar, whose values have a variable length
+   */
+  static bool IsCharType(TypeId type_id) {
+    return type_id == kTypeChar || type_id == kTypeVarchar;
+  }
+
   inline static Type *GetInstance(TypeId type_id) {
     return type_singletons_[type_id];
   }
@@ -82,6 +100,9 @@ class TypeInt : public Type {
 public:
   explicit TypeInt() : Type(TypeId::kTypeInt) {}
 
+  // for types stored as an int32_t
+  explicit TypeInt(TypeId type_id) : Type(type_id) {}
+
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
   virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const override;
@@ -107,6 +128,9 @@ class TypeChar : public Type {
 public:
   explicit TypeChar() : Type(TypeId::kTypeChar) {}
 
+  // for types stored as chars
+  explicit TypeChar(TypeId type_id) : Type(type_id) {}
+
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
   virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const override;
@@ -155,5 +179,113 @@ public:
   virtual CmpBool CompareGreaterThanEquals(const Field &left, const Field &right) const override;
 };
 
+class TypeBigInt : public Type {
+public:
+  explicit TypeBigInt() : Type(TypeId::kTypeBigInt) {}
+
+  // for types stored as an int64_t
+  explicit TypeBigInt(TypeId type_id) : Type(type_id) {}
+
+  virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
+
+  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const override;
+
+  virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
+
+  virtual const char* GetData(const Field &val) const override;
+
+  virtual CmpBool CompareEquals(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareNotEquals(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareLessThan(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareLessThanEquals(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareGreaterThan(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareGreaterThanEquals(const Field &left, const Field &right) const override;
+};
+
+class TypeDouble : public Type {
+public:
+  explicit TypeDouble() : Type(TypeId::kTypeDouble) {}
+
+  virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
+
+  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const override;
+
+  virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
+
+  virtual const char* GetData(const Field &val) const override;
+
+  virtual CmpBool CompareEquals(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareNotEquals(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareLessThan(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareLessThanEquals(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareGreaterThan(const Field &left, const Field &right) const override;
+
+  virtual CmpBool CompareGreaterThanEquals(const Field &left, const Field &right) const override;
+};
+
+/**
+ * Date stored as the number of days since 1970-01-01, compared as an int
+ */
+class TypeDate : public TypeInt {
+public:
+  explicit TypeDate() : TypeInt(TypeId::kTypeDate) {}
+
+  virtual const char* GetData(const Field &val) const override;
+
+  /**
+   * Parse a date of the form yyyy-mm-dd
+   * @return false if str is not a valid date
+   */
+  static bool Parse(const char *str, int32_t &days);
+
+  /**
+   * Write days as yyyy-mm-dd into buf, buf must hold at least MAX_TEXT_LEN bytes
+   */
+  static void Format(int32_t days, char *buf);
+
+  static constexpr uint32_t MAX_TEXT_LEN = 16;
+};
+
+/**
+ * Timestamp stored as the number of microseconds since 1970-01-01 00:00:00, compared as a bigint
+ */
+class TypeTimestamp : public TypeBigInt {
+public:
+  explicit TypeTimestamp() : TypeBigInt(TypeId::kTypeTimestamp) {}
+
+  virtual const char* GetData(const Field &val) const override;
+
+  /**
+   * Parse a timestamp of the form yyyy-mm-dd[ hh:mm:ss[.ffffff]]
+   * @return false if str is not a valid timestamp
+   */
+  static bool Parse(const char *str, int64_t &micros);
+
+  /**
+   * Write micros as yyyy-mm-dd hh:mm:ss, followed by the fraction if it is not 0, buf must hold at
+   * least MAX_TEXT_LEN bytes
+   */
+  static void Format(int64_t micros, char *buf);
+
+  static constexpr uint32_t MAX_TEXT_LEN = 40;
+};
+
+/**
+ * Char column whose values are stored with their actual length instead of being padded to the
+ * declared length, compared as char
+ */
+class TypeVarchar : public TypeChar {
+public:
+  explicit TypeVarchar() : TypeChar(TypeId::kTypeVarchar) {}
+};
 
 #endif //MINISQL_TYPES_H
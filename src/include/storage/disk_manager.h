@@ -6,6 +6,7 @@
 #include <iostream>
 #include <mutex>
 #include <string>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
@@ -18,6 +19,14 @@
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ *
+ * A page may be stored compressed in its slot, only the sectors holding the compressed frame are written:
+ * | Magic (4) | CompressedSize (4) | Compressed page, see PageCompressor |
+ * The magic is a negative page id, pages stored as they are never start with it.
+ *
+ * Every physical page written has a CRC-32C checksum of the bytes written, verified when the page is read.
+ * Checksums are kept in a separate file <db_file>.crc, 4 bytes per physical page, as all page formats use
+ * the whole page. A checksum of 0 means the page has not been written since the checksum file was created.
  */
 class DiskManager {
 public:
@@ -30,16 +39,19 @@ public:
   }
 
   /**
-   * Read page from specific page_id
+   * Read page from specific page_id, a compressed page is decompressed
    * Note: page_id = 0 is reserved for disk meta page
+   * @param[out] compressed Set to true if the page is stored compressed
+   * @return false if the page does not match its checksum
    */
-  void ReadPage(page_id_t logical_page_id, char *page_data);
+  bool ReadPage(page_id_t logical_page_id, char *page_data, bool *compressed = nullptr);
 
   /**
    * Write data to specific page
    * Note: page_id = 0 is reserved for disk meta page
+   * @param compress Store the page compressed, the page is stored as it is if it does not save a sector
    */
-  void WritePage(page_id_t logical_page_id, const char *page_data);
+  void WritePage(page_id_t logical_page_id, const char *page_data, bool compress = false);
 
   /**
    * Get next free page from disk
@@ -57,6 +69,15 @@ public:
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Verify the checksums of all allocated pages, pages are read in parallel with their own file handles.
+   * Pages modified in memory and not written yet are not checked.
+   * @param[out] corrupted Logical ids of the pages which do not match their checksums, in ascending order
+   * @param[in] num_workers Number of threads, 0 for the number of hardware threads
+   * @return number of pages checked
+   */
+  uint32_t CheckPages(std::vector<page_id_t> &corrupted, uint32_t num_workers = 0);
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -72,6 +93,8 @@ public:
 
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
+  static constexpr uint32_t SECTOR_SIZE = 512;
+
 private:
   /**
    * Helper function to get disk file size
@@ -79,24 +102,49 @@ private:
   int GetFileSize(const std::string &file_name);
 
   /**
-   * Read physical page from disk
+   * Read physical page from disk, a page beyond the end of the file is read as zeros
+   * @return false if the page does not match its checksum
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  bool ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
 
   /**
    * Write data to physical page in disk
+   * @param size Bytes to write from the begin of the page
    */
-  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
+  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data, size_t size = PAGE_SIZE);
 
   /**
    * Map logical page id to physical page id
    */
   static page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * @return bytes covered by the checksum of a page, the sectors of the frame for a compressed page
+   */
+  static uint32_t GetStoredSize(const char *page_data);
+
+  /**
+   * @return checksum of the first size bytes of page, never 0
+   */
+  static uint32_t ComputeChecksum(const char *page_data, uint32_t size);
+
+  /**
+   * Read a physical page and its checksum from the given files, used by both reads and CheckPages
+   * @return false if the page does not match its checksum
+   */
+  static bool ReadAndVerify(std::istream &db_io, size_t db_file_size, std::istream &crc_io, size_t crc_file_size,
+                            page_id_t physical_page_id, char *page_data);
+
 private:
+  static constexpr uint32_t COMPRESSED_PAGE_MAGIC = 0xC0DEC0DE;
+  static constexpr uint32_t SIZE_COMPRESSED_HEADER = 8;
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
+  // stream of checksums of physical pages
+  std::fstream crc_io_;
+  std::string crc_file_name_;
+  size_t crc_file_size_{0};
   // with multiple buffer pool instances, need to protect file access
   std::recursive_mutex db_io_latch_;
   bool closed{false};
@@ -0,0 +1,46 @@
+#ifndef MINISQL_PAGE_COMPRESSOR_H
+#define MINISQL_PAGE_COMPRESSOR_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * Compression of whole pages written by the disk manager, a byte oriented LZ77 codec in the style of LZ4.
+ *
+ * The compressed form is a list of sequences, each copies some literal bytes and then a match of at least
+ * MIN_MATCH bytes from earlier output. The last sequence has literals only.
+ *
+ *  Sequence format:
+ *  -----------------------------------------------------------------------------------------------
+ *  | Token (1) | LiteralLength (0+) | Literals | Offset (2) | MatchLength (0+) |
+ *  -----------------------------------------------------------------------------------------------
+ *  The high 4 bits of token are the literal length, the low 4 bits are the match length - MIN_MATCH.
+ *  A nibble of 15 is followed by extra length bytes, each adds up to 255, a byte less than 255 ends the length.
+ *  Offset is the distance back from the current output position, a match may overlap its own output,
+ *  eg: a run of zeros is a literal zero followed by a match of offset 1.
+ */
+class PageCompressor {
+public:
+  /**
+   * Compress a page of PAGE_SIZE bytes
+   * @param[out] buf Compressed page
+   * @param[in] max_len Capacity of buf
+   * @return compressed size, 0 if the page does not compress into max_len bytes
+   */
+  static uint32_t Compress(const char *page, char *buf, uint32_t max_len);
+
+  /**
+   * @param[out] page Decompressed page of PAGE_SIZE bytes
+   * @return false if buf is not a valid compressed page
+   */
+  static bool Decompress(const char *buf, uint32_t len, char *page);
+
+  static constexpr uint32_t MIN_MATCH = 4;
+
+private:
+  static_assert(PAGE_SIZE <= UINT16_MAX + 1, "Offsets of matches are stored in 2 bytes.");
+  static constexpr uint32_t HASH_BITS = 12;
+};
+
+#endif  // MINISQL_PAGE_COMPRESSOR_H
@@ -0,0 +1,65 @@
+#ifndef MINISQL_PARALLEL_SCAN_H
+#define MINISQL_PARALLEL_SCAN_H
+
+#include <functional>
+#include <vector>
+
+#include "common/rowid.h"
+#include "record/row.h"
+#include "storage/table_heap.h"
+#include "transaction/transaction.h"
+
+/**
+ * Morsel driven parallel scan of a table heap.
+ *
+ * The page list of the heap is cut into morsels of MORSEL_SIZE consecutive pages. Workers take
+ * the next morsel from a shared counter until all morsels are consumed, so a worker which hits
+ * cheap (eg: skipped) pages simply takes more morsels. Every worker evaluates the predicate on its
+ * own pages and keeps matching rids locally; the local results are merged once all workers finish.
+ *
+ * Tables with fewer than two morsels are scanned by the calling thread.
+ */
+class ParallelScan {
+public:
+  /**
+   * @param num_workers Max number of worker threads, 0 to use the number of hardware threads
+   */
+  explicit ParallelScan(TableHeap *table_heap, uint32_t num_workers = 0);
+
+  /**
+   * Collect rids of all tuples which satisfy predicate.
+   * Both callbacks are called concurrently from different workers, they must be thread safe.
+   * @param page_filter Called once per page, return false to skip the page (eg: by zone map)
+   * @param predicate Called for every tuple of the pages which are not skipped
+   * @param txn Transaction performing the scan
+   * @return rids of matching tuples in ascending order
+   */
+  std::vector<RowId> Filter(const std::function<bool(page_id_t)> &page_filter,
+                            const std::function<bool(const Row &)> &predicate, Transaction *txn);
+
+  /**
+   * Collect rids of all tuples whose value of column satisfies `value <op> operand`.
+   * Every worker copies the column of its pages into a RowBatch and evaluates the condition a batch at a time.
+   * @param page_filter Called once per page, return false to skip the page
+   * @return rids of matching tuples in ascending order
+   */
+  std::vector<RowId> Filter(const std::function<bool(page_id_t)> &page_filter, uint32_t column_idx, const char *op,
+                            const Field &operand, Transaction *txn);
+
+  inline uint32_t GetNumWorkers() const { return num_workers_; }
+
+  static constexpr size_t MORSEL_SIZE = 8;
+
+private:
+  /**
+   * Let the workers call scan_morsel on all morsels and merge their results
+   * @param scan_morsel Append rids of matching tuples in pages [begin, end) to result
+   */
+  std::vector<RowId> Run(
+          const std::function<void(const page_id_t *begin, const page_id_t *end, std::vector<RowId> &result)> &scan_morsel);
+
+  TableHeap *table_heap_;
+  uint32_t num_workers_;
+};
+
+#endif  // MINISQL_PARALLEL_SCAN_H
@@ -1,33 +1,85 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <memory>
 #include <queue>
 #include "buffer/buffer_pool_manager.h"
+#include "page/overflow_page.h"
+#include "page/pax_page.h"
 #include "page/table_page.h"
+#include "record/row_batch.h"
 #include "storage/table_iterator.h"
+#include "storage/zone_map.h"
 #include "transaction/log_manager.h"
 #include "transaction/lock_manager.h"
 
+/**
+ * A dictionary encoded column of a table heap, the dictionary is stored in a chain of overflow pages.
+ * The first page of the chain never changes, so that it can be recorded in the table metadata.
+ */
+struct DictionaryColumn {
+  uint32_t column_idx_;
+  page_id_t first_page_id_;
+};
+
+/**
+ * Page format of a table heap
+ */
+enum TableLayout : uint32_t {
+  kLayoutNSM = 0,   /** slotted page, tuples are stored row by row, see TablePage */
+  kLayoutPAX,       /** tuples are stored column by column in minipages, see PaxPage */
+};
+
+/**
+ * How pages of a table heap are stored on disk
+ */
+enum TableCompression : uint32_t {
+  kCompressionNone = 0,
+  kCompressionLZ,   /** pages are compressed by the disk manager, see PageCompressor */
+};
+
 class TableHeap {
   friend class TableIterator;
 
 public:
+  /**
+   * @param dictionary_columns Char columns to store dictionary encoded, see Dictionary
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           TableLayout layout = kLayoutNSM, const std::vector<uint32_t> &dictionary_columns = {},
+                           TableCompression compression = kCompressionNone) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, layout, dictionary_columns,
+                              compression);
   }
 
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           TableLayout layout = kLayoutNSM, const std::vector<DictionaryColumn> &dictionaries = {},
+                           TableCompression compression = kCompressionNone) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, layout,
+                              dictionaries, compression);
   }
 
-  ~TableHeap() {}
+  ~TableHeap() {
+    delete pax_layout_;
+    for (auto dictionary : dictionaries_) {
+      delete dictionary;
+    }
+    if (stored_schema_ != schema_) {
+      for (auto column : stored_schema_->GetColumns()) {
+        delete column;
+      }
+      delete stored_schema_;
+    }
+  }
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Char values longer than TOAST_THRESHOLD are moved to overflow pages first (row layout only).
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
    * @return true iff the insert is successful
@@ -69,9 +121,15 @@ public:
    * Read a tuple from the table.
    * @param[in/out] row Output variable for the tuple, row id of the tuple is wrapped in row
    * @param[in] txn transaction performing the read
+   * @param[in] detoast If false, values stored in overflow pages are left as toasted fields, see Detoast
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(Row *row, Transaction *txn);
+  bool GetTuple(Row *row, Transaction *txn, bool detoast = true);
+
+  /**
+   * Fetch the value of a toasted field from its overflow pages, do nothing if the field is not toasted
+   */
+  void Detoast(Field *field);
 
   /**
    * Free table heap and release storage in disk file
@@ -93,6 +151,71 @@ public:
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return ids of all pages in this table, in the order of the page chain
+   */
+  inline const std::vector<page_id_t> &GetPageIds() const { return page_ids_; }
+
+  /**
+   * @return per page min/max summaries of this table, used to skip pages in scans
+   */
+  inline const ZoneMap &GetZoneMap() const { return zone_map_; }
+
+  /**
+   * Visit all tuples stored in one page of this table, the page is fetched only once.
+   * Values in overflow pages are not fetched, call Detoast on the fields which are needed.
+   * @param[in] page_id Page to scan
+   * @param[in] visitor Called for each live tuple in slot order
+   * @param[in] txn Transaction performing the read
+   * @return false if the page could not be fetched
+   */
+  bool ScanPage(page_id_t page_id, const std::function<void(const Row &)> &visitor, Transaction *txn);
+
+  /**
+   * Visit one column of all tuples stored in a page. For pax pages only the minipage of the column is read.
+   * Char fields passed to visitor may not own their data, copy them if they are needed after the call.
+   * @param[in] page_id Page to scan
+   * @param[in] column_idx Column to read
+   * @param[in] visitor Called with rid and field for each live tuple in slot order
+   * @param[in] txn Transaction performing the read
+   * @return false if the page could not be fetched
+   */
+  bool ScanColumn(page_id_t page_id, uint32_t column_idx,
+                  const std::function<void(const RowId &, const Field &)> &visitor, Transaction *txn);
+
+  /**
+   * Append the tuples stored in one page to batch, values of the columns stored in the batch are detoasted.
+   * Whenever the batch becomes full visitor is called and the batch is reset after. Rows left in the batch
+   * on return are for the caller to consume, so that a batch can be filled from several pages.
+   * @param[in] page_id Page to scan
+   * @param[in/out] batch Batch to fill
+   * @param[in] visitor Called with each full batch
+   * @param[in] txn Transaction performing the read
+   * @return false if the page could not be fetched
+   */
+  bool ScanBatch(page_id_t page_id, RowBatch &batch, const std::function<void(RowBatch &)> &visitor,
+                 Transaction *txn);
+
+  /**
+   * Same as ScanBatch for the tuples of rids in the given order, eg: the result of an index scan.
+   * Rids of tuples which do not exist are skipped.
+   */
+  void FetchBatch(const std::vector<RowId> &rids, RowBatch &batch, const std::function<void(RowBatch &)> &visitor,
+                  Transaction *txn);
+
+  inline TableLayout GetLayout() const { return layout_; }
+
+  inline TableCompression GetCompression() const { return compression_; }
+
+  inline Schema *GetSchema() const { return schema_; }
+
+  /**
+   * @return dictionary of a dictionary encoded column, nullptr if values of the column are stored as they are
+   */
+  inline const Dictionary *GetDictionary(uint32_t column_idx) const { return dictionaries_[column_idx]; }
+
+  inline const std::vector<DictionaryColumn> &GetDictionaryColumns() const { return dictionary_columns_; }
+
   void RecreateQueue();
 
 private:
@@ -100,49 +223,174 @@ private:
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                     LogManager *log_manager, LockManager *lock_manager) :
+                     LogManager *log_manager, LockManager *lock_manager, TableLayout layout,
+                     const std::vector<uint32_t> &dictionary_columns, TableCompression compression) :
           buffer_pool_manager_(buffer_pool_manager),
           schema_(schema),
           log_manager_(log_manager),
-          lock_manager_(lock_manager) {
-     buffer_pool_manager_->NewPage(first_page_id_);
-     auto page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(first_page_id_));
-     page->Init(first_page_id_, INVALID_PAGE_ID, log_manager, txn);
+          lock_manager_(lock_manager),
+          layout_(layout),
+          compression_(compression),
+          may_toast_(layout == kLayoutNSM && HasWideColumn(schema)),
+          zone_map_(schema) {
+     std::vector<DictionaryColumn> dictionaries;
+     for (auto column_idx : dictionary_columns)
+       dictionaries.push_back(DictionaryColumn{column_idx, INVALID_PAGE_ID});
+     InitStorage(dictionaries);
+     auto page = buffer_pool_manager_->NewPage(first_page_id_);
+     InitPage(page, first_page_id_, INVALID_PAGE_ID, txn);
+     buffer_pool_manager_->UnpinPage(first_page_id_, true);
      last_page_id_ = first_page_id_;
-     max_free_page_.push(MaxHeapNode(first_page_id_, PAGE_SIZE));
+     page_ids_.push_back(first_page_id_);
+     max_free_page_.push(MaxHeapNode(first_page_id_, GetPageCapacity()));
   };
 
   /**
    * load existing table heap by first_page_id
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+                     LogManager *log_manager, LockManager *lock_manager, TableLayout layout,
+                     const std::vector<DictionaryColumn> &dictionaries, TableCompression compression)
           : buffer_pool_manager_(buffer_pool_manager),
             first_page_id_(first_page_id),
             schema_(schema),
             log_manager_(log_manager),
-            lock_manager_(lock_manager) {
-    auto page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(first_page_id_));
+            lock_manager_(lock_manager),
+            layout_(layout),
+            compression_(compression),
+            may_toast_(layout == kLayoutNSM && HasWideColumn(schema)),
+            zone_map_(schema) {
+    InitStorage(dictionaries);
+    auto page = buffer_pool_manager_->FetchPage(first_page_id_);
     while (true) {
-      auto size = PAGE_SIZE;
-      auto r_id = new RowId;
-      if (!page->GetFirstTupleRid(r_id)) {
-        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-        break;
-      }
-      while (page->GetNextTupleRid(*r_id, r_id)) {
-        size--;
+      ASSERT(page != nullptr, "Table page does not match its checksum.");
+      auto size = GetPageCapacity();
+      page_ids_.push_back(page->GetPageId());
+      if (compression_ != kCompressionNone)  // 以原样存储的页也要继续压缩
+        buffer_pool_manager_->SetCompressed(page->GetPageId());
+      RowId r_id;
+      if (GetFirstTupleRid(page, &r_id)) {
+        // 重建该页的 zone map，溢出页中的值不读出
+        do {
+          Row row(r_id);
+          GetTuple(page, &row, nullptr);
+          zone_map_.Insert(page->GetPageId(), row);
+          size--;
+        } while (GetNextTupleRid(page, r_id, &r_id));
       }
       if (size > 0)
         max_free_page_.push(MaxHeapNode(page->GetPageId(), size));
       buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-      if (page->GetNextPageId() == INVALID_PAGE_ID)
+      if (GetNextPageId(page) == INVALID_PAGE_ID)
         break;
-      page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page->GetNextPageId()));
+      page = buffer_pool_manager_->FetchPage(GetNextPageId(page));
     }
     last_page_id_ = page->GetPageId();
   }
 
+  /**
+   * Create or load the dictionaries, then derive the on-page schema and the pax layout from them.
+   * A dictionary whose first page is INVALID_PAGE_ID is created empty
+   */
+  void InitStorage(const std::vector<DictionaryColumn> &dictionaries);
+
+  /**
+   * @return max number of tuples stored in a page, used as the priority of free pages
+   */
+  size_t GetPageCapacity() const { return layout_ == kLayoutPAX ? pax_layout_->GetCapacity() : PAGE_SIZE; }
+
+  /**
+   * Page level operations, dispatched by the layout of this table. New pages of a compressed table are
+   * marked in InitPage
+   */
+  void InitPage(Page *page, page_id_t page_id, page_id_t prev_id, Transaction *txn);
+
+  page_id_t GetNextPageId(Page *page);
+
+  void SetNextPageId(Page *page, page_id_t next_page_id);
+
+  /**
+   * @param decode If false, values of dictionary encoded columns are left as codes
+   */
+  bool GetTuple(Page *page, Row *row, Transaction *txn, bool decode = true);
+
+  bool GetFirstTupleRid(Page *page, RowId *first_rid);
+
+  bool GetNextTupleRid(Page *page, const RowId &cur_rid, RowId *next_rid);
+
+  /**
+   * Insert stored, the on-page form of row, into a page. Zone map is maintained with the values of row
+   */
+  bool InsertStoredTuple(Row &stored, const Row &row, Transaction *txn);
+
+  /**
+   * Out-of-line storage of long char values.
+   * A value longer than TOAST_THRESHOLD is written to a chain of overflow pages, the tuple stores a
+   * ToastPointer instead. Chains are freed when the tuple is deleted or updated.
+   */
+  static bool HasWideColumn(Schema *schema) {
+    for (auto column : schema->GetColumns()) {
+      if (Type::IsCharType(column->GetType()) && column->GetLength() > TOAST_THRESHOLD)
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * @return true if the on-page form of row differs from row, see EncodeTuple
+   */
+  bool NeedEncode(const Row &row) const;
+
+  /**
+   * Copy fields of row into fields in their on-page form, values of dictionary encoded columns are replaced
+   * with their codes and long char values with pointers to overflow pages
+   * @return false if overflow or dictionary pages could not be allocated
+   */
+  bool EncodeTuple(const Row &row, std::vector<Field> &fields);
+
+  void DetoastRow(Row *row);
+
+  /**
+   * Replace the codes of dictionary encoded columns with their values
+   */
+  void DecodeRow(Row *row);
+
+  void DecodeField(uint32_t column_idx, Field *field);
+
+  /**
+   * Rewrite the dictionary into its page chain after a value is added
+   * @return false if overflow pages could not be allocated
+   */
+  bool SaveDictionary(const DictionaryColumn &column);
+
+  /**
+   * @return id of the first page of the chain, INVALID_PAGE_ID if pages could not be allocated
+   */
+  page_id_t WriteOverflow(const char *data, uint32_t len);
+
+  void FreeOverflow(page_id_t page_id);
+
+  /**
+   * Free overflow pages referenced by toasted fields of row
+   */
+  void FreeToast(const Row &row);
+
+  /**
+   * Find the first live tuple after cur_rid in this table, following the page chain
+   * @param[in] cur_rid Current tuple, INVALID_ROWID to find the first tuple of this table
+   * @return false if there are no more tuples
+   */
+  bool GetNextRowId(const RowId &cur_rid, RowId *next_rid);
+
+  bool ReadTuple(Row *row, Transaction *txn, bool decode);
+
+  bool ScanPage(page_id_t page_id, const std::function<void(const Row &)> &visitor, Transaction *txn, bool decode);
+
+  /**
+   * Values of dictionary encoded columns in batch are stored as codes
+   */
+  void BindDictionaries(RowBatch &batch) const;
+
 private:
   struct MaxHeapNode {
     MaxHeapNode(page_id_t page_id, size_t size) : size_(size), page_id_(page_id) {}
@@ -156,9 +404,18 @@ private:
   page_id_t first_page_id_;
   page_id_t last_page_id_;
   Schema *schema_;
+  Schema *stored_schema_;  /** schema of tuples on page, dictionary encoded columns are int codes */
   priority_queue<MaxHeapNode> max_free_page_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  TableLayout layout_;
+  TableCompression compression_;
+  PaxLayout *pax_layout_{nullptr};
+  bool may_toast_;    /** some column of this table may be stored out of line */
+  std::vector<page_id_t> page_ids_;
+  ZoneMap zone_map_;
+  std::vector<DictionaryColumn> dictionary_columns_;
+  std::vector<Dictionary *> dictionaries_;  /** dictionary of each column, nullptr if the column is not encoded */
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
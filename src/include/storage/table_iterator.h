@@ -15,6 +15,11 @@ public:
   explicit TableIterator();
   
   explicit TableIterator(const Row* r, const TableHeap *th);
+
+  /**
+   * Iterator positioned at rid, the tuple is read from table heap
+   */
+  explicit TableIterator(RowId rid, TableHeap *th, Transaction *txn);
   
   TableIterator(const TableIterator &other);
 
@@ -33,9 +38,15 @@ public:
   TableIterator operator++(int);
 
 private:
+  /**
+   * Destruct the current row and reclaim its memory
+   */
+  void ReleaseRow();
+
   // add your own private member variables here
   Row* ptr;   //指向当前这一行
   TableHeap* table_heap_;  //指向当前的table_heap_
+  ArenaMemHeap arena_;  //当前行及其 field 的内存，每次移动时复用
 };
 
 #endif //MINISQL_TABLE_ITERATOR_H
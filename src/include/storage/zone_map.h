@@ -0,0 +1,85 @@
+#ifndef MINISQL_ZONE_MAP_H
+#define MINISQL_ZONE_MAP_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Page-level zone map of a table heap.
+ *
+ * For every page of the heap and every column, keep the min/max of the non-null
+ * values seen on that page plus the null count, so that scans with a predicate on
+ * the column can skip pages which cannot contain any matching tuple.
+ *
+ * The summaries are conservative: inserts and updates widen the bounds, deletes only
+ * adjust the counters (bounds are not shrunk), and a page which becomes empty is reset.
+ * A toasted value leaves the column of its page unbounded, so that overflow pages are
+ * never read to maintain the summaries.
+ * Zone maps live in memory only and are rebuilt when the table heap is loaded.
+ */
+class ZoneMap {
+public:
+  explicit ZoneMap(Schema *schema) : schema_(schema) {}
+
+  ~ZoneMap();
+
+  ZoneMap(const ZoneMap &other) = delete;
+
+  ZoneMap &operator=(const ZoneMap &other) = delete;
+
+  /**
+   * Account a tuple stored in the page, widen min/max of each column. Toasted fields are not
+   * compared, the column of the page can no longer be pruned by value
+   */
+  void Insert(page_id_t page_id, const Row &row);
+
+  /**
+   * Account a tuple removed from the page, min/max are kept as they are
+   */
+  void Remove(page_id_t page_id, const Row &row);
+
+  /**
+   * Forget everything about the page, eg: page is deleted
+   */
+  void Erase(page_id_t page_id);
+
+  void Clear();
+
+  /**
+   * Check whether tuples in the page may satisfy `column <op> value`
+   * @param op one of =, <>, <, <=, >, >=, is (is null), not (is not null)
+   * @return false only if no tuple in the page can match
+   */
+  bool MayMatch(page_id_t page_id, uint32_t column_idx, const char *op, const Field &value) const;
+
+  /**
+   * @return tuple count of the page recorded in zone map
+   */
+  uint32_t GetRowCount(page_id_t page_id) const;
+
+private:
+  struct ColumnZone {
+    Field *min_{nullptr};
+    Field *max_{nullptr};
+    uint32_t null_count_{0};
+    bool unbounded_{false};  /** some value is toasted, min/max do not cover it */
+  };
+
+  struct PageZone {
+    uint32_t row_count_{0};
+    std::vector<ColumnZone> columns_;
+  };
+
+  static void ResetZone(PageZone &zone);
+
+  static void SetBound(Field *&bound, const Field &value);
+
+  Schema *schema_;
+  std::unordered_map<page_id_t, PageZone> zones_;
+};
+
+#endif  // MINISQL_ZONE_MAP_H
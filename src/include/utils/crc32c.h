@@ -0,0 +1,25 @@
+#ifndef MINISQL_CRC32C_H
+#define MINISQL_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * CRC-32C (Castagnoli) checksums of pages.
+ *
+ * Computed with the SSE4.2 crc32 instruction when the cpu supports it, otherwise with a lookup table.
+ * Both give the same result, eg: Compute("123456789") = 0xE3069283.
+ */
+class Crc32c {
+public:
+  static uint32_t Compute(const char *data, size_t len);
+
+  /**
+   * Table based implementation, used when SSE4.2 is not available
+   */
+  static uint32_t ComputeSoftware(const char *data, size_t len);
+
+  static bool UseSse42();
+};
+
+#endif  // MINISQL_CRC32C_H
@@ -1,9 +1,11 @@
 #ifndef MINISQL_MEM_HEAP_H
 #define MINISQL_MEM_HEAP_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <unordered_set>
+#include <vector>
 #include "common/macros.h"
 
 class MemHeap {
@@ -54,4 +56,91 @@ private:
   std::unordered_set<void *> allocated_;
 };
 
+/**
+ * Bump pointer allocator.
+ *
+ * Memory is carved from chunks of chunk_size bytes (larger requests get a chunk of their own), there is
+ * no per-object bookkeeping: Free does nothing, all memory is released at once by Reset or on destruction.
+ * Objects placed in the arena are not destructed by it, owners must call their destructors.
+ *
+ * A caller may provide the first chunk, eg: a buffer on the stack, so that small workloads never
+ * touch the global allocator.
+ */
+class ArenaMemHeap : public MemHeap {
+public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+
+  explicit ArenaMemHeap(size_t chunk_size = DEFAULT_CHUNK_SIZE) : chunk_size_(chunk_size) {}
+
+  ArenaMemHeap(char *buf, size_t size, size_t chunk_size = DEFAULT_CHUNK_SIZE)
+      : chunk_size_(chunk_size), inline_buf_(buf), inline_size_(size), cur_(buf), end_(buf + size) {}
+
+  ~ArenaMemHeap() override {
+    for (auto chunk : chunks_) {
+      free(chunk);
+    }
+  }
+
+  ArenaMemHeap(const ArenaMemHeap &other) = delete;
+
+  ArenaMemHeap &operator=(const ArenaMemHeap &other) = delete;
+
+  void *Allocate(size_t size) override {
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (cur_ == nullptr || static_cast<size_t>(end_ - cur_) < size) {
+      NewChunk(size);
+    }
+    void *buf = cur_;
+    cur_ += size;
+    return buf;
+  }
+
+  void Free(void *ptr) override {}
+
+  /**
+   * Release all allocated memory. The first chunk is kept for reuse, so an arena reset per
+   * row or per operator allocates from the global allocator only when it grows.
+   */
+  void Reset() {
+    if (inline_buf_ != nullptr) {
+      for (auto chunk : chunks_) {
+        free(chunk);
+      }
+      chunks_.clear();
+      cur_ = inline_buf_;
+      end_ = inline_buf_ + inline_size_;
+    } else if (!chunks_.empty()) {
+      for (size_t i = 1; i < chunks_.size(); i++) {
+        free(chunks_[i]);
+      }
+      chunks_.resize(1);
+      cur_ = chunks_[0];
+      end_ = chunks_[0] + first_chunk_size_;
+    }
+  }
+
+private:
+  void NewChunk(size_t size) {
+    size_t chunk_size = size > chunk_size_ ? size : chunk_size_;
+    char *chunk = reinterpret_cast<char *>(malloc(chunk_size));
+    ASSERT(chunk != nullptr, "Out of memory exception");
+    if (chunks_.empty()) {
+      first_chunk_size_ = chunk_size;
+    }
+    chunks_.push_back(chunk);
+    cur_ = chunk;
+    end_ = chunk + chunk_size;
+  }
+
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  size_t chunk_size_;
+  size_t first_chunk_size_{0};
+  char *inline_buf_{nullptr};
+  size_t inline_size_{0};
+  char *cur_{nullptr};
+  char *end_{nullptr};
+  std::vector<char *> chunks_;
+};
+
 #endif //MINISQL_MEM_HEAP_H
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include "glog/logging.h"
 #include "index/b_plus_tree.h"
@@ -14,24 +15,29 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
           leaf_max_size_(leaf_max_size),
           internal_max_size_(internal_max_size) {
   auto header_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
-  header_page->GetRootId(index_id_, &root_page_id_);
+  page_id_t root_id = INVALID_PAGE_ID;
+  header_page->GetRootId(index_id_, &root_id);
+  root_page_id_ = root_id;
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
-  if (root_page_id_ != INVALID_PAGE_ID) {
-    auto root = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-    auto leaf = reinterpret_cast<LeafPage *>(FindLeafPage(root->KeyAt(0), true));
+  if (root_id != INVALID_PAGE_ID) {
+    uint64_t version;
+    Page *leaf = FindLeafPage(KeyType{}, version, true);
     last_page_id_ = leaf->GetPageId();
-    buffer_pool_manager_->UnpinPage(root_page_id_, false);
     buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
   }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Destroy() {
+  root_latch_.WLock();
   auto header_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
   header_page->Delete(index_id_);
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
-  if (root_page_id_ == INVALID_PAGE_ID)
+  last_page_id_ = INVALID_PAGE_ID;
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
     return;
+  }
   // dfs
   list<page_id_t> stack;
   stack.emplace_back(root_page_id_);
@@ -52,6 +58,13 @@ void BPLUSTREE_TYPE::Destroy() {
     buffer_pool_manager_->UnpinPage(page, false);
     buffer_pool_manager_->DeletePage(page);
   }
+  {
+    std::lock_guard<std::mutex> guard(deleted_latch_);
+    for (auto page_id : deleted_pages_)
+      buffer_pool_manager_->DeletePage(page_id);
+    deleted_pages_.clear();
+  }
+  root_latch_.WUnlock();
 }
 
 /*
@@ -59,8 +72,7 @@ void BPLUSTREE_TYPE::Destroy() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::IsEmpty() const {
-  if(root_page_id_  == INVALID_PAGE_ID) return true;
-  return false;
+  return root_page_id_ == INVALID_PAGE_ID;
 }
 
 /*****************************************************************************
@@ -69,25 +81,33 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
 /*
  * Return the only value that associated with input key
  * This method is used for point query 点查询
+ * If leaf is not null, it is a leaf latched by the caller, otherwise the leaf
+ * is read optimistically and read again if its version has changed
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result, LeafPage* leaf, int& index, Transaction *transaction) {
-  if(this->IsEmpty()) return false; //空树
-  if (!leaf)
-    leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key, false));
-  //找到了
   ValueType value;
-  if(leaf->Lookup(key, value, comparator_, index))
-  {
-    //这里有点疑惑？为什么传的是vector型而不是直接是ValueType...
-    //先直接push_back吧
-    result.push_back(value);
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-    return true;
+  if (leaf) {
+    bool found = leaf->Lookup(key, value, comparator_, index);
+    if (found)
+      result.push_back(value);
+    return found;
+  }
+  while (true) {
+    uint64_t version;
+    Page *page = FindLeafPage(key, version);
+    if (!page) return false; //空树
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    bool found = leaf->Lookup(key, value, comparator_, index);
+    bool valid = page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (valid) {
+      if (found)
+        result.push_back(value);
+      return found;
+    }
   }
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-  return false;
 }
 
 
@@ -103,14 +123,17 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  //判断是否为空树
-  if(IsEmpty())
-  {
+  LatchContext context;
+  //空树时仍持有 root_latch_
+  if (!FindLeafPage(key, false, TreeOperation::kInsert, &context)) {
     StartNewTree(key, value);
+    ReleaseAll(context);
     return true;
   }
   //调用函数进行插入
-  return InsertIntoLeaf(key, value, transaction);
+  bool inserted = InsertIntoLeaf(key, value, context);
+  ReleaseAll(context);
+  return inserted;
 }
 
 /*
@@ -118,6 +141,7 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * The caller holds root_latch_, the new root is published once it is filled.
  */
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -129,49 +153,172 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   {
     auto *leaf = reinterpret_cast<LeafPage *>(root->GetData());
     leaf->Init(root_id, INVALID_PAGE_ID, leaf_max_size_);
-    //更新head_page_table
-    root_page_id_ = root_id;
-    last_page_id_ = root_page_id_;
-    UpdateRootPageId(true);
     int index = -1;
     //向叶子中插入键值对
     leaf->Insert(key, value, comparator_, index);
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    //更新head_page_table
+    root_page_id_ = root_id;
+    last_page_id_ = root_id;
+    UpdateRootPageId(true);
+    buffer_pool_manager_->UnpinPage(root_id, true);
   }
 }
 
 /*
- * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
+ * Insert constant key & value pair into the leaf page latched last by context
+ * Look through leaf page to see whether insert key exist or not. If exist,
+ * return immediately, otherwise insert entry. Remember to deal with split if
+ * necessary, the ancestors which may change are still latched by context.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  std::vector<ValueType> result;
+bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, LatchContext &context) {
+  auto leaf = reinterpret_cast<LeafPage *>(context.pages_.back()->GetData());
   //已经存在
-  auto leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key, false)->GetData());
+  ValueType old_value;
   int index = 0;
-  if(GetValue(key, result, leaf, index, transaction)) {
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  if (leaf->Lookup(key, old_value, comparator_, index))
     return false;
+  if (!leaf->Insert(key, value, comparator_, index)) {
+    // 变长的 key 放不下，先分裂再插入 key 所在的一半
+    LeafPage *new_leaf = Split(leaf, context, &key);
+    LeafPage *target =
+        new_leaf->GetSize() == 0 || comparator_(key, new_leaf->KeyAt(0)) >= 0 ? new_leaf : leaf;
+    index = -1;
+    bool inserted = target->Insert(key, value, comparator_, index);
+    ASSERT(inserted, "Key does not fit into the split leaf page.");
+    last_page_id_ = target->GetPageId();
+    InsertIntoParent(leaf, LeafPage::Separator(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0)), new_leaf,
+                     context);
+    return true;
   }
-  //fetch the page
-//  LeafPage * leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key, false)->GetData());
-  leaf->Insert(key, value, comparator_, index);
   last_page_id_ = leaf->GetPageId();
-  //存疑
   //超出最大限制
   if(leaf->GetSize() > leaf->GetMaxSize())
   {
-    LeafPage *new_leaf = Split(leaf);
+    LeafPage *new_leaf = Split(leaf, context);
     last_page_id_ = new_leaf->GetPageId();
-    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
-    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+    InsertIntoParent(leaf, LeafPage::Separator(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0)), new_leaf,
+                     context);
   }
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  return true;
+}
+
+/*
+ * Build an empty tree from count key & value pairs in ascending key order
+ * For keys of fixed length the number of pages of every level is planned
+ * first, so that the items of a level are spread evenly over its pages and
+ * every page is about fill_factor full. Keys of variable length fill every
+ * page up to fill_factor of its bytes instead. Pages are then filled left to
+ * right, a page of each level is kept open, a level gets its parent once it
+ * has a second page and a parent is opened whenever its children no longer
+ * fit, so pages are allocated in sequence and every page is written once.
+ * @return: false if the tree is not empty, or a page cannot be allocated, in
+ * which case the pages of the partial tree are freed and the tree stays empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(size_t count, const std::function<bool(MappingType &)> &next, double fill_factor) {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID || count == 0) {
+    root_latch_.WUnlock();
+    return root_page_id_ == INVALID_PAGE_ID;
+  }
+  constexpr bool variable = LeafPage::kVariableLength;
+  // 定长的 key 每一层的条目数和页数，第 0 层是叶子，内部页的条目是孩子
+  size_t leaf_fill = std::max<size_t>(1, std::min<size_t>(leaf_max_size_, leaf_max_size_ * fill_factor));
+  size_t internal_fill = std::max<size_t>(2, std::min<size_t>(internal_max_size_, internal_max_size_ * fill_factor));
+  std::vector<size_t> items{count};
+  std::vector<size_t> pages{(count + leaf_fill - 1) / leaf_fill};
+  while (pages.back() > 1) {
+    items.push_back(pages.back());
+    pages.push_back((items.back() + internal_fill - 1) / internal_fill);
+  }
+  std::vector<BPlusTreePage *> open;
+  std::vector<size_t> opened;
+  std::vector<int> capacity;
+  std::vector<page_id_t> allocated;
+  // level 层的页放不下 key 时打开下一页
+  auto full = [&](size_t level, const KeyType &key) {
+    if (variable) {
+      return level == 0 ? !reinterpret_cast<LeafPage *>(open[level])->CanAppend(key, fill_factor)
+                        : !reinterpret_cast<InternalPage *>(open[level])->CanAppend(key, fill_factor);
+    }
+    return open[level]->GetSize() == capacity[level];
+  };
+  auto append_child = [&](size_t level, const KeyType &key, BPlusTreePage *child) {
+    bool appended = reinterpret_cast<InternalPage *>(open[level])->Append(key, child->GetPageId());
+    ASSERT(appended, "Child does not fit into the internal page.");
+    child->SetParentPageId(open[level]->GetPageId());
+  };
+  // 打开 level 层的下一页，first_key 是它在父结点中的 key，缓冲池中没有空闲的帧时返回 false
+  std::function<bool(size_t, const KeyType &)> open_page = [&](size_t level, const KeyType &first_key) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(page_id);
+    if (!page)
+      return false;
+    allocated.push_back(page_id);
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (level == 0)
+      reinterpret_cast<LeafPage *>(node)->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+    else
+      reinterpret_cast<InternalPage *>(node)->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    if (level == open.size()) {
+      open.push_back(nullptr);
+      opened.push_back(0);
+      capacity.push_back(0);
+    }
+    if (open[level]) {
+      // 第二页打开时才有父结点，最左边的孩子的 key 为空
+      if (level + 1 == open.size()) {
+        if (!open_page(level + 1, KeyType{}))
+          return false;
+        append_child(level + 1, KeyType{}, open[level]);
+      }
+      if (full(level + 1, first_key) && !open_page(level + 1, first_key))
+        return false;
+      append_child(level + 1, first_key, node);
+      if (level == 0) {
+        reinterpret_cast<LeafPage *>(open[level])->SetNextPageId(page_id);
+        reinterpret_cast<LeafPage *>(node)->SetPrevPageId(open[level]->GetPageId());
+      }
+      buffer_pool_manager_->UnpinPage(open[level]->GetPageId(), true);
+    }
+    open[level] = node;
+    if (!variable)
+      capacity[level] = static_cast<int>(items[level] / pages[level] + (opened[level] < items[level] % pages[level]));
+    opened[level]++;
+    return true;
+  };
+  MappingType item, last;
+  for (size_t i = 0; i < count; i++) {
+    bool has_next = next(item);
+    ASSERT(has_next, "Fewer pairs than count for bulk loading.");
+    bool opened_page = true;
+    if (open.empty())
+      opened_page = open_page(0, item.first);
+    else if (full(0, item.first))
+      opened_page = open_page(0, LeafPage::Separator(last.first, item.first));
+    if (!opened_page) {
+      // 建到一半的页还不属于这棵树，解除固定后全部释放
+      for (auto page_id : allocated) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        buffer_pool_manager_->DeletePage(page_id);
+      }
+      root_latch_.WUnlock();
+      return false;
+    }
+    bool appended = reinterpret_cast<LeafPage *>(open[0])->Append(item.first, item.second);
+    ASSERT(appended, "Pair does not fit into the leaf page.");
+    last = item;
+  }
+  // 新树在释放 root_latch_ 之前不会被写者修改，最后一个叶子不会被其它线程删除
+  last_page_id_ = open[0]->GetPageId();
+  root_page_id_ = open.back()->GetPageId();
+  for (auto node : open)
+    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+  UpdateRootPageId(true);
+  root_latch_.WUnlock();
   return true;
 }
 
@@ -181,14 +328,19 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * If key is not null, it did not fit into the input page and is inserted by
+ * the caller into the half it belongs to afterwards.
+ * The new page is write latched and released with context.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
+N *BPLUSTREE_TYPE::Split(N *node, LatchContext &context, const KeyType *key) {
   page_id_t new_page_id;
   Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
   if(!new_page)
     throw std::bad_alloc();
+  new_page->WLatch();
+  context.pages_.push_back(new_page);
   //是叶子
   if(node->IsLeafPage())
   {
@@ -197,12 +349,12 @@ N *BPLUSTREE_TYPE::Split(N *node) {
     LeafPage * new_leaf_page = reinterpret_cast<LeafPage *>(new_page->GetData());
     new_leaf_page->Init(new_page_id, old_leaf_page->GetParentPageId(), leaf_max_size_);
     //转移一半
-    old_leaf_page->MoveHalfTo(new_leaf_page);
+    old_leaf_page->MoveHalfTo(new_leaf_page, key, comparator_);
     //指针横向链接
     new_leaf_page->SetNextPageId(old_leaf_page->GetNextPageId());
+    new_leaf_page->SetPrevPageId(old_leaf_page->GetPageId());
     old_leaf_page->SetNextPageId(new_page_id);
-    buffer_pool_manager_->UnpinPage(new_page_id, true);
-    buffer_pool_manager_->UnpinPage(old_leaf_page->GetPageId(), true);
+    SetPrevPageId(new_leaf_page->GetNextPageId(), new_page_id);
     return reinterpret_cast<N *>(new_leaf_page);
   }
   else
@@ -211,11 +363,31 @@ N *BPLUSTREE_TYPE::Split(N *node) {
     InternalPage *old_internal_page = reinterpret_cast<InternalPage *>(node);
     new_internal_page->Init(new_page_id, old_internal_page->GetParentPageId(), internal_max_size_);
     //MoveHalfTo这个函数应该是要转移节点中的父节点指向的~
-    old_internal_page->MoveHalfTo(new_internal_page, buffer_pool_manager_);
+    old_internal_page->MoveHalfTo(new_internal_page, buffer_pool_manager_, key);
     return reinterpret_cast<N *>(new_internal_page);
   }
 }
 
+/*
+ * Point the prev link of leaf page_id to prev_page_id after the leaf on its
+ * left is split or merged, nothing to do if page_id is invalid
+ * The caller holds the write latch of the left leaves, leaves are still
+ * latched from left to right. Readers moving to the left validate the leaf
+ * they come from, so they notice the change of its version.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetPrevPageId(page_id_t page_id, page_id_t prev_page_id) {
+  if (page_id == INVALID_PAGE_ID)
+    return;
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (!page)
+    throw std::bad_alloc();
+  page->WLatch();
+  reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(prev_page_id);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
 /*
  * Insert key & value pair into internal page after split
  * @param   old_node      input page from split() method
@@ -224,47 +396,55 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent is not safe for insert, so it is still latched by context.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {
+                                      LatchContext &context) {
   //如果是根节点
   if (old_node->IsRootPage()) {
-    // 创建新的根节点要更新root_page_id_和header_page
-    //更新新的root_page_id
-    Page *new_page = buffer_pool_manager_->NewPage(root_page_id_);
-    //更新header_page
-    //是更新不是插入！！！只有新建树的时候是true
-    UpdateRootPageId(false);
+    // 创建新的根节点要更新root_page_id_和header_page，此时仍持有root_latch_
+    page_id_t root_id;
+    Page *new_page = buffer_pool_manager_->NewPage(root_id);
     //新建一个根internal page
     InternalPage *new_root = reinterpret_cast<InternalPage *>(new_page->GetData());
-    new_root->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
+    new_root->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
     //赋值
     new_root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
     //更新父节点
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
+    old_node->SetParentPageId(root_id);
+    new_node->SetParentPageId(root_id);
+    // 无锁的读者不持有 root_latch_，新的根填好之后才能更新root_page_id
+    root_page_id_ = root_id;
+    //更新header_page
+    //是更新不是插入！！！只有新建树的时候是true
+    UpdateRootPageId(false);
     //标记is dirty
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    buffer_pool_manager_->UnpinPage(root_id, true);
   } else {
     //不是root
     page_id_t parent_page_id = old_node->GetParentPageId();
     //获取父节点
-    InternalPage *parent_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+    InternalPage *parent_page = reinterpret_cast<InternalPage *>(GetLatchedPage(context, parent_page_id)->GetData());
     //插入new node
-    parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    if (!parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId())) {
+      // 变长的 key 放不下，先分裂父节点再插入 old_node 所在的一半
+      InternalPage *parent_page_2 = Split(parent_page, context, &key);
+      InternalPage *target = parent_page_2->ValueIndex(old_node->GetPageId()) >= 0 ? parent_page_2 : parent_page;
+      bool inserted = target->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+      ASSERT(inserted, "Key does not fit into the split internal page.");
+      new_node->SetParentPageId(target->GetPageId());
+      InsertIntoParent(parent_page, parent_page_2->KeyAt(0), parent_page_2, context);
+      return;
+    }
     new_node->SetParentPageId(parent_page_id);
     // 父节点到达max_size+1需要进行分裂
     if (parent_page->GetSize() > parent_page->GetMaxSize()) {
       //父节点进行分裂
-      InternalPage *parent_page_2 = Split(parent_page);
+      InternalPage *parent_page_2 = Split(parent_page, context);
       //递归向上连接
-      InsertIntoParent(parent_page, parent_page_2->KeyAt(0), parent_page_2);
-      //连接结束之后unpin page
-      buffer_pool_manager_->UnpinPage(parent_page_2->GetPageId(), true);
+      InsertIntoParent(parent_page, parent_page_2->KeyAt(0), parent_page_2, context);
     }
-    //unpin page 标记is dirty
-    buffer_pool_manager_->UnpinPage(parent_page_id, true);
   }
 }
 
@@ -277,56 +457,51 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * Keys of the parents are left unchanged when the first key of a leaf is
+ * deleted, they are still lower bounds of their subtrees.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-    if (IsEmpty()) return;
-    //查找该键值对所在的位置
-    LeafPage *leaf_page = reinterpret_cast<LeafPage *>(FindLeafPage(key, false)->GetData());
-    //如果是该value处于最左侧的位置，需要对于上层所有的key进行更新
-    if (leaf_page->KeyIndex(key, comparator_) == 0 && leaf_page->GetParentPageId() != INVALID_PAGE_ID) {
-        auto tmp_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(leaf_page->GetParentPageId())->GetData());
-        auto index = tmp_page->ValueIndex(leaf_page->GetPageId());
-        //对于上层的key进行更新
-        tmp_page->SetKeyAt(index, leaf_page->KeyAt(1));
-        buffer_pool_manager_->UnpinPage(leaf_page->GetParentPageId(), true);
-        auto page_id = leaf_page->GetPageId();
-        //运用循环向根部遍历
-        while (tmp_page->ValueIndex(page_id) == 0 && tmp_page->GetParentPageId() != INVALID_PAGE_ID) {
-            auto node = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(tmp_page->GetParentPageId())->GetData());
-            index = node->ValueIndex(tmp_page->GetPageId());
-            //继续对于上层的key进行更新
-            node->SetKeyAt(index, tmp_page->KeyAt(0));
-            page_id = tmp_page->GetPageId();
-            tmp_page = node;
-        }
-    }
-    //删除记录
-    leaf_page->RemoveAndDeleteRecord(key, comparator_);
-    //过少则合并
-    if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
-        CoalesceOrRedistribute(leaf_page, transaction);
-    }
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+  LatchContext context;
+  //查找该键值对所在的位置
+  if (!FindLeafPage(key, false, TreeOperation::kRemove, &context)) {
+    ReleaseAll(context);
+    return;
+  }
+  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(context.pages_.back()->GetData());
+  //删除记录
+  leaf_page->RemoveAndDeleteRecord(key, comparator_);
+  //过少则合并
+  if (leaf_page->IsUnderflow()) {
+    CoalesceOrRedistribute(leaf_page, context);
+  }
+  ReleaseAll(context);
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
+ * Pages of keys with variable length merge if all their bytes fit into one
+ * page, they may be left underflowed if neither fits.
  * Using template N to represent either internal page or leaf page.
+ * The parent is not safe for remove, so it is still latched by context, the
+ * sibling is latched here.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 //node 中的节点不满足要求，需要与相邻节点合并
 INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, LatchContext &context) {
   //是根：无需合并or调整
   if (node->IsRootPage())
-    return AdjustRoot(node);
+    return AdjustRoot(node, context);
   //get the parent
   InternalPage * parent = reinterpret_cast<InternalPage *>
-      (buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData()); //need to unpin
+      (GetLatchedPage(context, node->GetParentPageId())->GetData());
+  // 变长的 key 放不下时父节点可能只剩一个孩子
+  if (parent->GetSize() < 2)
+    return false;
   int this_index = parent->ValueIndex(node->GetPageId());
   page_id_t sibling_id;
   N* sibling;
@@ -336,9 +511,31 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   else
     sibling_id = parent->ValueAt(this_index - 1); // the left sibling
   //get the sibling and pin it
-  sibling = reinterpret_cast<N*>(buffer_pool_manager_->FetchPage(sibling_id)->GetData()); // need to unpin
+  Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_id);
+  if (node->IsLeafPage() && this_index) {
+    // 叶子只能从左向右加锁，先放开 node 再依次锁上左兄弟和 node
+    // 期间 node 只可能被快速路径插入，重新加锁后不再过少就无需调整
+    Page *node_page = GetLatchedPage(context, node->GetPageId());
+    node_page->WUnlatch();
+    sibling_page->WLatch();
+    node_page->WLatch();
+    if (!node->IsUnderflow()) {
+      sibling_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(sibling_id, false);
+      return false;
+    }
+  } else {
+    sibling_page->WLatch();
+  }
+  context.pages_.push_back(sibling_page);
+  sibling = reinterpret_cast<N*>(sibling_page->GetData());
   //merge
-  if (node->GetSize() + sibling->GetSize() <= node->GetMaxSize()) {
+  N *left = this_index ? sibling : node;
+  N *right = this_index ? node : sibling;
+  bool merge = left->IsLeafPage() ? reinterpret_cast<LeafPage *>(right)->CanMoveAllTo(reinterpret_cast<LeafPage *>(left))
+                                  : reinterpret_cast<InternalPage *>(right)->CanMoveAllTo(
+                                        reinterpret_cast<InternalPage *>(left), parent->KeyAt(this_index ? this_index : 1));
+  if (merge) {
     // 将右边节点合并到左边节点上
     //默认node是右边节点
     if (!this_index) { //交换
@@ -349,19 +546,14 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     // index是右边节点所在的index
     int index = parent->ValueIndex(node->GetPageId());
     //进行合并
-    Coalesce(&sibling, &node, &parent, index, transaction);
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+    Coalesce(&sibling, &node, &parent, index, context);
     return true;
   }
   // index为underflow的节点在父节点中的index
   //node : 需要
   int index = parent->ValueIndex(node->GetPageId());
   //重新分配
-  Redistribute(sibling, node, index);
-  //unpin
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
-  buffer_pool_manager_->UnpinPage(sibling->GetPageId(), true);
+  Redistribute(sibling, node, index, context);
   return false;
 }
 
@@ -383,24 +575,27 @@ INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) {
+                              LatchContext &context) {
   if ((*node)->IsLeafPage()) {
     LeafPage *this_node = reinterpret_cast<LeafPage *>(*node);
     LeafPage *neighbor = reinterpret_cast<LeafPage *>(*neighbor_node);
     this_node->MoveAllTo(neighbor);
     neighbor->SetNextPageId(this_node->GetNextPageId());
+    SetPrevPageId(neighbor->GetNextPageId(), neighbor->GetPageId());
+    // 删除前把指向该叶子的 last_page_id_ 移到合并后的叶子
+    page_id_t expected = this_node->GetPageId();
+    last_page_id_.compare_exchange_strong(expected, neighbor->GetPageId());
   } else {
     InternalPage *this_node = reinterpret_cast<InternalPage *>(*node);
     InternalPage *neighbor = reinterpret_cast<InternalPage *>(*neighbor_node);
     this_node->MoveAllTo(neighbor, (*parent)->KeyAt(index), buffer_pool_manager_);
   }
-  //delete **node
-  buffer_pool_manager_->UnpinPage((*node)->GetPageId(),true);
-  buffer_pool_manager_->DeletePage((*node)->GetPageId());
+  //delete **node，释放所有锁之后再删除
+  context.deleted_.push_back((*node)->GetPageId());
   (*parent)->Remove(index);
   //continue
-  if ((*parent)->GetSize() < (*parent)->GetMinSize()) {
-    return CoalesceOrRedistribute((*parent), transaction);
+  if ((*parent)->IsUnderflow()) {
+    return CoalesceOrRedistribute((*parent), context);
   }
   //end : successfully delete
   return true;
@@ -412,16 +607,19 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  * otherwise move sibling page's last key & value pair into head of input
  * "node".
  * Using template N to represent either internal page or leaf page.
+ * Nothing is moved if the pair or the new key in the parent does not fit.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  */
 //不能传page类型...传了就寄
 INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, LatchContext &context) {
   //find parent node
   InternalPage *parent =
-      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
+      reinterpret_cast<InternalPage *>(GetLatchedPage(context, node->GetParentPageId())->GetData());
+  if (neighbor_node->GetSize() < 2)
+    return;
   //node - neighbor_node - ...
   if (index == 0) {
     // 右边节点在父节点中对应的index
@@ -432,15 +630,20 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
       //type converse
       LeafPage *neighbor = reinterpret_cast<LeafPage *>(neighbor_node);
       LeafPage *this_node = reinterpret_cast<LeafPage *>(node);
+      KeyType key = LeafPage::Separator(neighbor->KeyAt(0), neighbor->KeyAt(1));
+      if (!this_node->CanInsert(neighbor->KeyAt(0)) || !parent->CanSetKeyAt(index, key))
+        return;
       //remove
       neighbor->MoveFirstToEndOf(this_node);
       //update parent key
-      parent->SetKeyAt(index, neighbor->KeyAt(0));
+      parent->SetKeyAt(index, key);
     }
     //internal page
     else {
       InternalPage *neighbor = reinterpret_cast<InternalPage *>(neighbor_node);
       InternalPage *this_node = reinterpret_cast<InternalPage *>(node);
+      if (!this_node->CanInsert(parent->KeyAt(index)) || !parent->CanSetKeyAt(index, neighbor->KeyAt(1)))
+        return;
       neighbor->MoveFirstToEndOf(this_node, parent->KeyAt(index), buffer_pool_manager_);
     }
   }
@@ -449,15 +652,21 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
     if (neighbor_node->IsLeafPage()) {
       LeafPage *neighbor = reinterpret_cast<LeafPage *>(neighbor_node);
       LeafPage *this_node = reinterpret_cast<LeafPage *>(node);
+      int last = neighbor->GetSize() - 1;
+      KeyType key = LeafPage::Separator(neighbor->KeyAt(last - 1), neighbor->KeyAt(last));
+      if (!this_node->CanInsert(neighbor->KeyAt(last)) || !parent->CanSetKeyAt(index, key))
+        return;
       neighbor->MoveLastToFrontOf(this_node);
-      parent->SetKeyAt(index, this_node->KeyAt(0));
+      parent->SetKeyAt(index, key);
     } else {
       InternalPage *neighbor = reinterpret_cast<InternalPage *>(neighbor_node);
       InternalPage *this_node = reinterpret_cast<InternalPage *>(node);
+      KeyType key = neighbor->KeyAt(neighbor->GetSize() - 1);
+      if (!this_node->CanInsert(key) || !parent->CanSetKeyAt(index, key))
+        return;
       neighbor->MoveLastToFrontOf(this_node, parent->KeyAt(index), buffer_pool_manager_);
     }
   }
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 
 /*
@@ -467,34 +676,33 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
  * case 1: when you delete the last element in root page, but root page still
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
+ * The root is not safe for remove in both cases, so root_latch_ is still held.
  * @return : true means root page should be deleted, false means no deletion
  * happened
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node, LatchContext &context) {
   // case 1: 删除元素，此时的根节点只有1个child， 需要释放根节点
   if (old_root_node->GetSize() == 1 && !old_root_node->IsLeafPage()) {
     InternalPage *root_page = reinterpret_cast<InternalPage *>(old_root_node);
     page_id_t new_root_id = root_page->RemoveAndReturnOnlyChild();
-    // 获取新的根
+    // 新的根是 context 中已加锁的孩子
     InternalPage *new_root_page =
-        reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(new_root_id)->GetData());
+        reinterpret_cast<InternalPage *>(GetLatchedPage(context, new_root_id)->GetData());
     //父节点设为null
     new_root_page->SetParentPageId(INVALID_PAGE_ID);
     //更新root
     root_page_id_ = new_root_id;
     //更新roots page
     UpdateRootPageId(false);
-    //unpin
-    buffer_pool_manager_->UnpinPage(old_root_node->GetPageId(), false);
-    buffer_pool_manager_->DeletePage(old_root_node->GetPageId());
-    buffer_pool_manager_->UnpinPage(new_root_id, true);
+    context.deleted_.push_back(old_root_node->GetPageId());
     return true;
   }
   // case 2: when you delete the last element in whole b+ tree
   if (old_root_node->IsLeafPage() && !old_root_node->GetSize()) {
-    buffer_pool_manager_->UnpinPage(old_root_node->GetPageId(), false);
-    buffer_pool_manager_->DeletePage(root_page_id_);
+    page_id_t expected = root_page_id_;
+    last_page_id_.compare_exchange_strong(expected, INVALID_PAGE_ID);
+    context.deleted_.push_back(root_page_id_);
     //设为invalid
     root_page_id_ = INVALID_PAGE_ID;
     // 更新
@@ -515,11 +723,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
-  auto root = reinterpret_cast<LeafPage*>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-  auto key = root->KeyAt(0);
-  buffer_pool_manager_->UnpinPage(root_page_id_, false);
-  auto leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key, true));
-  return INDEXITERATOR_TYPE(leaf, buffer_pool_manager_, 0);
+  return INDEXITERATOR_TYPE(this, buffer_pool_manager_, KeyType(), true);
 }
 
 /*
@@ -529,8 +733,22 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  auto leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key, false));
-  return INDEXITERATOR_TYPE(leaf, buffer_pool_manager_, leaf->KeyIndex(key, comparator_));
+  return INDEXITERATOR_TYPE(this, buffer_pool_manager_, key, false);
+}
+
+/*
+ * Input parameters are the bounds of a range, the iterator starts from one
+ * bound (from the edge of the tree if it is null) and becomes End() once it
+ * passes the other one
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Range(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive,
+                                         bool reverse) {
+  const KeyType *start = reverse ? hi : lo;
+  const KeyType *end = reverse ? lo : hi;
+  return INDEXITERATOR_TYPE(this, buffer_pool_manager_, start ? *start : KeyType(), start == nullptr,
+                            reverse ? hi_inclusive : lo_inclusive, reverse, end, reverse ? lo_inclusive : hi_inclusive);
 }
 
 /*
@@ -540,7 +758,7 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() {
-  return INDEXITERATOR_TYPE(nullptr, buffer_pool_manager_, -1);
+  return INDEXITERATOR_TYPE();
 }
 
 /*****************************************************************************
@@ -548,35 +766,210 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() {
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
- * Note: the leaf page is pinned, you need to unpin it after use.
+ * the left most leaf page, if rightMost flag == true, find the right most one
+ * Optimistic lock coupling: pages are read without latching, a parent is
+ * validated against its version after its child is pinned, and the search
+ * restarts from the root if a writer has changed it. A child which is still
+ * in the tree when it is pinned is not deleted before it is unpinned.
+ * Note: the leaf page is pinned but not latched, version is read from it when
+ * it was found. The caller validates what it reads from the leaf with version
+ * and unpins the leaf after use.
+ * @return: the leaf page, nullptr if the tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  if (IsEmpty()) return nullptr;
-  auto leaf = reinterpret_cast<LeafPage*>(buffer_pool_manager_->FetchPage(last_page_id_)->GetData());
-  if (!leftMost && leaf->IsLast(key, comparator_))
-    return reinterpret_cast<Page * >(leaf);
-  buffer_pool_manager_->UnpinPage(last_page_id_, false);
-  page_id_t next_page_id = root_page_id_;
-  //获取该页
-  InternalPage *page = reinterpret_cast<InternalPage *>
-      (buffer_pool_manager_->FetchPage(next_page_id)->GetData());
-  while(!page->IsLeafPage())
-  {
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, uint64_t &version, bool leftMost, bool rightMost) {
+  if (!leftMost && !rightMost) {
+    Page *page = FindLastLeafPage(key, version);
+    if (page)
+      return page;
+  }
+  while (true) {
+    page_id_t root_id = root_page_id_;
+    if (root_id == INVALID_PAGE_ID)
+      return nullptr;
+    Page *page = buffer_pool_manager_->FetchPage(root_id);
+    version = page->GetVersion();
+    // 读到版本号时该页仍是根，之后换根会先改变它的版本号
+    bool valid = root_page_id_ == root_id;
+    auto node = reinterpret_cast<InternalPage *>(page->GetData());
     // 警钟长鸣！不要随便混用 LeafPage 和 InternalPage 的函数！
-    if (page->IsLeafPage()) {
-      break;
+    while (valid && !node->IsLeafPage()) {
+      page_id_t child_id = leftMost    ? node->ValueAt(0)
+                           : rightMost ? node->ValueAt(node->GetSize() - 1)
+                                       : node->Lookup(key, comparator_);
+      if (!page->ValidateVersion(version)) {
+        valid = false;
+        break;
+      }
+      Page *child = buffer_pool_manager_->FetchPage(child_id);
+      uint64_t child_version = child->GetVersion();
+      // pin 住孩子之后父结点仍未变化，孩子就还在树中
+      valid = page->ValidateVersion(version);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = child;
+      version = child_version;
+      node = reinterpret_cast<InternalPage *>(page->GetData());
     }
-    if(leftMost)
-      next_page_id = page->ValueAt(0); //find the left most leaf page
-    else
-      next_page_id = page->Lookup(key, comparator_);
+    if (valid)
+      return page;
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*
+ * Latch crabbing from the root down to the leaf page for writers
+ * Write latch the child, release all ancestors in context once the child is
+ * safe. The leaf is the last page of context.
+ * @return: the leaf page, nullptr if the tree is empty, root_latch_ is still
+ * held by context then
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, TreeOperation operation,
+                                   LatchContext *context) {
+  if (!leftMost) {
+    Page *page = FindLastLeafPage(key, operation);
+    if (page) {
+      context->pages_.push_back(page);
+      return page;
+    }
+  }
+  root_latch_.WLock();
+  context->root_latched_ = true;
+  if (root_page_id_ == INVALID_PAGE_ID)
+    return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->WLatch();
+  context->pages_.push_back(page);
+  if (IsSafe(reinterpret_cast<BPlusTreePage *>(page->GetData()), operation))
+    ReleaseAncestors(*context);
+  auto node = reinterpret_cast<InternalPage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    page_id_t next_page_id = leftMost ? node->ValueAt(0) : node->Lookup(key, comparator_);
+    Page *child = buffer_pool_manager_->FetchPage(next_page_id);
+    child->WLatch();
+    context->pages_.push_back(child);
+    if (IsSafe(reinterpret_cast<BPlusTreePage *>(child->GetData()), operation))
+      ReleaseAncestors(*context);
+    page = child;
+    node = reinterpret_cast<InternalPage *>(page->GetData());
+  }
+  return page;
+}
+
+/*
+ * Fast path for keys after the last inserted key, eg: increasing keys
+ * Latch the leaf in last_page_id_ directly if it still is that leaf, the key
+ * falls into it and it is safe for the operation.
+ * @return: the latched leaf page, nullptr if the tree must be searched from
+ * the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLastLeafPage(const KeyType &key, TreeOperation operation) {
+  page_id_t page_id = last_page_id_;
+  if (page_id == INVALID_PAGE_ID)
+    return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (!page)
+    return nullptr;
+  page->WLatch();
+  // 加锁后 last_page_id_ 仍指向该页才能确定它没有被删除
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (last_page_id_ == page_id && leaf->GetSize() > 0 && leaf->IsLast(key, comparator_) && IsSafe(leaf, operation))
+    return page;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return nullptr;
+}
+
+/*
+ * The same fast path for readers, the leaf is read without latching and its
+ * version is returned as by FindLeafPage
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLastLeafPage(const KeyType &key, uint64_t &version) {
+  page_id_t page_id = last_page_id_;
+  if (page_id == INVALID_PAGE_ID)
+    return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (!page)
+    return nullptr;
+  version = page->GetVersion();
+  // 读到版本号之后 last_page_id_ 仍指向该页，它就是本树的叶子
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (last_page_id_ == page_id && leaf->GetSize() > 0 && leaf->IsLast(key, comparator_) &&
+      page->ValidateVersion(version))
+    return page;
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return nullptr;
+}
+
+/*
+ * A page is safe when an insert or remove in its subtree can not split or
+ * merge it, so that its ancestors can be released
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, TreeOperation operation) const {
+  if (operation == TreeOperation::kInsert)
+    return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsInsertSafe()
+                              : reinterpret_cast<InternalPage *>(node)->IsInsertSafe();
+  // 根的下限不同：根叶子删空或者根只剩一个孩子时要调整根
+  if (node->IsRootPage())
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+  return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->IsRemoveSafe()
+                            : reinterpret_cast<InternalPage *>(node)->IsRemoveSafe();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::GetLatchedPage(LatchContext &context, page_id_t page_id) const {
+  for (auto page : context.pages_) {
+    if (page->GetPageId() == page_id)
+      return page;
+  }
+  ASSERT(false, "Page is not latched by the operation.");
+  return nullptr;
+}
+
+/*
+ * Release root_latch_ and all latched pages except the last one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseAncestors(LatchContext &context) {
+  if (context.root_latched_) {
+    root_latch_.WUnlock();
+    context.root_latched_ = false;
+  }
+  while (context.pages_.size() > 1) {
+    Page *page = context.pages_.front();
+    context.pages_.pop_front();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
 
+/*
+ * Release everything latched by an insert or remove, then delete the pages
+ * emptied by it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseAll(LatchContext &context) {
+  if (context.root_latched_) {
+    root_latch_.WUnlock();
+    context.root_latched_ = false;
   }
-  return reinterpret_cast<Page *>(page);
+  for (auto page : context.pages_) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  context.pages_.clear();
+  if (context.deleted_.empty())
+    return;
+  // 无锁的读者可能还 pin 着被删除的页，删除失败的页留给之后的操作再删
+  std::lock_guard<std::mutex> guard(deleted_latch_);
+  deleted_pages_.insert(deleted_pages_.end(), context.deleted_.begin(), context.deleted_.end());
+  context.deleted_.clear();
+  auto last = std::remove_if(deleted_pages_.begin(), deleted_pages_.end(),
+                             [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+  deleted_pages_.erase(last, deleted_pages_.end());
 }
 
 /*
@@ -697,7 +1090,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
   if (page->IsLeafPage()) {
     auto *leaf = reinterpret_cast<LeafPage *>(page);
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+              << " next: " << leaf->GetNextPageId() << " prev: " << leaf->GetPrevPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
       std::cout << leaf->KeyAt(i) << ",";
     }
@@ -745,3 +1138,15 @@ class BPlusTree<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
 class BPlusTree<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTree<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTree<GenericKey<256>, RowId, GenericComparator<256>>;
+
+template
+class BPlusTree<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>>;
+
+template
+class BPlusTree<IntegerKey<int64_t>, RowId, IntegerComparator<int64_t>>;
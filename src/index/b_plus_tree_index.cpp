@@ -1,20 +1,56 @@
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+
+#include "glog/logging.h"
 #include "index/b_plus_tree_index.h"
 #include "index/generic_key.h"
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
-                                     BufferPoolManager *buffer_pool_manager)
-        : Index(index_id, key_schema),
+                                     BufferPoolManager *buffer_pool_manager, bool unique)
+        : Index(index_id, key_schema, unique),
           comparator_(key_schema_),
           container_(index_id, buffer_pool_manager, comparator_) {
 
 }
 
+IndexKeyType ChooseIndexKeyType(const Schema *key_schema, bool unique) {
+  if (unique && key_schema->GetColumnCount() == 1 && !key_schema->GetColumn(0)->IsNullable()) {
+    switch (key_schema->GetColumn(0)->GetType()) {
+      case kTypeInt:
+      case kTypeDate:
+        return kKeyInt32;
+      case kTypeBigInt:
+      case kTypeTimestamp:
+        return kKeyInt64;
+      default:
+        break;
+    }
+  }
+  uint32_t size = KeyCodec::GetMaxEncodedSize(key_schema) + (unique ? 0 : KeyCodec::ROW_ID_SIZE);
+  if (size <= 4)
+    return kKeyGeneric4;
+  if (size <= 8)
+    return kKeyGeneric8;
+  if (size <= 16)
+    return kKeyGeneric16;
+  if (size <= 32)
+    return kKeyGeneric32;
+  if (size <= 64)
+    return kKeyGeneric64;
+  if (size <= 128)
+    return kKeyGeneric128;
+  if (size <= 256)
+    return kKeyGeneric256;
+  return kKeyInvalid;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
+  SerializeKey(key, row_id, index_key);
 
   bool status = container_.Insert(index_key, row_id, txn);
 
@@ -27,7 +63,7 @@ dberr_t BPLUSTREE_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transact
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
+  SerializeKey(key, row_id, index_key);
 
   container_.Remove(index_key, txn);
   return DB_SUCCESS;
@@ -35,13 +71,179 @@ dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transact
 
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
-  KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
-  int index;
-  if (container_.GetValue(index_key, result, nullptr, index, txn)) {
-    return DB_SUCCESS;
+  if (unique_ && key.GetFieldCount() == key_schema_->GetColumnCount()) {
+    KeyType index_key;
+    index_key.SerializeFromKey(key, key_schema_);
+    int index;
+    if (container_.GetValue(index_key, result, nullptr, index, txn)) {
+      return DB_SUCCESS;
+    }
+    return DB_KEY_NOT_FOUND;
+  }
+  // 同一 key（或以同一前缀开头）的条目连续排列
+  size_t size = result.size();
+  for (auto iter = ScanRange(&key, true, &key, true); iter != container_.End(); ++iter) {
+    result.push_back((*iter).second);
+  }
+  return result.size() > size ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::ScanRange(const Row *lo, bool lo_inclusive, const Row *hi, bool hi_inclusive,
+                                                   bool reverse) {
+  // 非唯一索引中包含 lo 时从它的下界开始，否则从它的上界之后开始，hi 同理
+  KeyType lo_key, hi_key;
+  if (lo)
+    SerializeBound(*lo, !lo_inclusive, lo_key);
+  if (hi)
+    SerializeBound(*hi, hi_inclusive, hi_key);
+  return container_.Range(lo ? &lo_key : nullptr, lo_inclusive, hi ? &hi_key : nullptr, hi_inclusive, reverse);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SerializeBound(const Row &key, bool upper, KeyType &bound) const {
+  if (unique_ && key.GetFieldCount() == key_schema_->GetColumnCount()) {
+    bound.SerializeFromKey(key, key_schema_);
+    return;
+  }
+  // key 的条目都以它的编码开头（后面是其余的列或 row id），用全 0 和全 1 补齐就是上下界
+  bound.SerializeBound(key, upper, key_schema_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SerializeKey(const Row &key, const RowId &row_id, KeyType &index_key) const {
+  if (unique_)
+    index_key.SerializeFromKey(key, key_schema_);
+  else
+    index_key.SerializeFromKey(key, row_id, key_schema_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::BulkLoad(const IndexEntryScanner &scan, Transaction *txn) {
+  return BulkLoad(scan, txn, INDEX_FILL_FACTOR, INDEX_BULK_LOAD_MEMORY);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::BulkLoad(const IndexEntryScanner &scan, Transaction *txn, double fill_factor,
+                                       size_t memory_budget) {
+  if (!container_.IsEmpty())
+    return DB_FAILED;
+  // 按 key 稳定排序并去重，相同的 key 只保留最先扫描到的条目
+  auto sort_run = [this](std::vector<MappingType> &run) {
+    std::stable_sort(run.begin(), run.end(), [this](const MappingType &lhs, const MappingType &rhs) {
+      return comparator_(lhs.first, rhs.first) < 0;
+    });
+    run.erase(std::unique(run.begin(), run.end(), [this](const MappingType &lhs, const MappingType &rhs) {
+      return comparator_(lhs.first, rhs.first) == 0;
+    }), run.end());
+  };
+  size_t run_size = std::max<size_t>(1, memory_budget / sizeof(MappingType));
+  std::vector<MappingType> buffer;
+  std::vector<FILE *> runs;
+  bool failed = false;
+  scan([&](const Row &key, RowId row_id) {
+    if (failed)
+      return;
+    buffer.emplace_back();
+    SerializeKey(key, row_id, buffer.back().first);
+    buffer.back().second = row_id;
+    if (buffer.size() < run_size)
+      return;
+    // 超出内存预算，把排好序的一段写到临时文件
+    sort_run(buffer);
+    FILE *file = std::tmpfile();
+    if (file == nullptr) {
+      failed = true;
+      return;
+    }
+    runs.push_back(file);
+    for (auto &item : buffer) {
+      if (fwrite(&item.first, sizeof(KeyType), 1, file) != 1 || fwrite(&item.second, sizeof(ValueType), 1, file) != 1) {
+        failed = true;
+        return;
+      }
+    }
+    buffer.clear();
+  });
+  sort_run(buffer);
+  if (failed) {
+    LOG(ERROR) << "Failed to write sorted runs for bulk loading." << std::endl;
+    for (auto file : runs)
+      fclose(file);
+    return DB_FAILED;
+  }
+  if (runs.empty()) {
+    size_t pos = 0;
+    bool loaded = container_.BulkLoad(buffer.size(), [&](MappingType &item) {
+      item = buffer[pos++];
+      return true;
+    }, fill_factor);
+    if (!loaded)
+      LOG(ERROR) << "Failed to allocate pages for bulk loading." << std::endl;
+    return loaded ? DB_SUCCESS : DB_FAILED;
   }
-  return DB_KEY_NOT_FOUND;
+  // 多路归并，内存中剩下的一段排在最后，key 相同时先取较早的段，跳过重复的 key
+  using Head = std::pair<MappingType, size_t>;
+  auto greater = [this](const Head &lhs, const Head &rhs) {
+    int result = comparator_(lhs.first.first, rhs.first.first);
+    return result > 0 || (result == 0 && lhs.second > rhs.second);
+  };
+  std::priority_queue<Head, std::vector<Head>, decltype(greater)> heap(greater);
+  size_t buffer_pos = 0;
+  auto read = [&](size_t run, MappingType &item) {
+    if (run == runs.size()) {
+      if (buffer_pos == buffer.size())
+        return false;
+      item = buffer[buffer_pos++];
+      return true;
+    }
+    return fread(&item.first, sizeof(KeyType), 1, runs[run]) == 1 &&
+           fread(&item.second, sizeof(ValueType), 1, runs[run]) == 1;
+  };
+  bool has_last = false;
+  MappingType last;
+  auto restart = [&]() {
+    while (!heap.empty())
+      heap.pop();
+    buffer_pos = 0;
+    has_last = false;
+    MappingType item;
+    for (size_t run = 0; run <= runs.size(); run++) {
+      if (run < runs.size())
+        rewind(runs[run]);
+      if (read(run, item))
+        heap.emplace(item, run);
+    }
+  };
+  auto next = [&](MappingType &item) {
+    while (!heap.empty()) {
+      Head head = heap.top();
+      heap.pop();
+      MappingType following;
+      if (read(head.second, following))
+        heap.emplace(following, head.second);
+      if (has_last && comparator_(head.first.first, last.first) == 0)
+        continue;
+      has_last = true;
+      last = head.first;
+      item = head.first;
+      return true;
+    }
+    return false;
+  };
+  // 第一遍归并只数出去重后的条目数，第二遍建树
+  size_t count = 0;
+  MappingType item;
+  restart();
+  while (next(item))
+    count++;
+  restart();
+  bool loaded = container_.BulkLoad(count, next, fill_factor);
+  for (auto file : runs)
+    fclose(file);
+  if (!loaded)
+    LOG(ERROR) << "Failed to allocate pages for bulk loading." << std::endl;
+  return loaded ? DB_SUCCESS : DB_FAILED;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -79,4 +281,16 @@ template
 class BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
-class BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>;
\ No newline at end of file
+class BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256>>;
+
+template
+class BPlusTreeIndex<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>>;
+
+template
+class BPlusTreeIndex<IntegerKey<int64_t>, RowId, IntegerComparator<int64_t>>;
\ No newline at end of file
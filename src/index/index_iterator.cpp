@@ -1,48 +1,82 @@
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "index/b_plus_tree.h"
 #include "index/index_iterator.h"
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator() {
+  tree_ = nullptr;
+  page_ = nullptr;
   leaf_ = nullptr;
   bpm_ = nullptr;
+  version_ = 0;
   index_ = -1;
+  from_edge_ = false;
+  inclusive_ = false;
+  reverse_ = false;
+  has_end_ = false;
+  end_inclusive_ = false;
 }
 
-INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(
-    BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf, BufferPoolManager *bpm, int index) {
-  leaf_ = leaf;
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree,
+                                                          BufferPoolManager *bpm, const KeyType &key, bool fromEdge,
+                                                          bool inclusive, bool reverse, const KeyType *end,
+                                                          bool end_inclusive) {
+  tree_ = tree;
+  page_ = nullptr;
+  leaf_ = nullptr;
   bpm_ = bpm;
-  index_ = index;
+  version_ = 0;
+  index_ = -1;
+  key_ = key;
+  from_edge_ = fromEdge;
+  inclusive_ = inclusive;
+  reverse_ = reverse;
+  has_end_ = end != nullptr;
+  if (has_end_)
+    end_ = *end;
+  end_inclusive_ = end_inclusive;
+  Seek();
+  Load();
+}
+
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept {
+  tree_ = other.tree_;
+  page_ = other.page_;
+  leaf_ = other.leaf_;
+  bpm_ = other.bpm_;
+  version_ = other.version_;
+  index_ = other.index_;
+  item_ = other.item_;
+  key_ = other.key_;
+  from_edge_ = other.from_edge_;
+  inclusive_ = other.inclusive_;
+  reverse_ = other.reverse_;
+  has_end_ = other.has_end_;
+  end_ = other.end_;
+  end_inclusive_ = other.end_inclusive_;
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+  other.index_ = -1;
 }
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::~IndexIterator() {
-  if (leaf_ != nullptr)
-    bpm_->UnpinPage(leaf_->GetPageId(), false);
+  if (page_ != nullptr)
+    bpm_->UnpinPage(page_->GetPageId(), false);
 }
 
 INDEX_TEMPLATE_ARGUMENTS const MappingType &INDEXITERATOR_TYPE::operator*() {
-  return leaf_->GetItem(index_);
+  return item_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
-  if (index_ + 1 < leaf_->GetSize()) {
-    ++index_;
-  } else {
-    bpm_->UnpinPage(leaf_->GetPageId(), false);
-    if (leaf_->GetNextPageId() != INVALID_PAGE_ID) {
-      leaf_ = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*>(bpm_->FetchPage(leaf_->GetNextPageId())->GetData());
-      index_ = 0;
-    } else {
-      leaf_ = nullptr;
-      index_ = -1;
-    }
-  }
+  index_ += reverse_ ? -1 : 1;
+  Load();
   return *this;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
-  return leaf_ == itr.leaf_ && index_ == itr.index_ && bpm_ == itr.bpm_;
+  return leaf_ == itr.leaf_ && index_ == itr.index_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -50,6 +84,85 @@ bool INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const {
   return !(*this == itr);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Seek() {
+  if (page_ != nullptr)
+    bpm_->UnpinPage(page_->GetPageId(), false);
+  page_ = tree_->FindLeafPage(key_, version_, from_edge_ && !reverse_, from_edge_ && reverse_);
+  if (page_ == nullptr) {
+    leaf_ = nullptr;
+    index_ = -1;
+    return;
+  }
+  leaf_ = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(page_->GetData());
+  // 这里读到的位置由 Load 读出键值对时一并校验
+  if (from_edge_) {
+    index_ = reverse_ ? leaf_->GetSize() - 1 : 0;
+    return;
+  }
+  index_ = leaf_->KeyIndex(key_, tree_->comparator_);
+  bool equal = index_ < leaf_->GetSize() && tree_->comparator_(leaf_->KeyAt(index_), key_) == 0;
+  if (!reverse_ && !inclusive_ && equal)
+    ++index_;
+  // index_ 是第一个 >= key_ 的键，反向时取它前面一个，该叶子中没有时 Load 会移到左边的叶子
+  if (reverse_ && !(inclusive_ && equal))
+    --index_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Load() {
+  while (page_ != nullptr) {
+    if (index_ >= 0 && index_ < leaf_->GetSize()) {
+      MappingType item = leaf_->GetItem(index_);
+      if (page_->ValidateVersion(version_)) {
+        if (has_end_) {
+          int result = tree_->comparator_(item.first, end_);
+          if (reverse_)
+            result = -result;
+          if (result > 0 || (result == 0 && !end_inclusive_)) {
+            Release();
+            return;
+          }
+        }
+        item_ = item;
+        key_ = item.first;
+        from_edge_ = false;
+        inclusive_ = false;
+        return;
+      }
+    } else if ((index_ < 0) == reverse_) {
+      page_id_t next_page_id = reverse_ ? leaf_->GetPrevPageId() : leaf_->GetNextPageId();
+      if (page_->ValidateVersion(version_)) {
+        Page *next = next_page_id == INVALID_PAGE_ID ? nullptr : bpm_->FetchPage(next_page_id);
+        uint64_t next_version = next ? next->GetVersion() : 0;
+        // pin 住下一个叶子之后当前叶子仍未变化，下一个叶子就还在树中
+        if (page_->ValidateVersion(version_)) {
+          bpm_->UnpinPage(page_->GetPageId(), false);
+          page_ = next;
+          leaf_ = next ? reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(next->GetData())
+                       : nullptr;
+          version_ = next_version;
+          // 左边叶子的大小在读到版本号之后读出，同样由读出键值对时校验
+          index_ = next ? (reverse_ ? leaf_->GetSize() - 1 : 0) : -1;
+          continue;
+        }
+        if (next)
+          bpm_->UnpinPage(next_page_id, false);
+      }
+    }
+    Seek();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr)
+    bpm_->UnpinPage(page_->GetPageId(), false);
+  page_ = nullptr;
+  leaf_ = nullptr;
+  index_ = -1;
+}
+
 template
 class IndexIterator<int, int, BasicComparator<int>>;
 
@@ -67,3 +180,15 @@ class IndexIterator<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
 class IndexIterator<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class IndexIterator<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class IndexIterator<GenericKey<256>, RowId, GenericComparator<256>>;
+
+template
+class IndexIterator<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>>;
+
+template
+class IndexIterator<IntegerKey<int64_t>, RowId, IntegerComparator<int64_t>>;
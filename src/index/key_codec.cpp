@@ -0,0 +1,139 @@
+#include "index/key_codec.h"
+
+template<typename T>
+static inline uint32_t WriteBigEndian(T value, char *buf) {
+  for (uint32_t i = 0; i < sizeof(T); i++) {
+    buf[i] = static_cast<char>(value >> ((sizeof(T) - 1 - i) * 8));
+  }
+  return sizeof(T);
+}
+
+/**
+ * Bits of a float or double ordered as unsigned integers
+ */
+template<typename Bits, typename Float>
+static inline Bits OrderedBits(Float value) {
+  constexpr Bits SIGN = static_cast<Bits>(1) << (sizeof(Bits) * 8 - 1);
+  if (value == 0)
+    value = 0;  // -0 与 0 相等
+  Bits bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return (bits & SIGN) ? ~bits : (bits | SIGN);
+}
+
+/**
+ * @return length of a char value without the trailing zeros it is padded with
+ */
+static inline uint32_t TrimmedLength(const Field &field) {
+  const char *data = field.GetData();
+  uint32_t len = field.GetLength();
+  if (field.GetTypeId() == kTypeChar) {
+    while (len > 0 && data[len - 1] == '\0')
+      len--;
+  }
+  return len;
+}
+
+uint32_t KeyCodec::Encode(const Row &key, Schema *schema, char *buf) {
+  ASSERT(key.GetFieldCount() <= schema->GetColumnCount(), "field nums not match.");
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+    offset += EncodeField(*key.GetField(i), buf + offset);
+  }
+  return offset;
+}
+
+uint32_t KeyCodec::GetEncodedSize(const Row &key, Schema *schema) {
+  ASSERT(key.GetFieldCount() <= schema->GetColumnCount(), "field nums not match.");
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+    size += GetEncodedSize(*key.GetField(i));
+  }
+  return size;
+}
+
+uint32_t KeyCodec::EncodeField(const Field &field, char *buf) {
+  if (field.IsNull()) {
+    buf[0] = static_cast<char>(KEY_NULL);
+    return 1;
+  }
+  buf[0] = static_cast<char>(KEY_NOT_NULL);
+  char *out = buf + 1;
+  switch (field.GetTypeId()) {
+    case kTypeInt:
+    case kTypeDate:
+      out += WriteBigEndian(static_cast<uint32_t>(field.value_.integer_) ^ 0x80000000u, out);
+      break;
+    case kTypeBigInt:
+    case kTypeTimestamp:
+      out += WriteBigEndian(static_cast<uint64_t>(field.value_.bigint_) ^ 0x8000000000000000ull, out);
+      break;
+    case kTypeFloat:
+      out += WriteBigEndian(OrderedBits<uint32_t>(field.value_.float_), out);
+      break;
+    case kTypeDouble:
+      out += WriteBigEndian(OrderedBits<uint64_t>(field.value_.double_), out);
+      break;
+    default: {
+      ASSERT(!field.IsToasted(), "Toasted field in index key.");
+      const char *data = field.GetData();
+      uint32_t len = TrimmedLength(field);
+      for (uint32_t i = 0; i < len; i++) {
+        *out++ = data[i];
+        if (data[i] == '\0')
+          *out++ = 1;
+      }
+      *out++ = 0;
+      *out++ = 0;
+    }
+  }
+  return static_cast<uint32_t>(out - buf);
+}
+
+uint32_t KeyCodec::EncodeRowId(const RowId &row_id, char *buf) {
+  // 合法的页号非负，按无符号数比较的顺序与 RowId 的顺序一致
+  WriteBigEndian(static_cast<uint32_t>(row_id.GetPageId()), buf);
+  WriteBigEndian(row_id.GetSlotNum(), buf + sizeof(uint32_t));
+  return ROW_ID_SIZE;
+}
+
+uint32_t KeyCodec::GetMaxEncodedSize(const Schema *schema) {
+  uint32_t size = 0;
+  for (auto column : schema->GetColumns()) {
+    if (Type::IsCharType(column->GetType()))
+      size += 1 + column->GetLength() + 2;
+    else
+      size += 1 + Type::GetTypeSize(column->GetType());
+  }
+  return size;
+}
+
+int64_t KeyCodec::GetInteger(const Field &field) {
+  ASSERT(!field.IsNull(), "Null integer key.");
+  switch (field.GetTypeId()) {
+    case kTypeInt:
+    case kTypeDate:
+      return field.value_.integer_;
+    case kTypeBigInt:
+    case kTypeTimestamp:
+      return field.value_.bigint_;
+    default:
+      ASSERT(false, "Not an integer key.");
+      return 0;
+  }
+}
+
+uint32_t KeyCodec::GetEncodedSize(const Field &field) {
+  if (field.IsNull())
+    return 1;
+  if (!Type::IsCharType(field.GetTypeId()))
+    return 1 + Type::GetTypeSize(field.GetTypeId());
+  const char *data = field.GetData();
+  uint32_t len = TrimmedLength(field);
+  uint32_t size = 1 + len + 2;
+  for (uint32_t i = 0; i < len; i++) {
+    if (data[i] == '\0')
+      size++;
+  }
+  return size;
+}
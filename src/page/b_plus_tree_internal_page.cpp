@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
 #include "page/b_plus_tree_internal_page.h"
@@ -17,6 +19,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
   SetParentPageId(parent_id);
   SetMaxSize(max_size);
   SetSize(0);
+  entries_.Init();
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -24,13 +27,21 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  return array_[index].first;
+  return entries_.KeyAt(index);
+}
+
+/*
+ * @return false if the page has no room for key, a longer key may not fit when
+ * keys are stored with variable length
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  return entries_.SetKeyAt(GetSize(), index, key);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
-  array_[index].first = key;
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const {
+  return entries_.CanSetKeyAt(GetSize(), index, key);
 }
 
 /*
@@ -40,7 +51,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
   for (int i = 0; i < GetSize(); i++) {
-    if (array_[i].second == value) {
+    if (entries_.ValueAt(i) == value) {
       return i;
     }
   }
@@ -53,8 +64,7 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
-  // replace with your own code
-  return array_[index].second;
+  return entries_.ValueAt(index);
 }
 
 /*****************************************************************************
@@ -67,12 +77,8 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  // replace with your own code
-  int index = 1;
-  while (index < GetSize() && comparator(array_[index].first, key) <= 0) {
-    index++;
-  }
-  return array_[index-1].second;
+  // 最后一个 <= key 的位置
+  return entries_.ValueAt(entries_.Search(1, GetSize(), key, comparator, true) - 1);
 }
 
 /*****************************************************************************
@@ -87,37 +93,98 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
+  // 第一个 key 无效，根没有下界，置为空
+  MappingType items[2] = {MappingType(KeyType{}, old_value), MappingType(new_key, new_value)};
+  bool assigned = entries_.Assign(items, 2);
+  ASSERT(assigned, "New root does not fit into the internal page.");
   SetSize(2);
-  array_[0].first = new_key;  // invalid in fact
-  array_[0].second = old_value;
-  array_[1].first = new_key;
-  array_[1].second = new_value;
   SetParentPageId(INVALID_PAGE_ID);
 }
 
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
- * @return:  new size after insertion
+ * @return:  false if the page has no room for new_key, the page is unchanged
+ * then
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
-                                                    const ValueType &new_value) {
-    //遍历查找
-    for (int i = 0; i < GetSize(); i++) {
-    if (array_[i].second == old_value) {
-      for (int j = GetSize() - 1; j > i; j--) {
-        array_[j + 1] = array_[j];  //拷贝
-      }
-      //插入键值对
-      array_[i + 1].first = new_key;
-      array_[i + 1].second = new_value;
-      //修改大小
-      SetSize(GetSize() + 1);
-      return GetSize();
-    }
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) {
+  //遍历查找
+  int index = ValueIndex(old_value);
+  ASSERT(index >= 0, "Old value is not a child of the internal page.");
+  //插入键值对
+  if (!entries_.Insert(GetSize(), index + 1, new_key, new_value))
+    return false;
+  //修改大小
+  SetSize(GetSize() + 1);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanInsert(const KeyType &new_key) const {
+  return entries_.CanInsert(GetSize(), new_key);
+}
+
+/*
+ * Append new_key & new_value pair as the last child, the key of the first
+ * child is invalid in fact
+ * @return false if the page has no room for new_key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &new_key, const ValueType &new_value) {
+  if (!entries_.Insert(GetSize(), GetSize(), new_key, new_value))
+    return false;
+  SetSize(GetSize() + 1);
+  return true;
+}
+
+/*
+ * Whether bulk loading appends new_key to this page, the page takes at most
+ * fill_factor of its space unless it has fewer than two children
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanAppend(const KeyType &new_key, double fill_factor) const {
+  if (GetSize() < 2)
+    return true;
+  return GetSize() < GetMaxSize() && entries_.GetUsedSpace(GetSize()) < fill_factor * Entries::kDataSize &&
+         entries_.CanInsert(GetSize(), new_key);
+}
+
+/*
+ * An insert into this page can not split it, see BPlusTreeLeafPage::IsInsertSafe
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsInsertSafe() const {
+  if (GetSize() >= GetMaxSize())
+    return false;
+  if constexpr (Entries::kVariableLength) {
+    return entries_.GetFreeSpace(GetSize()) >= Entries::kMaxEntrySize + (GetSize() - 1) * entries_.GetPrefixSize();
+  }
+  return true;
+}
+
+/*
+ * A remove from this page can not make it underflow
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsRemoveSafe() const {
+  if constexpr (Entries::kVariableLength) {
+    return (entries_.GetUsedSpace(GetSize()) - Entries::kMaxEntrySize) * 2 >= Entries::kDataSize;
   }
-  return GetSize();
+  return GetSize() > GetMinSize();
+}
+
+/*
+ * A page underflows when it has fewer children than min size, or takes less
+ * than half of its space for keys of variable length
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const {
+  if constexpr (Entries::kVariableLength) {
+    return entries_.GetFreeSpace(GetSize()) * 2 > Entries::kDataSize;
+  }
+  return GetSize() < GetMinSize();
 }
 
 /*****************************************************************************
@@ -125,37 +192,38 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * If new_key is not null, it is the key which did not fit into this page and
+ * is inserted into one of both pages afterwards. A key without the prefix of
+ * the page is greater than all keys of the page, it goes to the recipient with
+ * the last child only so that the prefix of the others is kept.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {
-  auto page = buffer_pool_manager->FetchPage(GetPageId());
-  if (page != nullptr) {
-    page->WLatch();
-    //设置大小为原来的一半
-    if (GetSize() % 2) //奇数
-      recipient->SetSize(GetSize()/2+1);
-    else //偶数
-      recipient->SetSize(GetSize()/2);
-    SetSize(GetSize() / 2);
-    //转移一半键值
-    for (int i = 0; i < recipient->GetSize(); i++) {
-      auto child_page = buffer_pool_manager->FetchPage(array_[i + GetSize()].second);
-      if (child_page != nullptr) {
-        child_page->WLatch();
-        auto node = reinterpret_cast<BPlusTreeInternalPage *>(child_page->GetData());
-        //链接父节点
-        node->SetParentPageId(recipient->GetPageId());
-        //转移键值
-        recipient->array_[i] = array_[i + GetSize()];
-        child_page->WUnlatch();
-        buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
-      }
+                                                BufferPoolManager *buffer_pool_manager, const KeyType *new_key) {
+  //留下一半，变长的 key 按字节数对半分
+  int keep = entries_.SplitPoint(GetSize());
+  if constexpr (Entries::kVariableLength) {
+    if (new_key && !entries_.HasPrefix(*new_key))
+      keep = GetSize() - 1;
+  }
+  std::vector<MappingType> items = entries_.Items(GetSize());
+  int size = GetSize() - keep;
+  bool assigned = recipient->entries_.Assign(items.data() + keep, size);
+  ASSERT(assigned, "Items do not fit into the internal page.");
+  recipient->SetSize(size);
+  //转移一半键值
+  for (int i = 0; i < size; i++) {
+    auto child_page = buffer_pool_manager->FetchPage(items[keep + i].second);
+    if (child_page != nullptr) {
+      auto node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+      //链接父节点
+      node->SetParentPageId(recipient->GetPageId());
+      buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
     }
-    recipient->SetParentPageId(GetParentPageId());
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
   }
+  entries_.Assign(items.data(), keep);
+  SetSize(keep);
+  recipient->SetParentPageId(GetParentPageId());
 }
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
@@ -163,32 +231,20 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
-  auto page = buffer_pool_manager->FetchPage(GetPageId());
-  if (page != nullptr) {
-    page->WLatch();
-    SetSize(size);
-    //拷贝size个元素
-    for (int i = 0; i < size; i++) {
-      array_[i] = items[i];
-      auto child_page = buffer_pool_manager->FetchPage(items[i].second);
-      auto node = reinterpret_cast<BPlusTreePage*>(child_page->GetData());
-      if (child_page != nullptr) {
-        //更改父节点
-        node->SetParentPageId(GetPageId());
-        buffer_pool_manager->UnpinPage(items[i].second, true);
-      }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const MappingType *items, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
+  bool assigned = entries_.Assign(items, size);
+  ASSERT(assigned, "Items do not fit into the internal page.");
+  SetSize(size);
+  //拷贝size个元素
+  for (int i = 0; i < size; i++) {
+    auto child_page = buffer_pool_manager->FetchPage(items[i].second);
+    if (child_page != nullptr) {
+      auto node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+      //更改父节点
+      node->SetParentPageId(GetPageId());
+      buffer_pool_manager->UnpinPage(items[i].second, true);
     }
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
-  }
-  page = buffer_pool_manager->FetchPage(GetParentPageId());
-  if (page != nullptr) {
-    page->WLatch();
-    auto node = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-    node->SetKeyAt(node->ValueIndex(GetPageId()), items[0].first);
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetParentPageId(), true);
   }
 }
 
@@ -202,9 +258,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-  for (int i = index; i < GetSize() - 1; i++) {
-    array_[i] = array_[i + 1];
-  }
+  entries_.Remove(GetSize(), index);
   SetSize(GetSize() - 1);
 }
 
@@ -214,15 +268,35 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
-  // replace with your own code
-  ValueType only_child = array_[0].second;
+  ValueType only_child = entries_.ValueAt(0);
   SetSize(0);
+  entries_.Init();
   return only_child;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
+/*
+ * Whether all key & value pairs of this page and the middle_key fit into
+ * "recipient" page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMoveAllTo(const BPlusTreeInternalPage *recipient,
+                                                  const KeyType &middle_key) const {
+  if (GetSize() + recipient->GetSize() > recipient->GetMaxSize())
+    return false;
+  if constexpr (Entries::kVariableLength) {
+    std::vector<MappingType> items = recipient->entries_.Items(recipient->GetSize());
+    std::vector<MappingType> moved = entries_.Items(GetSize());
+    moved[0].first = middle_key;
+    items.insert(items.end(), moved.begin(), moved.end());
+    int prefix;
+    return Entries::GetSpace(items.data(), static_cast<int>(items.size()), prefix) <= Entries::kDataSize;
+  }
+  return true;
+}
+
 /*
  * Remove all of key & value pairs from this page to "recipient" page.
  * The middle_key is the separation key you should get from the parent. You need
@@ -233,31 +307,17 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                BufferPoolManager *buffer_pool_manager) {
-  auto page = buffer_pool_manager->FetchPage(GetPageId());
-  if (page != nullptr) {
-    page->WLatch();
-    auto size = recipient->GetSize();
-    recipient->SetSize(GetSize() + recipient->GetSize());
-    //全部转移
-    for (int i = 0; i < GetSize(); i++) {
-      //通过键值对找到该节点
-      auto child_page = buffer_pool_manager->FetchPage(array_[i].second);
-      child_page->WLatch();
-      if (child_page != nullptr) {
-        auto node = reinterpret_cast<BPlusTreePage*>(child_page->GetData());
-        //修改父节点指针
-        node->SetParentPageId(recipient->GetPageId());
-        child_page->WUnlatch();
-        buffer_pool_manager->UnpinPage(array_[i].second, true);
-      }
-      recipient->array_[i + size] = array_[i];
-    }
-    //修改父节点指针
-    recipient->SetParentPageId(GetParentPageId());
-    SetSize(0);
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
-  }
+  std::vector<MappingType> items = recipient->entries_.Items(recipient->GetSize());
+  std::vector<MappingType> moved = entries_.Items(GetSize());
+  //第一个 key 换成父节点中的分隔 key
+  moved[0].first = middle_key;
+  items.insert(items.end(), moved.begin(), moved.end());
+  //全部转移，修改孩子的父节点指针
+  recipient->CopyNFrom(items.data(), static_cast<int>(items.size()), buffer_pool_manager);
+  //修改父节点指针
+  recipient->SetParentPageId(GetParentPageId());
+  SetSize(0);
+  entries_.Init();
 }
 
 /*****************************************************************************
@@ -274,41 +334,18 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                       BufferPoolManager *buffer_pool_manager) {
-  auto page = buffer_pool_manager->FetchPage(GetPageId());
+  //末元素追加，key 是父节点中的分隔 key
+  recipient->CopyLastFrom(MappingType(middle_key, ValueAt(0)), buffer_pool_manager);
+  recipient->SetParentPageId(GetParentPageId());
+  //移出首个键值对，第二个 key 成为新的分隔 key
+  Remove(0);
+  auto page = buffer_pool_manager->FetchPage(GetParentPageId());
   if (page != nullptr) {
-    page->WLatch();
-    //完成相关设置
-    recipient->SetSize(recipient->GetSize() + 1);
-    //末元素追加
-    recipient->array_[recipient->GetSize() - 1] = array_[0];
-    recipient->SetParentPageId(GetParentPageId());
-    SetSize(GetSize() - 1);
-    //移出首个键值对
-    for (int i = 0; i < GetSize(); i++) {
-      array_[i] = array_[i + 1];
-    }
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
-  }
-  if (GetParentPageId() != INVALID_PAGE_ID) {
-    page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
-    if (page != nullptr) {
-      page->WLatch();
-      auto node = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-      //更新父节点的key
-      node->SetKeyAt(node->ValueIndex(GetPageId()), array_[0].first);
-      page->WUnlatch();
-      buffer_pool_manager->UnpinPage(recipient->GetParentPageId(), true);
-    }
-    page = buffer_pool_manager->FetchPage(recipient->array_[recipient->GetSize() - 1].second);
-    if (page != nullptr) {
-      page->WLatch();
-      auto node = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-      //设置父节点
-      node->SetParentPageId(recipient->GetPageId());
-      page->WUnlatch();
-      buffer_pool_manager->UnpinPage(recipient->array_[recipient->GetSize() - 1].second, true);
-    }
+    auto node = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
+    //更新父节点的key
+    bool updated = node->SetKeyAt(node->ValueIndex(GetPageId()), KeyAt(0));
+    ASSERT(updated, "Key does not fit into the parent page.");
+    buffer_pool_manager->UnpinPage(GetParentPageId(), true);
   }
 }
 
@@ -318,22 +355,14 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  auto page = buffer_pool_manager->FetchPage(GetPageId());
+  bool appended = Append(pair.first, pair.second); //设置最后一个键值对
+  ASSERT(appended, "Item does not fit into the internal page.");
+  auto page = buffer_pool_manager->FetchPage(pair.second);
   if (page != nullptr) {
-    page->WLatch();
-    SetSize(GetSize() + 1);
-    array_[GetSize() - 1] = pair; //设置最后一个键值对
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
-  }
-  page = buffer_pool_manager->FetchPage(array_[GetSize() - 1].second);
-  if (page != nullptr) {
-    page->WLatch();
-    auto node = reinterpret_cast<BPlusTreeInternalPage*>(page->GetData());
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     //更新
     node->SetParentPageId(GetPageId());
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(array_[GetSize() - 1].second, true);
+    buffer_pool_manager->UnpinPage(pair.second, true);
   }
 }
 
@@ -347,79 +376,42 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
-  auto page = buffer_pool_manager->FetchPage(GetPageId());
-  if (page != nullptr) {
-    page->WLatch();
-    recipient->SetSize(recipient->GetSize() + 1);
-    //腾出空位
-    for (int i = recipient->GetSize() - 1; i > 0; i--) {
-      recipient->array_[i] = recipient->array_[i - 1];
-    }
-    //插入首个键值对
-    recipient->array_[0] = array_[GetSize() - 1];
-    recipient->SetParentPageId(GetParentPageId());
-    SetSize(GetSize() - 1);
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
-  }
-  if (GetParentPageId() != INVALID_PAGE_ID) {
-    page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
-    if (page != nullptr) {
-      page->WLatch();
-      auto node = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-      //检查更新key
-      node->SetKeyAt(node->ValueIndex(recipient->GetPageId()), recipient->array_[0].first);
-      page->WUnlatch();
-      buffer_pool_manager->UnpinPage(recipient->GetParentPageId(), true);
-    }
-    page = buffer_pool_manager->FetchPage(recipient->array_[0].second);
-    if (page != nullptr) {
-      page->WLatch();
-      auto node = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-      //设置父节点
-      node->SetParentPageId(recipient->GetPageId());
-      page->WUnlatch();
-      buffer_pool_manager->UnpinPage(recipient->array_[0].second, true);
-    }
-  }
+  MappingType pair = entries_.ItemAt(GetSize() - 1);
+  Remove(GetSize() - 1);
+  //原来无效的第一个 key 换成父节点中的分隔 key，移来的 key 成为新的分隔 key
+  recipient->CopyFirstFrom(pair, middle_key, buffer_pool_manager);
+  recipient->SetParentPageId(GetParentPageId());
 }
 
 /* Append an entry at the beginning.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
+ * The key of the old first entry becomes middle_key.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  auto page = buffer_pool_manager->FetchPage(GetPageId());
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, const KeyType &middle_key,
+                                                   BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> items = entries_.Items(GetSize());
+  items[0].first = middle_key;
+  //腾出首个位置
+  items.insert(items.begin(), pair);
+  bool assigned = entries_.Assign(items.data(), static_cast<int>(items.size()));
+  ASSERT(assigned, "Item does not fit into the internal page.");
+  SetSize(GetSize() + 1);
+  auto page = buffer_pool_manager->FetchPage(GetParentPageId());
   if (page != nullptr) {
-    page->WLatch();
-    SetSize(GetSize() + 1);
-    //腾出首个位置
-    for (int i = GetSize() - 1; i > 0; i--) {
-      array_[i] = array_[i - 1];
-    }
-    //赋值
-    array_[0] = pair;
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
-  }
-  page = buffer_pool_manager->FetchPage(GetParentPageId());
-  if (page != nullptr) {
-    page->WLatch();
-    auto node = reinterpret_cast<BPlusTreeInternalPage*>(page->GetData());
+    auto node = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
     //更新key
-    node->SetKeyAt(node->ValueIndex(GetPageId()), array_[0].first);
-    page->WUnlatch();
+    bool updated = node->SetKeyAt(node->ValueIndex(GetPageId()), pair.first);
+    ASSERT(updated, "Key does not fit into the parent page.");
     buffer_pool_manager->UnpinPage(GetParentPageId(), true);
   }
-  page = buffer_pool_manager->FetchPage(array_[0].second);
+  page = buffer_pool_manager->FetchPage(pair.second);
   if (page != nullptr) {
-    page->WLatch();
-    auto node = reinterpret_cast<BPlusTreeInternalPage*>(page->GetData());
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     //设置parent
     node->SetParentPageId(GetPageId());
-    page->WUnlatch();
-    buffer_pool_manager->UnpinPage(array_[0].second, true);
+    buffer_pool_manager->UnpinPage(pair.second, true);
   }
 }
 
@@ -440,3 +432,15 @@ class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 
 template
 class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+template
+class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+
+template
+class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
+
+template
+class BPlusTreeInternalPage<IntegerKey<int32_t>, page_id_t, IntegerComparator<int32_t>>;
+
+template
+class BPlusTreeInternalPage<IntegerKey<int64_t>, page_id_t, IntegerComparator<int64_t>>;
@@ -19,7 +19,9 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, in
   SetPageType(IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
   SetMaxSize(max_size);
+  entries_.Init();
 }
 
 /**
@@ -36,22 +38,25 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
 }
 
 /**
- * Helper method to find the first index i so that array_[i].first >= key
+ * Helper methods to set/get prev page id, used by reverse iteration
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const {
+  return prev_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+  prev_page_id_ = prev_page_id;
+}
+
+/**
+ * Helper method to find the first index i so that KeyAt(i) >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  int left = 0;
-  int right = GetSize() - 1;
-  while (left <= right) {
-    int mid = left + (right - left) / 2;
-    if (comparator(array_[mid].first, key) < 0) {
-      left = mid + 1;
-    } else {
-      right = mid - 1;
-    }
-  }
-  return left;
+  return entries_.Search(0, GetSize(), key, comparator, false);
 }
 
 /*
@@ -60,7 +65,7 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  return array_[index].first;
+  return entries_.KeyAt(index);
 }
 
 /*
@@ -68,9 +73,8 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array_[index];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  return entries_.ItemAt(index);
 }
 
 /*****************************************************************************
@@ -78,29 +82,98 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
- * @return page size after insertion
+ * @return false if the page has no room for key, the page is unchanged then
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator, int& index) {
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator, int& index) {
   if (index == -1)
     index = KeyIndex(key, comparator);
-  if (index <= GetSize() && comparator(array_[index].first, key) == 0) {
-    array_[index].second = value;
-    return GetSize();
-  }
-  for (int i = GetSize(); i > index; i--) {
-    array_[i] = array_[i - 1];
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    entries_.SetValueAt(index, value);
+    return true;
   }
-  array_[index].first = key;
-  array_[index].second = value;
+  if (!entries_.Insert(GetSize(), index, key, value))
+    return false;
   SetSize(GetSize() + 1);
-  return GetSize();
+  return true;
+}
+
+/*
+ * Whether key & value pair fits into this page, it may not fit when keys are
+ * stored with variable length
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanInsert(const KeyType &key) const {
+  return entries_.CanInsert(GetSize(), key);
+}
+
+/*
+ * Append key & value pair to the end of leaf page, key must be greater than
+ * all keys of this page
+ * @return false if the page has no room for key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
+  if (!entries_.Insert(GetSize(), GetSize(), key, value))
+    return false;
+  SetSize(GetSize() + 1);
+  return true;
+}
+
+/*
+ * Whether bulk loading appends key to this page, the page takes at most
+ * fill_factor of its space unless key is the first one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanAppend(const KeyType &key, double fill_factor) const {
+  if (GetSize() == 0)
+    return true;
+  return GetSize() < GetMaxSize() && entries_.GetUsedSpace(GetSize()) < fill_factor * Entries::kDataSize &&
+         entries_.CanInsert(GetSize(), key);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsLast(const KeyType &key, const KeyComparator &comparator) {
-  return ((comparator(array_[GetSize()-1].first, key) < 0 && next_page_id_ == INVALID_PAGE_ID) ||
-          (comparator(array_[0].first, key) < 0 && comparator(array_[GetSize()-1].first, key) > 0));
+  return ((comparator(KeyAt(GetSize() - 1), key) < 0 && next_page_id_ == INVALID_PAGE_ID) ||
+          (comparator(KeyAt(0), key) < 0 && comparator(KeyAt(GetSize() - 1), key) > 0));
+}
+
+/*
+ * An insert into this page can not split it
+ * Keys of variable length also need the space of the longest key, and of the
+ * prefix for every key in case the prefix becomes empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsInsertSafe() const {
+  if (GetSize() >= GetMaxSize())
+    return false;
+  if constexpr (Entries::kVariableLength) {
+    return entries_.GetFreeSpace(GetSize()) >= Entries::kMaxEntrySize + (GetSize() - 1) * entries_.GetPrefixSize();
+  }
+  return true;
+}
+
+/*
+ * A remove from this page can not make it underflow
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsRemoveSafe() const {
+  if constexpr (Entries::kVariableLength) {
+    return (entries_.GetUsedSpace(GetSize()) - Entries::kMaxEntrySize) * 2 >= Entries::kDataSize;
+  }
+  return GetSize() > GetMinSize();
+}
+
+/*
+ * A page underflows when it has fewer pairs than min size, or takes less than
+ * half of its space for keys of variable length
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderflow() const {
+  if constexpr (Entries::kVariableLength) {
+    return entries_.GetFreeSpace(GetSize()) * 2 > Entries::kDataSize;
+  }
+  return GetSize() < GetMinSize();
 }
 
 /*****************************************************************************
@@ -108,35 +181,35 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsLast(const KeyType &key, const KeyComparator
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * If key is not null, it is the key which did not fit into this page and is
+ * inserted into one of both pages afterwards. A key without the prefix of the
+ * page is smaller or greater than all keys of the page, it gets a page of its
+ * own so that the prefix of the others is kept.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient, const KeyType *key,
+                                            const KeyComparator &comparator) {
   recipient->SetNextPageId(next_page_id_);
-  int size;
-  //大小设置为一半
-  if (GetSize() % 2)
-    size = GetSize() / 2;
-  else
-   size = GetSize() / 2 + 1;
-  //拷贝
-  for (int i = size+recipient->GetSize(); i >= 0; i--) {
-    if (i > size)
-      recipient->array_[i] = recipient->array_[i - size];
-    else
-      recipient->array_[i] = array_[i + size];
+  //留下一半，后一半移到 recipient 的前面，变长的 key 按字节数对半分
+  int keep = entries_.SplitPoint(GetSize());
+  if constexpr (Entries::kVariableLength) {
+    if (key && !entries_.HasPrefix(*key))
+      keep = comparator(*key, KeyAt(0)) < 0 ? 0 : GetSize();
   }
-  SetSize(GetSize() / 2);
-  recipient->SetSize(size+recipient->GetSize()+1);
+  std::vector<MappingType> items = entries_.Items(GetSize());
+  std::vector<MappingType> moved = recipient->entries_.Items(recipient->GetSize());
+  moved.insert(moved.begin(), items.begin() + keep, items.end());
+  recipient->CopyNFrom(moved.data(), static_cast<int>(moved.size()));
+  CopyNFrom(items.data(), keep);
 }
 
 /*
  * Copy starting from items, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
-  for (int i = 0; i < size; i++) {
-    array_[i] = items[i];
-  }
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
+  bool assigned = entries_.Assign(items, size);
+  ASSERT(assigned, "Items do not fit into the leaf page.");
   SetSize(size);
 }
 
@@ -152,8 +225,8 @@ INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, const KeyComparator &comparator, int& index) const {
   index = KeyIndex(key, comparator);
   //运用比较器比较键值
-  if (index < GetSize() && comparator(array_[index].first, key) == 0) {
-    value = array_[index].second;
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    value = entries_.ValueAt(index);
     return true;
   }
   return false;
@@ -171,11 +244,9 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, co
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
   int index = KeyIndex(key, comparator);
-  if (index < GetSize() && comparator(array_[index].first, key) == 0) { //找到了
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) { //找到了
     //删除，后面前移
-    for (int i = index; i < GetSize() - 1; i++) {
-      array_[i] = array_[i + 1];
-    }
+    entries_.Remove(GetSize(), index);
     SetSize(GetSize() - 1);
   }
   return GetSize();
@@ -184,6 +255,23 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
+/*
+ * Whether all key & value pairs of this page fit into "recipient" page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanMoveAllTo(const BPlusTreeLeafPage *recipient) const {
+  if (GetSize() + recipient->GetSize() > recipient->GetMaxSize())
+    return false;
+  if constexpr (Entries::kVariableLength) {
+    std::vector<MappingType> items = recipient->entries_.Items(recipient->GetSize());
+    std::vector<MappingType> moved = entries_.Items(GetSize());
+    items.insert(items.end(), moved.begin(), moved.end());
+    int prefix;
+    return Entries::GetSpace(items.data(), static_cast<int>(items.size()), prefix) <= Entries::kDataSize;
+  }
+  return true;
+}
+
 /*
  * Remove all of key & value pairs from this page to "recipient" page. Don't forget
  * to update the next_page id in the sibling page
@@ -192,12 +280,12 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
   recipient->SetNextPageId(GetNextPageId());
   //追加
-  for (int i = 0; i < GetSize(); i++) {
-    recipient->array_[i + recipient->GetSize()] = array_[i];
-  }
-  //更新大小
-  recipient->SetSize(GetSize() + recipient->GetSize());
+  std::vector<MappingType> items = recipient->entries_.Items(recipient->GetSize());
+  std::vector<MappingType> moved = entries_.Items(GetSize());
+  items.insert(items.end(), moved.begin(), moved.end());
+  recipient->CopyNFrom(items.data(), static_cast<int>(items.size()));
   SetSize(0);
+  entries_.Init();
 }
 
 /*****************************************************************************
@@ -209,13 +297,9 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
-  //赋值
-  recipient->array_[recipient->GetSize()] = array_[0];
-  recipient->SetSize(recipient->GetSize() + 1);
+  recipient->CopyLastFrom(GetItem(0));
   //覆盖
-  for (int i = 0; i < GetSize() - 1; i++) {
-    array_[i] = array_[i + 1];
-  }
+  entries_.Remove(GetSize(), 0);
   SetSize(GetSize() - 1);
 }
 
@@ -224,8 +308,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  array_[GetSize()] = item;
-  SetSize(GetSize() + 1);
+  bool inserted = Append(item.first, item.second);
+  ASSERT(inserted, "Item does not fit into the leaf page.");
 }
 
 /*
@@ -233,11 +317,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
-  for (int i = recipient->GetSize(); i > 0; i--) {
-    recipient->array_[i] = recipient->array_[i - 1];
-  }
-  recipient->array_[0] = array_[GetSize() - 1]; //拷贝
-  recipient->SetSize(recipient->GetSize() + 1);
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1)); //拷贝
+  entries_.Remove(GetSize(), GetSize() - 1);
   SetSize(GetSize() - 1);
 }
 
@@ -247,13 +328,20 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
-  for (int i = GetSize(); i > 0; i--) {
-    array_[i] = array_[i - 1];
-  }
-  array_[0] = item; //赋值
+  bool inserted = entries_.Insert(GetSize(), 0, item.first, item.second);
+  ASSERT(inserted, "Item does not fit into the leaf page.");
   SetSize(GetSize() + 1);
 }
 
+/*
+ * Suffix truncation of the key between two leaves, the shortest key greater
+ * than left and not greater than right for keys of variable length
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::Separator(const KeyType &left, const KeyType &right) {
+  return Entries::Separator(left, right);
+}
+
 template
 class BPlusTreeLeafPage<int, int, BasicComparator<int>>;
 
@@ -271,3 +359,15 @@ class BPlusTreeLeafPage<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
 class BPlusTreeLeafPage<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTreeLeafPage<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTreeLeafPage<GenericKey<256>, RowId, GenericComparator<256>>;
+
+template
+class BPlusTreeLeafPage<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>>;
+
+template
+class BPlusTreeLeafPage<IntegerKey<int64_t>, RowId, IntegerComparator<int64_t>>;
@@ -0,0 +1,258 @@
+#include "page/pax_page.h"
+
+PaxLayout::PaxLayout(const Schema *schema) {
+  uint32_t row_width = 0;
+  for (auto column : schema->GetColumns()) {
+    types_.push_back(column->GetType());
+    // char 需要额外 2 字节记录实际长度
+    uint32_t width = Type::IsCharType(column->GetType()) ? sizeof(uint16_t) + column->GetLength()
+                                                            : Type::GetTypeSize(column->GetType());
+    widths_.push_back(width);
+    row_width += width;
+  }
+  null_offsets_.resize(types_.size());
+  data_offsets_.resize(types_.size());
+  // 每个元组在 live, mark 以及每列的 null bitmap 中各占 1 bit
+  uint32_t bits_per_row = row_width * 8 + 2 + GetColumnCount();
+  uint32_t capacity = (PAGE_SIZE - PaxPage::SIZE_PAX_PAGE_HEADER) * 8 / bits_per_row;
+  while (capacity > 0 && GetPageSize(capacity) > PAGE_SIZE) {
+    capacity--;
+  }
+  capacity_ = capacity;
+  if (capacity_ == 0) {
+    return;
+  }
+  uint32_t offset = PaxPage::SIZE_PAX_PAGE_HEADER;
+  live_bitmap_offset_ = offset;
+  offset += BitmapSize(capacity_);
+  mark_bitmap_offset_ = offset;
+  offset += BitmapSize(capacity_);
+  for (uint32_t i = 0; i < GetColumnCount(); i++) {
+    null_offsets_[i] = offset;
+    offset += BitmapSize(capacity_);
+    data_offsets_[i] = offset;
+    offset += Align(capacity_ * widths_[i]);
+  }
+  ASSERT(offset <= PAGE_SIZE, "Pax page overflow.");
+}
+
+uint32_t PaxLayout::GetPageSize(uint32_t capacity) const {
+  uint32_t size = PaxPage::SIZE_PAX_PAGE_HEADER + 2 * BitmapSize(capacity);
+  for (auto width : widths_) {
+    size += BitmapSize(capacity) + Align(capacity * width);
+  }
+  return size;
+}
+
+bool PaxLayout::Fits(const Row &row) const {
+  if (row.GetFieldCount() != GetColumnCount()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < GetColumnCount(); i++) {
+    auto field = row.GetField(i);
+    if (Type::IsCharType(types_[i]) && !field->IsNull() &&
+        field->GetLength() > widths_[i] - sizeof(uint16_t)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn) {
+  memset(GetData(), 0, PAGE_SIZE);
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetPrevPageId(prev_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetSlotCount(0);
+  SetLiveCount(0);
+}
+
+bool PaxPage::IsVisible(const PaxLayout &layout, uint32_t slot_num) {
+  return slot_num < GetSlotCount() && TestBit(GetBitmap(layout.live_bitmap_offset_), slot_num) &&
+         !TestBit(GetBitmap(layout.mark_bitmap_offset_), slot_num);
+}
+
+uint32_t PaxPage::FindVisibleSlot(const PaxLayout &layout, uint32_t slot_num) {
+  uint32_t slot_count = GetSlotCount();
+  auto live = GetBitmap(layout.live_bitmap_offset_);
+  auto mark = GetBitmap(layout.mark_bitmap_offset_);
+  // 按 64 位一组查找，跳过整组不可见的元组
+  for (uint32_t word = slot_num / 64; word * 64 < slot_count; word++) {
+    uint64_t bits = live[word] & ~mark[word];
+    if (word == slot_num / 64) {
+      bits &= ~0ULL << (slot_num % 64);
+    }
+    if (bits != 0) {
+      uint32_t slot = word * 64 + __builtin_ctzll(bits);
+      return slot < slot_count ? slot : slot_count;
+    }
+  }
+  return slot_count;
+}
+
+void PaxPage::WriteTuple(const Row &row, uint32_t slot_num, const PaxLayout &layout) {
+  for (uint32_t i = 0; i < layout.GetColumnCount(); i++) {
+    auto field = row.GetField(i);
+    auto null_bitmap = GetBitmap(layout.null_offsets_[i]);
+    char *value = GetData() + layout.data_offsets_[i] + slot_num * layout.widths_[i];
+    memset(value, 0, layout.widths_[i]);
+    if (field->IsNull()) {
+      SetBit(null_bitmap, slot_num);
+      continue;
+    }
+    ClearBit(null_bitmap, slot_num);
+    if (Type::IsCharType(layout.types_[i])) {
+      auto len = static_cast<uint16_t>(field->GetLength());
+      MACH_WRITE_TO(uint16_t, value, len);
+      memcpy(value + sizeof(uint16_t), field->GetData(), len);
+    } else {
+      field->SerializeTo(value);
+    }
+  }
+}
+
+void PaxPage::ReadField(uint32_t slot_num, uint32_t column_idx, const PaxLayout &layout, Field &field,
+                        bool manage_data) {
+  auto type = layout.types_[column_idx];
+  if (TestBit(GetBitmap(layout.null_offsets_[column_idx]), slot_num)) {
+    Field value(type);
+    field = value;
+    return;
+  }
+  char *value = GetData() + layout.data_offsets_[column_idx] + slot_num * layout.widths_[column_idx];
+  if (type == TypeId::kTypeInt || type == TypeId::kTypeDate) {
+    Field tmp(type, MACH_READ_FROM(int32_t, value));
+    field = tmp;
+  } else if (type == TypeId::kTypeFloat) {
+    Field tmp(type, MACH_READ_FROM(float, value));
+    field = tmp;
+  } else if (type == TypeId::kTypeBigInt || type == TypeId::kTypeTimestamp) {
+    Field tmp(type, MACH_READ_FROM(int64_t, value));
+    field = tmp;
+  } else if (type == TypeId::kTypeDouble) {
+    Field tmp(type, MACH_READ_FROM(double, value));
+    field = tmp;
+  } else {
+    uint16_t len = MACH_READ_FROM(uint16_t, value);
+    Field tmp(type, value + sizeof(uint16_t), len, manage_data);
+    field = tmp;
+  }
+}
+
+bool PaxPage::InsertTuple(Row &row, const PaxLayout &layout, Transaction *txn, LockManager *lock_manager,
+                          LogManager *log_manager) {
+  ASSERT(layout.GetCapacity() > 0, "Tuple is too large for pax page.");
+  if (!layout.Fits(row)) {
+    return false;
+  }
+  uint32_t slot_count = GetSlotCount();
+  auto live = GetBitmap(layout.live_bitmap_offset_);
+  // 优先复用已删除的 slot
+  uint32_t slot = slot_count;
+  for (uint32_t word = 0; word * 64 < slot_count; word++) {
+    if (~live[word] != 0) {
+      slot = word * 64 + __builtin_ctzll(~live[word]);
+      break;
+    }
+  }
+  if (slot >= slot_count) {
+    if (slot_count >= layout.GetCapacity()) {
+      return false;
+    }
+    slot = slot_count;
+    SetSlotCount(slot_count + 1);
+  }
+  WriteTuple(row, slot, layout);
+  SetBit(live, slot);
+  ClearBit(GetBitmap(layout.mark_bitmap_offset_), slot);
+  SetLiveCount(GetLiveCount() + 1);
+  row.SetRowId(RowId(GetTablePageId(), slot));
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RowId &rid, const PaxLayout &layout, Transaction *txn, LockManager *lock_manager,
+                         LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (!IsVisible(layout, slot_num)) {
+    return false;
+  }
+  SetBit(GetBitmap(layout.mark_bitmap_offset_), slot_num);
+  return true;
+}
+
+bool PaxPage::UpdateTuple(const Row &new_row, const RowId &rid, const PaxLayout &layout, Transaction *txn,
+                          LockManager *lock_manager, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (!IsVisible(layout, slot_num) || !layout.Fits(new_row)) {
+    return false;
+  }
+  WriteTuple(new_row, slot_num, layout);
+  return true;
+}
+
+void PaxPage::ApplyDelete(const RowId &rid, const PaxLayout &layout, Transaction *txn, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetSlotCount(), "Cannot have more slots than tuples.");
+  auto live = GetBitmap(layout.live_bitmap_offset_);
+  if (!TestBit(live, slot_num)) {
+    return;
+  }
+  ClearBit(live, slot_num);
+  ClearBit(GetBitmap(layout.mark_bitmap_offset_), slot_num);
+  SetLiveCount(GetLiveCount() - 1);
+  // 末尾的空 slot 直接收缩
+  uint32_t slot_count = GetSlotCount();
+  while (slot_count > 0 && !TestBit(live, slot_count - 1)) {
+    slot_count--;
+  }
+  SetSlotCount(slot_count);
+}
+
+void PaxPage::RollbackDelete(const RowId &rid, const PaxLayout &layout, Transaction *txn, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetSlotCount(), "We can't have more slots than tuples.");
+  ClearBit(GetBitmap(layout.mark_bitmap_offset_), slot_num);
+}
+
+bool PaxPage::GetTuple(Row *row, const PaxLayout &layout, Transaction *txn, LockManager *lock_manager) {
+  ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
+  uint32_t slot_num = row->GetRowId().GetSlotNum();
+  if (!IsVisible(layout, slot_num)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < layout.GetColumnCount(); i++) {
+    Field field(layout.types_[i]);
+    ReadField(slot_num, i, layout, field, true);
+    row->AppendField(field);
+  }
+  return true;
+}
+
+bool PaxPage::GetField(const RowId &rid, uint32_t column_idx, const PaxLayout &layout, Field &field) {
+  if (!IsVisible(layout, rid.GetSlotNum()) || column_idx >= layout.GetColumnCount()) {
+    return false;
+  }
+  ReadField(rid.GetSlotNum(), column_idx, layout, field, false);
+  return true;
+}
+
+bool PaxPage::GetFirstTupleRid(const PaxLayout &layout, RowId *first_rid) {
+  uint32_t slot = FindVisibleSlot(layout, 0);
+  if (slot < GetSlotCount()) {
+    first_rid->Set(GetTablePageId(), slot);
+    return true;
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const PaxLayout &layout, const RowId &cur_rid, RowId *next_rid) {
+  ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  uint32_t slot = FindVisibleSlot(layout, cur_rid.GetSlotNum() + 1);
+  if (slot < GetSlotCount()) {
+    next_rid->Set(GetTablePageId(), slot);
+    return true;
+  }
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
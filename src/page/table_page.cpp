@@ -6,25 +6,16 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr,
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(PAGE_SIZE);
   SetTupleCount(0);
+  memset(GetSlotBitmap(), 0, SIZE_SLOT_BITMAP);
 }
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn,
                             LockManager *lock_manager, LogManager *log_manager) {
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-    return false;
-  }
-  // Try to find a free slot to reuse.
-  uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
-    // If the slot is empty, i.e. its tuple has size 0,
-    if (GetTupleSize(i) == 0) {
-      // Then we break out of the loop at index i.
-      break;
-    }
-  }
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+  // Try to find a free slot to reuse, a reused slot needs no extra space in the slot array.
+  uint32_t i = FindFreeSlot();
+  if (GetFreeSpaceRemaining() < serialized_size + (i == GetTupleCount() ? SIZE_TUPLE : 0)) {
     return false;
   }
   // Otherwise we claim available free space..
@@ -35,6 +26,7 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn,
   // Set the tuple.
   SetTupleOffsetAtSlot(i, GetFreeSpacePointer());
   SetTupleSize(i, serialized_size);
+  SetSlotUsed(i, true);
   // Set rid
   row.SetRowId(RowId(GetTablePageId(), i));
   if (i == GetTupleCount()) {
@@ -124,6 +116,7 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
   SetFreeSpacePointer(free_space_pointer + tuple_size);
   SetTupleSize(slot_num, 0);
   SetTupleOffsetAtSlot(slot_num, 0);
+  SetSlotUsed(slot_num, false);
 
   // Update all tuple offsets.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
@@ -166,9 +159,18 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
   return true;
 }
 
+bool TablePage::GetField(const RowId &rid, uint32_t column_idx, Schema *schema, Field &field) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num)) || column_idx >= schema->GetColumnCount()) {
+    return false;
+  }
+  schema->GetRowCodec().DecodeField(GetData() + GetTupleOffsetAtSlot(slot_num), column_idx, field, false);
+  return true;
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
-  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+  for (uint32_t i = FindUsedSlot(0); i < GetTupleCount(); i = FindUsedSlot(i + 1)) {
     if (!IsDeleted(GetTupleSize(i))) {
       first_rid->Set(GetTablePageId(), i);
       return true;
@@ -181,7 +183,7 @@ bool TablePage::GetFirstTupleRid(RowId *first_rid) {
 bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
-  for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
+  for (auto i = FindUsedSlot(cur_rid.GetSlotNum() + 1); i < GetTupleCount(); i = FindUsedSlot(i + 1)) {
     if (!IsDeleted(GetTupleSize(i))) {
       next_rid->Set(GetTablePageId(), i);
       return true;
@@ -191,3 +193,33 @@ bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+uint32_t TablePage::FindFreeSlot() {
+  uint32_t tuple_count = GetTupleCount();
+  auto bitmap = GetSlotBitmap();
+  // 按 64 位一组查找第一个未使用的 slot
+  for (uint32_t word = 0; word * 64 < tuple_count; word++) {
+    uint64_t free_bits = ~bitmap[word];
+    if (free_bits != 0) {
+      uint32_t slot = word * 64 + __builtin_ctzll(free_bits);
+      return slot < tuple_count ? slot : tuple_count;
+    }
+  }
+  return tuple_count;
+}
+
+uint32_t TablePage::FindUsedSlot(uint32_t slot_num) {
+  uint32_t tuple_count = GetTupleCount();
+  auto bitmap = GetSlotBitmap();
+  for (uint32_t word = slot_num / 64; word * 64 < tuple_count; word++) {
+    uint64_t used_bits = bitmap[word];
+    if (word == slot_num / 64) {
+      used_bits &= ~0ULL << (slot_num % 64);
+    }
+    if (used_bits != 0) {
+      uint32_t slot = word * 64 + __builtin_ctzll(used_bits);
+      return slot < tuple_count ? slot : tuple_count;
+    }
+  }
+  return tuple_count;
+}
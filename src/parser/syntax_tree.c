@@ -169,6 +169,12 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeTableOptions:
+      return "kNodeTableOptions";
+    case kNodeTableOption:
+      return "kNodeTableOption";
+    case kNodeCheckDB:
+      return "kNodeCheckDB";
     default:
       return "error type";
   }
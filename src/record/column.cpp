@@ -3,7 +3,7 @@
 Column::Column(std::string column_name, TypeId type, uint32_t index, bool nullable, bool unique)
         : name_(std::move(column_name)), type_(type), table_ind_(index),
           nullable_(nullable), unique_(unique) {
-  ASSERT(type != TypeId::kTypeChar, "Wrong constructor for CHAR type.");
+  ASSERT(!Type::IsCharType(type), "Wrong constructor for CHAR type.");
   switch (type) {
     case TypeId::kTypeInt :
       len_ = sizeof(int32_t);
@@ -11,6 +11,12 @@ Column::Column(std::string column_name, TypeId type, uint32_t index, bool nullab
     case TypeId::kTypeFloat :
       len_ = sizeof(float_t);
       break;
+    case TypeId::kTypeBigInt :
+    case TypeId::kTypeDouble :
+    case TypeId::kTypeDate :
+    case TypeId::kTypeTimestamp :
+      len_ = Type::GetTypeSize(type);
+      break;
     default:
       ASSERT(false, "Unsupported column type.");
   }
@@ -19,7 +25,7 @@ Column::Column(std::string column_name, TypeId type, uint32_t index, bool nullab
 Column::Column(std::string column_name, TypeId type, uint32_t length, uint32_t index, bool nullable, bool unique)
         : name_(std::move(column_name)), type_(type), len_(length),
           table_ind_(index), nullable_(nullable), unique_(unique) {
-  ASSERT(type == TypeId::kTypeChar, "Wrong constructor for non-VARCHAR type.");
+  ASSERT(Type::IsCharType(type), "Wrong constructor for non-VARCHAR type.");
 }
 
 Column::Column(const Column *other) : name_(other->name_), type_(other->type_), len_(other->len_),
@@ -75,7 +81,7 @@ uint32_t Column::DeserializeFrom(char *buf, Column *&column, MemHeap *heap) {
   bool unique = MACH_READ_FROM(bool, buf+offset);
   offset += sizeof(bool);//反序列化是否column为独一的
   void *mem = heap->Allocate(sizeof(Column));
-  if (type == TypeId::kTypeChar)//将Column中反序列化出的各种属性赋值到新的column
+  if (Type::IsCharType(type))//将Column中反序列化出的各种属性赋值到新的column
     column = new (mem)Column(name, type, len, table_ind, nullable, unique);
   else
     column = new (mem)Column(name, type, table_ind, nullable, unique);
@@ -0,0 +1,56 @@
+#include "record/dictionary.h"
+
+#include <cstring>
+
+uint32_t Dictionary::Find(const char *value, uint32_t len) const {
+  auto iter = codes_.find(std::string(value, len));
+  return iter == codes_.end() ? INVALID_CODE : iter->second;
+}
+
+uint32_t Dictionary::Insert(const char *value, uint32_t len, bool &inserted) {
+  auto result = codes_.emplace(std::string(value, len), GetSize());
+  inserted = result.second;
+  if (inserted) {
+    chars_.insert(chars_.end(), value, value + len);
+    offsets_.push_back(static_cast<uint32_t>(chars_.size()));
+  }
+  return result.first->second;
+}
+
+uint32_t Dictionary::SerializeTo(char *buf) const {
+  MACH_WRITE_UINT32(buf, DICTIONARY_MAGIC_NUM);
+  uint32_t offset = sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf + offset, GetSize());
+  offset += sizeof(uint32_t);
+  MACH_WRITE_UINT32(buf + offset, static_cast<uint32_t>(chars_.size()));
+  offset += sizeof(uint32_t);
+  // 第一个偏移总是 0，不需要保存
+  memcpy(buf + offset, offsets_.data() + 1, GetSize() * sizeof(uint32_t));
+  offset += GetSize() * sizeof(uint32_t);
+  memcpy(buf + offset, chars_.data(), chars_.size());
+  offset += chars_.size();
+  return offset;
+}
+
+uint32_t Dictionary::GetSerializedSize() const {
+  return 3 * sizeof(uint32_t) + GetSize() * sizeof(uint32_t) + static_cast<uint32_t>(chars_.size());
+}
+
+uint32_t Dictionary::DeserializeFrom(char *buf, Dictionary &dictionary) {
+  ASSERT(MACH_READ_UINT32(buf) == DICTIONARY_MAGIC_NUM, "Invalid dictionary.");
+  uint32_t offset = sizeof(uint32_t);
+  uint32_t count = MACH_READ_UINT32(buf + offset);
+  offset += sizeof(uint32_t);
+  uint32_t chars_size = MACH_READ_UINT32(buf + offset);
+  offset += sizeof(uint32_t);
+  dictionary.offsets_.resize(count + 1);
+  memcpy(dictionary.offsets_.data() + 1, buf + offset, count * sizeof(uint32_t));
+  offset += count * sizeof(uint32_t);
+  dictionary.chars_.assign(buf + offset, buf + offset + chars_size);
+  offset += chars_size;
+  dictionary.codes_.clear();
+  for (uint32_t code = 0; code < count; code++) {
+    dictionary.codes_.emplace(std::string(dictionary.GetValue(code), dictionary.GetLength(code)), code);
+  }
+  return offset;
+}
@@ -0,0 +1,415 @@
+#include <algorithm>
+#include <cstring>
+
+#include "record/predicate_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PREDICATE_KERNELS_X86
+#endif
+
+// 定长 char 的 SIMD 比较支持的最大长度
+static constexpr uint32_t MAX_SIMD_CHAR_WIDTH = 256;
+
+CompareOp ParseCompareOp(const char *op) {
+  if (strcmp(op, "=") == 0) {
+    return CompareOp::kEqual;
+  } else if (strcmp(op, "<>") == 0) {
+    return CompareOp::kNotEqual;
+  } else if (strcmp(op, "<") == 0) {
+    return CompareOp::kLessThan;
+  } else if (strcmp(op, "<=") == 0) {
+    return CompareOp::kLessThanEqual;
+  } else if (strcmp(op, ">") == 0) {
+    return CompareOp::kGreaterThan;
+  } else if (strcmp(op, ">=") == 0) {
+    return CompareOp::kGreaterThanEqual;
+  } else if (strcmp(op, "is") == 0) {
+    return CompareOp::kIsNull;
+  } else if (strcmp(op, "not") == 0) {
+    return CompareOp::kNotNull;
+  }
+  return CompareOp::kInvalid;
+}
+
+// ==============================Scalar=============================
+
+template<typename T, typename Cmp>
+static void FilterScalar(const T *values, uint32_t count, Cmp cmp, uint64_t *matches) {
+  for (uint32_t word = 0; word * 64 < count; word++) {
+    uint32_t n = std::min<uint32_t>(64, count - word * 64);
+    const T *base = values + word * 64;
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      bits |= static_cast<uint64_t>(cmp(base[i])) << i;
+    }
+    matches[word] = bits;
+  }
+}
+
+template<typename T>
+static void FilterScalar(const T *values, uint32_t count, CompareOp op, T operand, uint64_t *matches) {
+  switch (op) {
+    case CompareOp::kEqual:
+      return FilterScalar(values, count, [operand](T v) { return v == operand; }, matches);
+    case CompareOp::kNotEqual:
+      return FilterScalar(values, count, [operand](T v) { return v != operand; }, matches);
+    case CompareOp::kLessThan:
+      return FilterScalar(values, count, [operand](T v) { return v < operand; }, matches);
+    case CompareOp::kLessThanEqual:
+      return FilterScalar(values, count, [operand](T v) { return v <= operand; }, matches);
+    case CompareOp::kGreaterThan:
+      return FilterScalar(values, count, [operand](T v) { return v > operand; }, matches);
+    case CompareOp::kGreaterThanEqual:
+      return FilterScalar(values, count, [operand](T v) { return v >= operand; }, matches);
+    default:
+      memset(matches, 0, (count + 63) / 64 * sizeof(uint64_t));
+  }
+}
+
+static inline bool MatchCompare(int cmp, CompareOp op) {
+  switch (op) {
+    case CompareOp::kEqual:
+      return cmp == 0;
+    case CompareOp::kNotEqual:
+      return cmp != 0;
+    case CompareOp::kLessThan:
+      return cmp < 0;
+    case CompareOp::kLessThanEqual:
+      return cmp <= 0;
+    case CompareOp::kGreaterThan:
+      return cmp > 0;
+    case CompareOp::kGreaterThanEqual:
+      return cmp >= 0;
+    default:
+      return false;
+  }
+}
+
+/**
+ * 前 8 个字节按大端序组成的整数，不足 8 字节的部分补 0，整数的大小关系与字符串前缀的大小关系一致
+ */
+static inline uint64_t CharPrefix(const char *str, uint32_t len) {
+  uint64_t prefix = 0;
+  memcpy(&prefix, str, std::min<uint32_t>(len, sizeof(uint64_t)));
+  return __builtin_bswap64(prefix);
+}
+
+/**
+ * 与 TypeChar 的比较规则一致：先比较公共前缀，再比较长度。大多数情况下比较前缀整数即可得到结果
+ */
+static inline int CompareChars(const char *str, uint32_t len, const char *operand, uint32_t operand_len,
+                               uint64_t operand_prefix) {
+  uint64_t prefix = CharPrefix(str, len);
+  if (prefix != operand_prefix) {
+    return prefix < operand_prefix ? -1 : 1;
+  }
+  int ret = memcmp(str, operand, std::min(len, operand_len));
+  if (ret == 0 && len != operand_len) {
+    ret = len < operand_len ? -1 : 1;
+  }
+  return ret;
+}
+
+// ==============================AVX2=============================
+
+#ifdef PREDICATE_KERNELS_X86
+
+/**
+ * 整数只有相等和大于两种比较指令，其余运算符通过交换操作数或者对结果取反得到
+ */
+enum IntCompare { kIntEqual, kIntGreater, kIntLess };
+
+template<IntCompare CMP>
+__attribute__((target("avx2")))
+static uint32_t FilterInt32Avx2(const int32_t *values, uint32_t count, int32_t operand, bool negate,
+                                uint64_t *matches) {
+  __m256i rhs = _mm256_set1_epi32(operand);
+  uint32_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t bits = 0;
+    for (uint32_t j = 0; j < 64; j += 8) {
+      __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i + j));
+      __m256i cmp;
+      if (CMP == kIntEqual) {
+        cmp = _mm256_cmpeq_epi32(lhs, rhs);
+      } else if (CMP == kIntGreater) {
+        cmp = _mm256_cmpgt_epi32(lhs, rhs);
+      } else {
+        cmp = _mm256_cmpgt_epi32(rhs, lhs);
+      }
+      bits |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp)))) << j;
+    }
+    matches[i / 64] = negate ? ~bits : bits;
+  }
+  return i;
+}
+
+template<int PREDICATE>
+__attribute__((target("avx2")))
+static uint32_t FilterFloatAvx2(const float *values, uint32_t count, float operand, uint64_t *matches) {
+  __m256 rhs = _mm256_set1_ps(operand);
+  uint32_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t bits = 0;
+    for (uint32_t j = 0; j < 64; j += 8) {
+      __m256 cmp = _mm256_cmp_ps(_mm256_loadu_ps(values + i + j), rhs, PREDICATE);
+      bits |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_ps(cmp))) << j;
+    }
+    matches[i / 64] = bits;
+  }
+  return i;
+}
+
+/**
+ * 每个向量只有 4 个值，movemask_pd 取出 4 位
+ */
+template<IntCompare CMP>
+__attribute__((target("avx2")))
+static uint32_t FilterInt64Avx2(const int64_t *values, uint32_t count, int64_t operand, bool negate,
+                                uint64_t *matches) {
+  __m256i rhs = _mm256_set1_epi64x(operand);
+  uint32_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t bits = 0;
+    for (uint32_t j = 0; j < 64; j += 4) {
+      __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i + j));
+      __m256i cmp;
+      if (CMP == kIntEqual) {
+        cmp = _mm256_cmpeq_epi64(lhs, rhs);
+      } else if (CMP == kIntGreater) {
+        cmp = _mm256_cmpgt_epi64(lhs, rhs);
+      } else {
+        cmp = _mm256_cmpgt_epi64(rhs, lhs);
+      }
+      bits |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(cmp)))) << j;
+    }
+    matches[i / 64] = negate ? ~bits : bits;
+  }
+  return i;
+}
+
+template<int PREDICATE>
+__attribute__((target("avx2")))
+static uint32_t FilterDoubleAvx2(const double *values, uint32_t count, double operand, uint64_t *matches) {
+  __m256d rhs = _mm256_set1_pd(operand);
+  uint32_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    uint64_t bits = 0;
+    for (uint32_t j = 0; j < 64; j += 4) {
+      __m256d cmp = _mm256_cmp_pd(_mm256_loadu_pd(values + i + j), rhs, PREDICATE);
+      bits |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_pd(cmp))) << j;
+    }
+    matches[i / 64] = bits;
+  }
+  return i;
+}
+
+/**
+ * 定长 char 的相等比较，每个值与操作数按 32 字节一组比较
+ * @return 已经处理的值的个数，剩余的值读取 32 字节会越界，交给标量版本处理
+ */
+__attribute__((target("avx2")))
+static uint32_t FilterFixedCharsEqualAvx2(const char *values, uint32_t width, uint32_t count, const char *operand,
+                                          bool negate, uint64_t *matches) {
+  // 操作数补齐到 32 字节的整数倍
+  uint32_t chunks = (width + 31) / 32;
+  alignas(32) char padded[MAX_SIMD_CHAR_WIDTH];
+  memset(padded, 0, chunks * 32);
+  memcpy(padded, operand, width);
+  uint32_t tail_mask = width % 32 == 0 ? UINT32_MAX : (1U << (width % 32)) - 1;
+  uint64_t total = static_cast<uint64_t>(width) * count;
+  uint32_t i = 0;
+  for (; i < count && static_cast<uint64_t>(i) * width + chunks * 32 <= total; i++) {
+    const char *value = values + static_cast<size_t>(i) * width;
+    bool equal = true;
+    for (uint32_t c = 0; c < chunks && equal; c++) {
+      __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(value + c * 32));
+      __m256i rhs = _mm256_load_si256(reinterpret_cast<const __m256i *>(padded + c * 32));
+      uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhs, rhs)));
+      uint32_t want = c + 1 == chunks ? tail_mask : UINT32_MAX;
+      equal = (mask & want) == want;
+    }
+    if (i % 64 == 0) {
+      matches[i / 64] = 0;
+    }
+    matches[i / 64] |= static_cast<uint64_t>(equal != negate) << (i % 64);
+  }
+  return i;
+}
+
+#endif  // PREDICATE_KERNELS_X86
+
+// ==============================Dispatch=============================
+
+bool PredicateKernels::UseAvx2() {
+#ifdef PREDICATE_KERNELS_X86
+  static const bool use_avx2 = __builtin_cpu_supports("avx2");
+  return use_avx2;
+#else
+  return false;
+#endif
+}
+
+void PredicateKernels::FilterInt32(const int32_t *values, uint32_t count, CompareOp op, int32_t operand,
+                                   uint64_t *matches) {
+  uint32_t done = 0;
+#ifdef PREDICATE_KERNELS_X86
+  if (UseAvx2()) {
+    switch (op) {
+      case CompareOp::kEqual:
+      case CompareOp::kNotEqual:
+        done = FilterInt32Avx2<kIntEqual>(values, count, operand, op == CompareOp::kNotEqual, matches);
+        break;
+      case CompareOp::kGreaterThan:
+      case CompareOp::kLessThanEqual:
+        done = FilterInt32Avx2<kIntGreater>(values, count, operand, op == CompareOp::kLessThanEqual, matches);
+        break;
+      case CompareOp::kLessThan:
+      case CompareOp::kGreaterThanEqual:
+        done = FilterInt32Avx2<kIntLess>(values, count, operand, op == CompareOp::kGreaterThanEqual, matches);
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+  if (done < count) {
+    FilterScalar(values + done, count - done, op, operand, matches + done / 64);
+  }
+}
+
+void PredicateKernels::FilterFloat(const float *values, uint32_t count, CompareOp op, float operand,
+                                   uint64_t *matches) {
+  uint32_t done = 0;
+#ifdef PREDICATE_KERNELS_X86
+  if (UseAvx2()) {
+    // 与标量比较对 NaN 的处理一致：只有不等于在无序时成立
+    switch (op) {
+      case CompareOp::kEqual:
+        done = FilterFloatAvx2<_CMP_EQ_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kNotEqual:
+        done = FilterFloatAvx2<_CMP_NEQ_UQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kLessThan:
+        done = FilterFloatAvx2<_CMP_LT_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kLessThanEqual:
+        done = FilterFloatAvx2<_CMP_LE_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kGreaterThan:
+        done = FilterFloatAvx2<_CMP_GT_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kGreaterThanEqual:
+        done = FilterFloatAvx2<_CMP_GE_OQ>(values, count, operand, matches);
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+  if (done < count) {
+    FilterScalar(values + done, count - done, op, operand, matches + done / 64);
+  }
+}
+
+void PredicateKernels::FilterInt64(const int64_t *values, uint32_t count, CompareOp op, int64_t operand,
+                                   uint64_t *matches) {
+  uint32_t done = 0;
+#ifdef PREDICATE_KERNELS_X86
+  if (UseAvx2()) {
+    switch (op) {
+      case CompareOp::kEqual:
+      case CompareOp::kNotEqual:
+        done = FilterInt64Avx2<kIntEqual>(values, count, operand, op == CompareOp::kNotEqual, matches);
+        break;
+      case CompareOp::kGreaterThan:
+      case CompareOp::kLessThanEqual:
+        done = FilterInt64Avx2<kIntGreater>(values, count, operand, op == CompareOp::kLessThanEqual, matches);
+        break;
+      case CompareOp::kLessThan:
+      case CompareOp::kGreaterThanEqual:
+        done = FilterInt64Avx2<kIntLess>(values, count, operand, op == CompareOp::kGreaterThanEqual, matches);
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+  if (done < count) {
+    FilterScalar(values + done, count - done, op, operand, matches + done / 64);
+  }
+}
+
+void PredicateKernels::FilterDouble(const double *values, uint32_t count, CompareOp op, double operand,
+                                    uint64_t *matches) {
+  uint32_t done = 0;
+#ifdef PREDICATE_KERNELS_X86
+  if (UseAvx2()) {
+    switch (op) {
+      case CompareOp::kEqual:
+        done = FilterDoubleAvx2<_CMP_EQ_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kNotEqual:
+        done = FilterDoubleAvx2<_CMP_NEQ_UQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kLessThan:
+        done = FilterDoubleAvx2<_CMP_LT_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kLessThanEqual:
+        done = FilterDoubleAvx2<_CMP_LE_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kGreaterThan:
+        done = FilterDoubleAvx2<_CMP_GT_OQ>(values, count, operand, matches);
+        break;
+      case CompareOp::kGreaterThanEqual:
+        done = FilterDoubleAvx2<_CMP_GE_OQ>(values, count, operand, matches);
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+  if (done < count) {
+    FilterScalar(values + done, count - done, op, operand, matches + done / 64);
+  }
+}
+
+void PredicateKernels::FilterFixedChars(const char *values, uint32_t width, uint32_t count, CompareOp op,
+                                        const char *operand, uint32_t operand_len, uint64_t *matches) {
+  uint32_t done = 0;
+#ifdef PREDICATE_KERNELS_X86
+  if (UseAvx2() && width == operand_len && width > 0 && width <= MAX_SIMD_CHAR_WIDTH &&
+      (op == CompareOp::kEqual || op == CompareOp::kNotEqual)) {
+    done = FilterFixedCharsEqualAvx2(values, width, count, operand, op == CompareOp::kNotEqual, matches);
+  }
+#endif
+  uint64_t operand_prefix = CharPrefix(operand, operand_len);
+  for (uint32_t i = done; i < count; i++) {
+    if (i % 64 == 0) {
+      matches[i / 64] = 0;
+    }
+    const char *value = values + static_cast<size_t>(i) * width;
+    bool match = MatchCompare(CompareChars(value, width, operand, operand_len, operand_prefix), op);
+    matches[i / 64] |= static_cast<uint64_t>(match) << (i % 64);
+  }
+}
+
+void PredicateKernels::FilterChars(const char *chars, const uint32_t *offsets, uint32_t count, CompareOp op,
+                                   const char *operand, uint32_t operand_len, uint64_t *matches) {
+  uint64_t operand_prefix = CharPrefix(operand, operand_len);
+  memset(matches, 0, (count + 63) / 64 * sizeof(uint64_t));
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t len = offsets[i + 1] - offsets[i];
+    bool match;
+    if (op == CompareOp::kEqual || op == CompareOp::kNotEqual) {
+      // 长度不同时一定不相等，不需要比较内容
+      bool equal = len == operand_len && memcmp(chars + offsets[i], operand, len) == 0;
+      match = equal == (op == CompareOp::kEqual);
+    } else {
+      match = MatchCompare(CompareChars(chars + offsets[i], len, operand, operand_len, operand_prefix), op);
+    }
+    matches[i / 64] |= static_cast<uint64_t>(match) << (i % 64);
+  }
+}
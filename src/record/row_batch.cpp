@@ -0,0 +1,188 @@
+#include "record/row_batch.h"
+
+// ==============================ColumnVector=============================
+
+ColumnVector::ColumnVector(TypeId type) : type_(type) {
+  width_ = Type::GetTypeSize(type);
+  data_.resize(BATCH_SIZE * width_);
+  char_offsets_.reserve(BATCH_SIZE + 1);
+  Reset();
+}
+
+void ColumnVector::SetDictionary(const Dictionary *dictionary) {
+  ASSERT(Type::IsCharType(type_) && size_ == 0, "Dictionary of a non-empty column.");
+  if (dictionary_ == nullptr) {
+    width_ = sizeof(int32_t);
+    data_.resize(BATCH_SIZE * width_);
+  }
+  dictionary_ = dictionary;
+}
+
+void ColumnVector::Append(const Field &field) {
+  ASSERT(size_ < BATCH_SIZE, "Column vector is full.");
+  ASSERT(field.GetTypeId() == (dictionary_ ? TypeId::kTypeInt : type_), "Invalid type.");
+  uint32_t idx = size_++;
+  if (field.IsNull()) {
+    nulls_[idx / 64] |= 1ULL << (idx % 64);
+  }
+  if (!Type::IsCharType(type_) || dictionary_) {
+    if (!field.IsNull()) {
+      memcpy(data_.data() + idx * width_, &field.value_, width_);
+    }
+    return;
+  }
+  uint32_t len = field.IsNull() ? char_width_ : field.len_;
+  if (field.IsNull()) {
+    // null 也占用与其它值相同的空间，使定长 char 列的值保持等距
+    chars_.insert(chars_.end(), len, 0);
+  } else {
+    ASSERT(!field.IsToasted(), "Field must be detoasted.");
+    chars_.insert(chars_.end(), field.GetChars(), field.GetChars() + len);
+  }
+  char_offsets_.push_back(static_cast<uint32_t>(chars_.size()));
+  if (idx == 0) {
+    char_width_ = len;
+  } else if (len != char_width_) {
+    uniform_chars_ = false;
+  }
+}
+
+void ColumnVector::Filter(const char *op, const Field &operand, uint64_t *matches) const {
+  CompareOp compare_op = ParseCompareOp(op);
+  uint32_t words = (size_ + 63) / 64;
+  if (compare_op == CompareOp::kIsNull) {
+    memcpy(matches, nulls_, words * sizeof(uint64_t));
+    return;
+  }
+  // 与 null 比较的结果总是 null
+  if (operand.IsNull() || compare_op == CompareOp::kInvalid) {
+    memset(matches, 0, words * sizeof(uint64_t));
+    return;
+  }
+  if (compare_op == CompareOp::kNotNull) {
+    memset(matches, 0xff, words * sizeof(uint64_t));
+  } else if (dictionary_) {
+    ASSERT(Type::IsCharType(operand.GetTypeId()), "Not comparable.");
+    FilterCodes(compare_op, operand, matches);
+  } else {
+    ASSERT(operand.GetTypeId() == type_, "Not comparable.");
+    switch (type_) {
+      case TypeId::kTypeInt:
+      case TypeId::kTypeDate:
+        PredicateKernels::FilterInt32(GetInts(), size_, compare_op, operand.value_.integer_, matches);
+        break;
+      case TypeId::kTypeFloat:
+        PredicateKernels::FilterFloat(GetFloats(), size_, compare_op, operand.value_.float_, matches);
+        break;
+      case TypeId::kTypeBigInt:
+      case TypeId::kTypeTimestamp:
+        PredicateKernels::FilterInt64(GetBigInts(), size_, compare_op, operand.value_.bigint_, matches);
+        break;
+      case TypeId::kTypeDouble:
+        PredicateKernels::FilterDouble(GetDoubles(), size_, compare_op, operand.value_.double_, matches);
+        break;
+      case TypeId::kTypeChar:
+      case TypeId::kTypeVarchar:
+        if (uniform_chars_) {
+          PredicateKernels::FilterFixedChars(chars_.data(), char_width_, size_, compare_op, operand.GetChars(),
+                                             operand.len_, matches);
+        } else {
+          PredicateKernels::FilterChars(chars_.data(), char_offsets_.data(), size_, compare_op,
+                                        operand.GetChars(), operand.len_, matches);
+        }
+        break;
+      default:
+        ASSERT(false, "Unsupported type.");
+    }
+  }
+  // 去掉 null 以及末尾不存在的值
+  for (uint32_t i = 0; i < words; i++) {
+    matches[i] &= ~nulls_[i];
+  }
+  if (size_ % 64 != 0) {
+    matches[words - 1] &= (1ULL << (size_ % 64)) - 1;
+  }
+}
+
+void ColumnVector::FilterCodes(CompareOp op, const Field &operand, uint64_t *matches) const {
+  uint32_t words = (size_ + 63) / 64;
+  if (op == CompareOp::kEqual || op == CompareOp::kNotEqual) {
+    // 等值比较只需要比较编码
+    uint32_t code = dictionary_->Find(operand.GetChars(), operand.len_);
+    if (code == Dictionary::INVALID_CODE) {
+      memset(matches, op == CompareOp::kEqual ? 0 : 0xff, words * sizeof(uint64_t));
+    } else {
+      PredicateKernels::FilterInt32(GetInts(), size_, op, static_cast<int32_t>(code), matches);
+    }
+    return;
+  }
+  // 范围比较对字典中每个不同的值只求一次，再按编码查表
+  std::vector<uint64_t> code_matches((dictionary_->GetSize() + 63) / 64 + 1);
+  PredicateKernels::FilterChars(dictionary_->GetChars(), dictionary_->GetOffsets(), dictionary_->GetSize(), op,
+                                operand.GetChars(), operand.len_, code_matches.data());
+  memset(matches, 0, words * sizeof(uint64_t));
+  auto codes = GetInts();
+  for (uint32_t i = 0; i < size_; i++) {
+    auto code = static_cast<uint32_t>(codes[i]);
+    matches[i / 64] |= ((code_matches[code / 64] >> (code % 64)) & 1) << (i % 64);
+  }
+}
+
+void ColumnVector::Reset() {
+  size_ = 0;
+  memset(nulls_, 0, sizeof(nulls_));
+  char_offsets_.clear();
+  char_offsets_.push_back(0);
+  chars_.clear();
+  char_width_ = 0;
+  uniform_chars_ = true;
+}
+
+// ==============================RowBatch=============================
+
+RowBatch::RowBatch(const Schema *schema, std::vector<uint32_t> column_ids) : column_ids_(std::move(column_ids)) {
+  columns_.reserve(column_ids_.size());
+  for (auto column_id : column_ids_) {
+    columns_.emplace_back(schema->GetColumn(column_id)->GetType());
+  }
+  rids_.reserve(BATCH_SIZE);
+}
+
+void RowBatch::Append(const Row &row) {
+  ASSERT(!IsFull(), "Row batch is full.");
+  for (uint32_t i = 0; i < column_ids_.size(); i++) {
+    columns_[i].Append(*row.GetField(column_ids_[i]));
+  }
+  uint32_t idx = static_cast<uint32_t>(rids_.size());
+  selected_bits_[idx / 64] |= 1ULL << (idx % 64);
+  selection_[selected_count_++] = static_cast<uint16_t>(idx);
+  rids_.push_back(row.GetRowId());
+}
+
+void RowBatch::SetDictionary(uint32_t column_idx, const Dictionary *dictionary) {
+  columns_[column_idx].SetDictionary(dictionary);
+}
+
+void RowBatch::Filter(uint32_t column_idx, const char *op, const Field &operand) {
+  uint64_t matches[BATCH_SIZE / 64];
+  columns_[column_idx].Filter(op, operand, matches);
+  // 与当前的选择取交集后重建选择向量
+  selected_count_ = 0;
+  for (uint32_t word = 0; word * 64 < GetSize(); word++) {
+    uint64_t bits = selected_bits_[word] & matches[word];
+    selected_bits_[word] = bits;
+    while (bits != 0) {
+      selection_[selected_count_++] = static_cast<uint16_t>(word * 64 + __builtin_ctzll(bits));
+      bits &= bits - 1;
+    }
+  }
+}
+
+void RowBatch::Reset() {
+  for (auto &column : columns_) {
+    column.Reset();
+  }
+  rids_.clear();
+  memset(selected_bits_, 0, sizeof(selected_bits_));
+  selected_count_ = 0;
+}
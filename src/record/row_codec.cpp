@@ -0,0 +1,210 @@
+#include "record/row_codec.h"
+
+// 版本号最高位为 1，旧格式的首字节是第一个 field 的标记，取值不超过 2
+static constexpr uint8_t ROW_FORMAT_V1 = 0x81;
+static constexpr uint32_t OFFSET_NULL_BITMAP = sizeof(uint8_t);
+// 偏移表项的最高位表示 char 值存储在溢出页中
+static constexpr uint16_t CHAR_TOASTED = 0x8000;
+static constexpr uint16_t CHAR_OFFSET_MASK = 0x7fff;
+
+// 旧格式中每个 field 在头部占 1 字节：非空，空，或者值存储在溢出页中
+static constexpr uint8_t FIELD_INLINE = 0;
+static constexpr uint8_t FIELD_NULL = 1;
+static constexpr uint8_t FIELD_TOASTED = 2;
+
+static inline bool IsNullAt(const char *buf, uint32_t idx) {
+  return (MACH_READ_FROM(uint8_t, buf + OFFSET_NULL_BITMAP + idx / 8) >> (idx % 8)) & 1;
+}
+
+RowCodec::RowCodec(const std::vector<Column *> &columns) {
+  // 行头部为 1 字节版本号和每列 1 bit 的 null bitmap
+  uint32_t offset = sizeof(uint8_t) + (columns.size() + 7) / 8;
+  slots_.resize(columns.size());
+  // 定长的列依次排在头部之后
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    slots_[i].type_ = columns[i]->GetType();
+    if (!Type::IsCharType(slots_[i].type_)) {
+      slots_[i].offset_ = offset;
+      offset += Type::GetTypeSize(slots_[i].type_);
+    }
+  }
+  // 之后是 char 列的偏移表，每项 2 字节
+  uint32_t prev_entry = 0;
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    if (Type::IsCharType(slots_[i].type_)) {
+      slots_[i].offset_ = offset;
+      slots_[i].begin_offset_ = prev_entry;
+      prev_entry = offset;
+      offset += sizeof(uint16_t);
+      all_fixed_ = false;
+    }
+  }
+  fixed_size_ = offset;
+}
+
+template<bool ALL_FIXED>
+uint32_t RowCodec::EncodeRow(const std::vector<Field *> &fields, char *buf) const {
+  // null bitmap 以及空的定长值都填 0
+  memset(buf, 0, fixed_size_);
+  MACH_WRITE_TO(uint8_t, buf, ROW_FORMAT_V1);
+  uint32_t offset = fixed_size_;
+  for (uint32_t i = 0; i < slots_.size(); i++) {
+    const Slot &slot = slots_[i];
+    const Field *field = fields[i];
+    char *value = buf + slot.offset_;
+    if (field->is_null_) {
+      buf[OFFSET_NULL_BITMAP + i / 8] |= static_cast<char>(1 << (i % 8));
+    }
+    if (ALL_FIXED || !Type::IsCharType(slot.type_)) {
+      if (field->is_null_) {
+        continue;
+      }
+      switch (slot.type_) {
+        case TypeId::kTypeInt:
+        case TypeId::kTypeDate:
+          MACH_WRITE_TO(int32_t, value, field->value_.integer_);
+          break;
+        case TypeId::kTypeFloat:
+          MACH_WRITE_TO(float, value, field->value_.float_);
+          break;
+        case TypeId::kTypeBigInt:
+        case TypeId::kTypeTimestamp:
+          MACH_WRITE_TO(int64_t, value, field->value_.bigint_);
+          break;
+        case TypeId::kTypeDouble:
+          MACH_WRITE_TO(double, value, field->value_.double_);
+          break;
+        default:
+          ASSERT(false, "Unsupported type.");
+      }
+      continue;
+    }
+    if (!field->is_null_) {
+      memcpy(buf + offset, field->GetChars(), field->len_);
+      offset += field->len_;
+    }
+    ASSERT(offset <= CHAR_OFFSET_MASK, "Row too large.");
+    MACH_WRITE_TO(uint16_t, value, static_cast<uint16_t>(offset | (field->is_toasted_ ? CHAR_TOASTED : 0)));
+  }
+  return offset;
+}
+
+uint32_t RowCodec::Encode(const std::vector<Field *> &fields, char *buf) const {
+  if (fields.empty()) {
+    return 0;
+  }
+  ASSERT(fields.size() == slots_.size(), "field nums not match.");
+  return all_fixed_ ? EncodeRow<true>(fields, buf) : EncodeRow<false>(fields, buf);
+}
+
+Field *RowCodec::DecodeSlot(char *buf, uint32_t idx, MemHeap *heap, bool manage_data) const {
+  const Slot &slot = slots_[idx];
+  if (IsNullAt(buf, idx)) {
+    return ALLOC_P(heap, Field)(slot.type_);
+  }
+  char *value = buf + slot.offset_;
+  switch (slot.type_) {
+    case TypeId::kTypeInt:
+    case TypeId::kTypeDate:
+      return ALLOC_P(heap, Field)(slot.type_, MACH_READ_FROM(int32_t, value));
+    case TypeId::kTypeFloat:
+      return ALLOC_P(heap, Field)(slot.type_, MACH_READ_FROM(float, value));
+    case TypeId::kTypeBigInt:
+    case TypeId::kTypeTimestamp:
+      return ALLOC_P(heap, Field)(slot.type_, MACH_READ_FROM(int64_t, value));
+    case TypeId::kTypeDouble:
+      return ALLOC_P(heap, Field)(slot.type_, MACH_READ_FROM(double, value));
+    case TypeId::kTypeChar:
+    case TypeId::kTypeVarchar:
+      break;
+    default:
+      ASSERT(false, "Unsupported type.");
+  }
+  uint16_t entry = MACH_READ_FROM(uint16_t, value);
+  uint32_t begin = slot.begin_offset_ == 0 ? fixed_size_
+                                           : MACH_READ_FROM(uint16_t, buf + slot.begin_offset_) & CHAR_OFFSET_MASK;
+  uint32_t end = entry & CHAR_OFFSET_MASK;
+  if (entry & CHAR_TOASTED) {
+    ToastPointer pointer;
+    memcpy(&pointer, buf + begin, sizeof(ToastPointer));
+    return ALLOC_P(heap, Field)(slot.type_, pointer);
+  }
+  return ALLOC_P(heap, Field)(slot.type_, buf + begin, end - begin, manage_data);
+}
+
+template<bool ALL_FIXED>
+uint32_t RowCodec::DecodeRow(char *buf, std::vector<Field *> &fields, MemHeap *heap) const {
+  uint32_t size = fixed_size_;
+  for (uint32_t i = 0; i < slots_.size(); i++) {
+    fields.push_back(DecodeSlot(buf, i, heap, true));
+    if (!ALL_FIXED && Type::IsCharType(slots_[i].type_)) {
+      size = MACH_READ_FROM(uint16_t, buf + slots_[i].offset_) & CHAR_OFFSET_MASK;
+    }
+  }
+  return size;
+}
+
+uint32_t RowCodec::Decode(char *buf, std::vector<Field *> &fields, MemHeap *heap) const {
+  if (slots_.empty()) {
+    return 0;
+  }
+  if (MACH_READ_FROM(uint8_t, buf) != ROW_FORMAT_V1) {
+    return DecodeLegacy(buf, fields, heap);
+  }
+  fields.reserve(fields.size() + slots_.size());
+  return all_fixed_ ? DecodeRow<true>(buf, fields, heap) : DecodeRow<false>(buf, fields, heap);
+}
+
+void RowCodec::DecodeField(char *buf, uint32_t column_idx, Field &field, bool manage_data) const {
+  ASSERT(column_idx < slots_.size(), "Failed to access field");
+  alignas(std::max_align_t) char mem[FIELD_ARENA_SIZE];
+  ArenaMemHeap arena(mem, sizeof(mem));
+  if (MACH_READ_FROM(uint8_t, buf) != ROW_FORMAT_V1) {
+    // 旧格式只能顺序解码
+    std::vector<Field *> fields;
+    DecodeLegacy(buf, fields, &arena);
+    field = *fields[column_idx];
+    for (auto tmp : fields) {
+      tmp->~Field();
+    }
+    return;
+  }
+  Field *tmp = DecodeSlot(buf, column_idx, &arena, manage_data);
+  field = *tmp;
+  tmp->~Field();
+}
+
+uint32_t RowCodec::DecodeLegacy(char *buf, std::vector<Field *> &fields, MemHeap *heap) const {
+  uint32_t offset = slots_.size() * sizeof(uint8_t);
+  for (uint32_t i = 0; i < slots_.size(); i++) {
+    uint8_t flag = MACH_READ_FROM(uint8_t, buf + i);
+    if (flag == FIELD_TOASTED) {
+      // 行内只保存了指向溢出页的指针，按 char 的格式存储
+      ToastPointer pointer;
+      memcpy(&pointer, buf + offset + sizeof(uint32_t), sizeof(ToastPointer));
+      fields.push_back(ALLOC_P(heap, Field)(TypeId::kTypeChar, pointer));
+      offset += sizeof(uint32_t) + sizeof(ToastPointer);
+    } else {
+      Field *field = nullptr;
+      offset += Field::DeserializeFrom(buf + offset, slots_[i].type_, &field, flag == FIELD_NULL, heap);
+      fields.push_back(field);
+    }
+  }
+  return offset;
+}
+
+uint32_t RowCodec::GetSerializedSize(const std::vector<Field *> &fields) const {
+  if (fields.empty()) {
+    return 0;
+  }
+  if (all_fixed_) {
+    return fixed_size_;
+  }
+  uint32_t size = fixed_size_;
+  for (auto field : fields) {
+    if (Type::IsCharType(field->type_id_) && !field->is_null_) {
+      size += field->len_;
+    }
+  }
+  return size;
+}
@@ -40,3 +40,4 @@ uint32_t Schema::DeserializeFrom(char *buf, Schema *&schema, MemHeap *heap) {
   schema = new (schema_ptr) Schema(columns);//将反序列化出的column赋值到新的schema
   return offset;
 }
+
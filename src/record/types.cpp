@@ -20,7 +20,12 @@ Type *Type::type_singletons_[] = {
         new Type(TypeId::kTypeInvalid),
         new TypeInt(),
         new TypeFloat(),
-        new TypeChar()
+        new TypeChar(),
+        new TypeBigInt(),
+        new TypeDouble(),
+        new TypeDate(),
+        new TypeTimestamp(),
+        new TypeVarchar()
 };
 
 uint32_t Type::SerializeTo(const Field &field, char *buf) const {
@@ -90,11 +95,11 @@ uint32_t TypeInt::SerializeTo(const Field &field, char *buf) const {
 
 uint32_t TypeInt::DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const {
   if (is_null) {
-    *field = ALLOC_P(heap, Field)(TypeId::kTypeInt);
+    *field = ALLOC_P(heap, Field)(type_id_);
     return 0;
   }
   int32_t val = MACH_READ_FROM(int32_t, storage);
-  *field = ALLOC_P(heap, Field)(TypeId::kTypeInt, val);
+  *field = ALLOC_P(heap, Field)(type_id_, val);
   return GetTypeSize(type_id_);
 }
 
@@ -245,7 +250,7 @@ uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
   if (!field.IsNull()) {
     uint32_t len = GetLength(field);
     memcpy(buf, &len, sizeof(uint32_t));
-    memcpy(buf + sizeof(uint32_t), field.value_.chars_, len);
+    memcpy(buf + sizeof(uint32_t), field.GetChars(), len);
     return len + sizeof(uint32_t);
   }
   return 0;
@@ -253,11 +258,11 @@ uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
 
 uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const {
   if (is_null) {
-    *field = ALLOC_P(heap, Field)(TypeId::kTypeChar);
+    *field = ALLOC_P(heap, Field)(type_id_);
     return 0;
   }
   uint32_t len = MACH_READ_UINT32(storage);
-  *field = ALLOC_P(heap, Field)(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
+  *field = ALLOC_P(heap, Field)(type_id_, storage + sizeof(uint32_t), len, true);
   return len + sizeof(uint32_t);
 }
 
@@ -270,7 +275,7 @@ uint32_t TypeChar::GetSerializedSize(const Field &field, bool is_null) const {
 }
 
 const char *TypeChar::GetData(const Field &val) const {
-  return val.value_.chars_;
+  return val.GetChars();
 }
 
 uint32_t TypeChar::GetLength(const Field &val) const {
@@ -323,4 +328,298 @@ CmpBool TypeChar::CompareGreaterThanEquals(const Field &left, const Field &right
     return CmpBool::kNull;
   }
   return GetCmpBool(CompareStrings(left.GetData(), left.GetLength(), right.GetData(), right.GetLength()) >= 0);
-}
\ No newline at end of file
+}
+// ==============================TypeBigInt=============================
+
+uint32_t TypeBigInt::SerializeTo(const Field &field, char *buf) const {
+  if (!field.IsNull()) {
+    MACH_WRITE_TO(int64_t, buf, field.value_.bigint_);
+    return GetTypeSize(type_id_);
+  }
+  return 0;
+}
+
+uint32_t TypeBigInt::DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const {
+  if (is_null) {
+    *field = ALLOC_P(heap, Field)(type_id_);
+    return 0;
+  }
+  int64_t val = MACH_READ_FROM(int64_t, storage);
+  *field = ALLOC_P(heap, Field)(type_id_, val);
+  return GetTypeSize(type_id_);
+}
+
+uint32_t TypeBigInt::GetSerializedSize(const Field &field, bool is_null) const {
+  if (is_null) {
+    return 0;
+  }
+  return GetTypeSize(type_id_);
+}
+
+const char* TypeBigInt::GetData(const Field &val) const {
+  std::string str = std::to_string(val.value_.bigint_);
+  char* buf = new char[str.size() + 1];
+  strcpy(buf, str.c_str());
+  return buf;
+}
+
+CmpBool TypeBigInt::CompareEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.bigint_ == right.value_.bigint_);
+}
+
+CmpBool TypeBigInt::CompareNotEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.bigint_ != right.value_.bigint_);
+}
+
+CmpBool TypeBigInt::CompareLessThan(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.bigint_ < right.value_.bigint_);
+}
+
+CmpBool TypeBigInt::CompareLessThanEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.bigint_ <= right.value_.bigint_);
+}
+
+CmpBool TypeBigInt::CompareGreaterThan(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.bigint_ > right.value_.bigint_);
+}
+
+CmpBool TypeBigInt::CompareGreaterThanEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.bigint_ >= right.value_.bigint_);
+}
+
+// ==============================TypeDouble=============================
+
+uint32_t TypeDouble::SerializeTo(const Field &field, char *buf) const {
+  if (!field.IsNull()) {
+    MACH_WRITE_TO(double, buf, field.value_.double_);
+    return GetTypeSize(type_id_);
+  }
+  return 0;
+}
+
+uint32_t TypeDouble::DeserializeFrom(char *storage, Field **field, bool is_null, MemHeap *heap) const {
+  if (is_null) {
+    *field = ALLOC_P(heap, Field)(TypeId::kTypeDouble);
+    return 0;
+  }
+  double val = MACH_READ_FROM(double, storage);
+  *field = ALLOC_P(heap, Field)(TypeId::kTypeDouble, val);
+  return GetTypeSize(type_id_);
+}
+
+uint32_t TypeDouble::GetSerializedSize(const Field &field, bool is_null) const {
+  if (is_null) {
+    return 0;
+  }
+  return GetTypeSize(type_id_);
+}
+
+const char* TypeDouble::GetData(const Field &val) const {
+  std::string str = std::to_string(val.value_.double_);
+  char* buf = new char[str.size() + 1];
+  strcpy(buf, str.c_str());
+  return buf;
+}
+
+CmpBool TypeDouble::CompareEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.double_ == right.value_.double_);
+}
+
+CmpBool TypeDouble::CompareNotEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.double_ != right.value_.double_);
+}
+
+CmpBool TypeDouble::CompareLessThan(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.double_ < right.value_.double_);
+}
+
+CmpBool TypeDouble::CompareLessThanEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.double_ <= right.value_.double_);
+}
+
+CmpBool TypeDouble::CompareGreaterThan(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.double_ > right.value_.double_);
+}
+
+CmpBool TypeDouble::CompareGreaterThanEquals(const Field &left, const Field &right) const {
+  ASSERT(left.CheckComparable(right), "Not comparable.");
+  if (left.IsNull() || right.IsNull()) {
+    return CmpBool::kNull;
+  }
+  return GetCmpBool(left.value_.double_ >= right.value_.double_);
+}
+
+// ==============================TypeDate=============================
+
+static constexpr int64_t MICROS_PER_SECOND = 1000000;
+static constexpr int64_t SECONDS_PER_DAY = 86400;
+
+/**
+ * 公历日期到 1970-01-01 的天数，适用于任意年份
+ */
+static int32_t DaysFromCivil(int32_t y, int32_t m, int32_t d) {
+  y -= m <= 2;
+  int32_t era = (y >= 0 ? y : y - 399) / 400;
+  int32_t yoe = y - era * 400;
+  int32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+static void CivilFromDays(int32_t days, int32_t &y, int32_t &m, int32_t &d) {
+  days += 719468;
+  int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+  int32_t doe = days - era * 146097;
+  int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int32_t mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = yoe + era * 400 + (m <= 2);
+}
+
+/**
+ * 读取恰好 digits 位的十进制数
+ */
+static bool ParseDigits(const char *&str, uint32_t digits, int32_t &value) {
+  value = 0;
+  for (uint32_t i = 0; i < digits; i++, str++) {
+    if (*str < '0' || *str > '9') {
+      return false;
+    }
+    value = value * 10 + (*str - '0');
+  }
+  return true;
+}
+
+static bool ParseDatePart(const char *&str, int32_t &days) {
+  int32_t y, m, d;
+  if (!ParseDigits(str, 4, y) || *str++ != '-' || !ParseDigits(str, 2, m) || *str++ != '-' ||
+      !ParseDigits(str, 2, d)) {
+    return false;
+  }
+  static const int32_t month_days[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+  if (m < 1 || m > 12 || d < 1 || d > month_days[m - 1] || (m == 2 && d == 29 && !leap)) {
+    return false;
+  }
+  days = DaysFromCivil(y, m, d);
+  return true;
+}
+
+const char* TypeDate::GetData(const Field &val) const {
+  char* buf = new char[MAX_TEXT_LEN];
+  Format(val.value_.integer_, buf);
+  return buf;
+}
+
+bool TypeDate::Parse(const char *str, int32_t &days) {
+  return ParseDatePart(str, days) && *str == '\0';
+}
+
+void TypeDate::Format(int32_t days, char *buf) {
+  int32_t y, m, d;
+  CivilFromDays(days, y, m, d);
+  snprintf(buf, MAX_TEXT_LEN, "%04d-%02d-%02d", y, m, d);
+}
+
+// ==============================TypeTimestamp=============================
+
+const char* TypeTimestamp::GetData(const Field &val) const {
+  char* buf = new char[MAX_TEXT_LEN];
+  Format(val.value_.bigint_, buf);
+  return buf;
+}
+
+bool TypeTimestamp::Parse(const char *str, int64_t &micros) {
+  int32_t days, hour = 0, minute = 0, second = 0, fraction = 0;
+  if (!ParseDatePart(str, days)) {
+    return false;
+  }
+  if (*str == ' ' || *str == 'T') {
+    str++;
+    if (!ParseDigits(str, 2, hour) || *str++ != ':' || !ParseDigits(str, 2, minute) || *str++ != ':' ||
+        !ParseDigits(str, 2, second) || hour > 23 || minute > 59 || second > 59) {
+      return false;
+    }
+    if (*str == '.') {
+      // 最多精确到微秒，不足 6 位的部分补 0
+      str++;
+      uint32_t digits = 0;
+      for (; *str >= '0' && *str <= '9' && digits < 6; str++, digits++) {
+        fraction = fraction * 10 + (*str - '0');
+      }
+      if (digits == 0) {
+        return false;
+      }
+      for (; digits < 6; digits++) {
+        fraction *= 10;
+      }
+    }
+  }
+  if (*str != '\0') {
+    return false;
+  }
+  micros = ((static_cast<int64_t>(days) * SECONDS_PER_DAY + hour * 3600 + minute * 60 + second) * MICROS_PER_SECOND)
+           + fraction;
+  return true;
+}
+
+void TypeTimestamp::Format(int64_t micros, char *buf) {
+  // 向下取整，使 1970 年之前的时间也能得到非负的时分秒
+  int64_t seconds = micros / MICROS_PER_SECOND - (micros % MICROS_PER_SECOND < 0);
+  int64_t fraction = micros - seconds * MICROS_PER_SECOND;
+  int64_t days = seconds / SECONDS_PER_DAY - (seconds % SECONDS_PER_DAY < 0);
+  int64_t time = seconds - days * SECONDS_PER_DAY;
+  TypeDate::Format(static_cast<int32_t>(days), buf);
+  uint32_t len = strlen(buf);
+  len += snprintf(buf + len, MAX_TEXT_LEN - len, " %02d:%02d:%02d", static_cast<int>(time / 3600),
+                  static_cast<int>(time / 60 % 60), static_cast<int>(time % 60));
+  if (fraction != 0) {
+    snprintf(buf + len, MAX_TEXT_LEN - len, ".%06d", static_cast<int>(fraction));
+  }
+}
@@ -1,13 +1,19 @@
+#include <algorithm>
+#include <atomic>
 #include <stdexcept>
 #include <sys/stat.h>
+#include <thread>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 #include "storage/disk_manager.h"
+#include "storage/page_compressor.h"
+#include "utils/crc32c.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file), crc_file_name_(db_file + ".crc") {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  bool new_file = !db_io_.is_open();
   // directory or file does not exist
   if (!db_io_.is_open()) {
     db_io_.clear();
@@ -20,6 +26,19 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
       throw std::exception();
     }
   }
+  // 新建的数据库文件不能沿用旧的校验和
+  crc_io_.open(crc_file_name_, std::ios::binary | std::ios::in | std::ios::out);
+  if (new_file || !crc_io_.is_open()) {
+    crc_io_.close();
+    crc_io_.clear();
+    crc_io_.open(crc_file_name_, std::ios::binary | std::ios::trunc | std::ios::out);
+    crc_io_.close();
+    crc_io_.open(crc_file_name_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!crc_io_.is_open()) {
+      throw std::exception();
+    }
+  }
+  crc_file_size_ = std::max(GetFileSize(crc_file_name_), 0);
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
 }
 
@@ -27,23 +46,58 @@ void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
     db_io_.close();
+    crc_io_.close();
     closed = true;
   }
 }
 
-void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
+bool DiskManager::ReadPage(page_id_t logical_page_id, char *page_data, bool *compressed) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  if (compressed != nullptr)
+    *compressed = false;
+  if (!ReadPhysicalPage(MapPageId(logical_page_id), page_data)) {
+    LOG(ERROR) << "Checksum mismatch of page " << logical_page_id;
+    return false;
+  }
+  if (MACH_READ_UINT32(page_data) != COMPRESSED_PAGE_MAGIC)
+    return true;
+  if (compressed != nullptr)
+    *compressed = true;
+  char frame[PAGE_SIZE];
+  memcpy(frame, page_data, PAGE_SIZE);
+  uint32_t size = MACH_READ_UINT32(frame + sizeof(uint32_t));
+  bool valid = size <= PAGE_SIZE - SIZE_COMPRESSED_HEADER &&
+               PageCompressor::Decompress(frame + SIZE_COMPRESSED_HEADER, size, page_data);
+  if (!valid)
+    LOG(ERROR) << "Corrupted compressed page " << logical_page_id;
+  ASSERT(valid, "Corrupted compressed page.");
+  return true;
 }
 
-void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
+void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data, bool compress) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (compress) {
+    // 压缩后至少要省下一个扇区，否则按原样写入
+    char frame[PAGE_SIZE];
+    uint32_t size = PageCompressor::Compress(page_data, frame + SIZE_COMPRESSED_HEADER,
+                                             PAGE_SIZE - SECTOR_SIZE - SIZE_COMPRESSED_HEADER);
+    if (size > 0) {
+      MACH_WRITE_UINT32(frame, COMPRESSED_PAGE_MAGIC);
+      MACH_WRITE_UINT32(frame + sizeof(uint32_t), size);
+      size += SIZE_COMPRESSED_HEADER;
+      WritePhysicalPage(MapPageId(logical_page_id), frame, (size + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE);
+      return;
+    }
+  }
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
 static constexpr size_t N = DiskManager::BITMAP_SIZE;
 
 page_id_t DiskManager::AllocatePage() {		// 从磁盘中分配一个空闲页，并返回空闲页的逻辑页号
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   for (size_t i = 1; i < MAX_VALID_PAGE_ID - N; i+=N+1) {
     ReadPhysicalPage(i, meta_data_);	// 从物理页读出meta_data_信息
     BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(meta_data_);//更新位图
@@ -65,6 +119,7 @@ page_id_t DiskManager::AllocatePage() {		// 从磁盘中分配一个空闲页，
 }
 
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) { 	//释放磁盘中逻辑页号对应的物理页
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (IsPageFree(logical_page_id) || MapPageId(logical_page_id) > MAX_VALID_PAGE_ID)
     return;
   for (size_t i = 0; i < PAGE_SIZE; i++) {
@@ -88,6 +143,7 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) { 	//释放磁盘中
 }
 
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {	// 判断该逻辑页号对应的数据页是否空闲
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   page_id_t bitmap_page_id = logical_page_id / N * (N+1) + 1;
   ReadPhysicalPage(bitmap_page_id, meta_data_);
   BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(meta_data_);
@@ -98,26 +154,84 @@ page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
   return (logical_page_id / N * (1+N) + logical_page_id % N + 1) + 1;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
-  struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+uint32_t DiskManager::CheckPages(std::vector<page_id_t> &corrupted, uint32_t num_workers) {
+  // 先在锁内从位图中收集所有已分配的页
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+    char bitmap_data[PAGE_SIZE];
+    auto meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+    ReadPhysicalPage(META_PAGE_ID, meta_data_);
+    uint32_t num_extents = meta_page->GetExtentNums();
+    for (uint32_t extent = 0; extent < num_extents; extent++) {
+      ReadPhysicalPage(extent * (N + 1) + 1, bitmap_data);
+      auto bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_data);
+      for (uint32_t offset = 0; offset < N; offset++) {
+        if (!bitmap->IsPageFree(offset))
+          page_ids.push_back(static_cast<page_id_t>(extent * N + offset));
+      }
+    }
+  }
+  num_workers = num_workers != 0 ? num_workers : std::max(std::thread::hardware_concurrency(), 1u);
+  num_workers = std::max<uint32_t>(std::min<size_t>(num_workers, page_ids.size()), 1);
+  // 每个线程使用自己的文件句柄，按页号分段读取
+  std::atomic<size_t> next_page{0};
+  std::vector<std::vector<page_id_t>> results(num_workers);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_workers; i++) {
+    threads.emplace_back([&, i]() {
+      std::ifstream db_io(file_name_, std::ios::binary);
+      std::ifstream crc_io(crc_file_name_, std::ios::binary);
+      size_t db_file_size = std::max(GetFileSize(file_name_), 0);
+      size_t crc_file_size = std::max(GetFileSize(crc_file_name_), 0);
+      char page_data[PAGE_SIZE];
+      constexpr size_t CHUNK = 64;
+      for (size_t begin = next_page.fetch_add(CHUNK); begin < page_ids.size(); begin = next_page.fetch_add(CHUNK)) {
+        for (size_t j = begin; j < std::min(begin + CHUNK, page_ids.size()); j++) {
+          if (!ReadAndVerify(db_io, db_file_size, crc_io, crc_file_size, MapPageId(page_ids[j]), page_data))
+            results[i].push_back(page_ids[j]);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto &result : results) {
+    corrupted.insert(corrupted.end(), result.begin(), result.end());
+  }
+  std::sort(corrupted.begin(), corrupted.end());
+  return static_cast<uint32_t>(page_ids.size());
+}
+
+uint32_t DiskManager::GetStoredSize(const char *page_data) {
+  if (MACH_READ_UINT32(page_data) != COMPRESSED_PAGE_MAGIC)
+    return PAGE_SIZE;
+  uint32_t size = MACH_READ_UINT32(page_data + sizeof(uint32_t)) + SIZE_COMPRESSED_HEADER;
+  return std::min<uint32_t>((size + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE, PAGE_SIZE);
+}
+
+uint32_t DiskManager::ComputeChecksum(const char *page_data, uint32_t size) {
+  uint32_t checksum = Crc32c::Compute(page_data, size);
+  return checksum != 0 ? checksum : 1;  // 0 表示没有校验和
 }
 
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+bool DiskManager::ReadAndVerify(std::istream &db_io, size_t db_file_size, std::istream &crc_io,
+                                size_t crc_file_size, page_id_t physical_page_id, char *page_data) {
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= db_file_size) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
   } else {
     // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
+    db_io.clear();
+    db_io.seekg(offset);
+    db_io.read(page_data, PAGE_SIZE);
+    // if file ends before reading PAGE_SIZE, eg: a compressed page at the end of the file
+    int read_count = db_io.gcount();
     if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
       LOG(INFO) << "Read less than a page" << std::endl;
@@ -125,13 +239,36 @@ void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data)
       memset(page_data + read_count, 0, PAGE_SIZE - read_count);
     }
   }
+  size_t crc_offset = static_cast<size_t>(physical_page_id) * sizeof(uint32_t);
+  if (crc_offset + sizeof(uint32_t) > crc_file_size)
+    return true;
+  uint32_t checksum;
+  crc_io.clear();
+  crc_io.seekg(crc_offset);
+  crc_io.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
+  // 被截断的页读出的 0 与校验和不符，因此不会被静默地当作空页
+  return checksum == 0 || checksum == ComputeChecksum(page_data, GetStoredSize(page_data));
+}
+
+int DiskManager::GetFileSize(const std::string &file_name) {
+  struct stat stat_buf;
+  int rc = stat(file_name.c_str(), &stat_buf);
+  return rc == 0 ? stat_buf.st_size : -1;
+}
+
+bool DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
+  bool valid = ReadAndVerify(db_io_, std::max(GetFileSize(file_name_), 0), crc_io_, crc_file_size_,
+                             physical_page_id, page_data);
+  if (!valid)
+    LOG(ERROR) << "Checksum mismatch of physical page " << physical_page_id;
+  return valid;
 }
 
-void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
+void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data, size_t size) {
   size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
   // set write cursor to offset
   db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  db_io_.write(page_data, size);
   // check for I/O error
   if (db_io_.bad()) {
     LOG(ERROR) << "I/O error while writing";
@@ -139,4 +276,11 @@ void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page
   }
   // needs to flush to keep disk file in sync
   db_io_.flush();
+  // 校验和覆盖实际写入的部分
+  uint32_t checksum = ComputeChecksum(page_data, size);
+  size_t crc_offset = static_cast<size_t>(physical_page_id) * sizeof(uint32_t);
+  crc_io_.seekp(crc_offset);
+  crc_io_.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+  crc_io_.flush();
+  crc_file_size_ = std::max(crc_file_size_, crc_offset + sizeof(checksum));
 }
@@ -0,0 +1,123 @@
+#include "storage/page_compressor.h"
+
+#include <algorithm>
+#include <cstring>
+
+static inline uint32_t Read32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/**
+ * Append a length which did not fit in its nibble, false if buf is full
+ */
+static bool WriteLength(char *buf, uint32_t &pos, uint32_t max_len, uint32_t len) {
+  for (; len >= 255; len -= 255) {
+    if (pos >= max_len)
+      return false;
+    buf[pos++] = static_cast<char>(255);
+  }
+  if (pos >= max_len)
+    return false;
+  buf[pos++] = static_cast<char>(len);
+  return true;
+}
+
+/**
+ * Append a sequence of literals [literal, literal + literal_len) and a match, match_len = 0 for the last sequence
+ */
+static bool WriteSequence(char *buf, uint32_t &pos, uint32_t max_len, const char *literal, uint32_t literal_len,
+                          uint32_t offset, uint32_t match_len) {
+  if (pos >= max_len)
+    return false;
+  uint32_t match_code = match_len == 0 ? 0 : match_len - PageCompressor::MIN_MATCH;
+  uint32_t token_pos = pos++;
+  buf[token_pos] = static_cast<char>((std::min(literal_len, 15u) << 4) | std::min(match_code, 15u));
+  if (literal_len >= 15 && !WriteLength(buf, pos, max_len, literal_len - 15))
+    return false;
+  if (pos + literal_len > max_len)
+    return false;
+  memcpy(buf + pos, literal, literal_len);
+  pos += literal_len;
+  if (match_len == 0)
+    return true;
+  if (pos + 2 > max_len)
+    return false;
+  buf[pos++] = static_cast<char>(offset & 0xff);
+  buf[pos++] = static_cast<char>(offset >> 8);
+  return match_code < 15 || WriteLength(buf, pos, max_len, match_code - 15);
+}
+
+uint32_t PageCompressor::Compress(const char *page, char *buf, uint32_t max_len) {
+  // 每个哈希桶记录最近一次出现该 4 字节序列的位置
+  int32_t table[1 << HASH_BITS];
+  memset(table, 0xff, sizeof(table));
+  uint32_t pos = 0, anchor = 0, ip = 0, misses = 0;
+  while (ip + MIN_MATCH <= PAGE_SIZE) {
+    uint32_t sequence = Read32(page + ip);
+    uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+    int32_t ref = table[hash];
+    table[hash] = static_cast<int32_t>(ip);
+    if (ref < 0 || Read32(page + ref) != sequence) {
+      // 连续找不到匹配时加大步长，不可压缩的页也能很快结束
+      ip += 1 + (misses++ >> 5);
+      continue;
+    }
+    uint32_t len = MIN_MATCH;
+    while (ip + len < PAGE_SIZE && page[ref + len] == page[ip + len])
+      len++;
+    if (!WriteSequence(buf, pos, max_len, page + anchor, ip - anchor, ip - ref, len))
+      return 0;
+    ip += len;
+    anchor = ip;
+    misses = 0;
+  }
+  if (!WriteSequence(buf, pos, max_len, page + anchor, PAGE_SIZE - anchor, 0, 0))
+    return 0;
+  return pos;
+}
+
+/**
+ * Read a length which did not fit in its nibble
+ */
+static bool ReadLength(const char *buf, uint32_t &pos, uint32_t len, uint32_t &value) {
+  while (pos < len) {
+    auto byte = static_cast<uint8_t>(buf[pos++]);
+    value += byte;
+    if (byte < 255)
+      return true;
+  }
+  return false;
+}
+
+bool PageCompressor::Decompress(const char *buf, uint32_t len, char *page) {
+  uint32_t pos = 0, op = 0;
+  while (pos < len) {
+    auto token = static_cast<uint8_t>(buf[pos++]);
+    uint32_t literal_len = token >> 4;
+    if (literal_len == 15 && !ReadLength(buf, pos, len, literal_len))
+      return false;
+    if (pos + literal_len > len || op + literal_len > PAGE_SIZE)
+      return false;
+    memcpy(page + op, buf + pos, literal_len);
+    pos += literal_len;
+    op += literal_len;
+    if (pos == len)
+      break;  // 最后一段只有字面量
+    if (pos + 2 > len)
+      return false;
+    uint32_t offset = static_cast<uint8_t>(buf[pos]) | (static_cast<uint8_t>(buf[pos + 1]) << 8);
+    pos += 2;
+    uint32_t match_len = token & 0xf;
+    if (match_len == 15 && !ReadLength(buf, pos, len, match_len))
+      return false;
+    match_len += MIN_MATCH;
+    if (offset == 0 || offset > op || op + match_len > PAGE_SIZE)
+      return false;
+    // 匹配可能与正在写入的部分重叠，逐字节复制
+    for (uint32_t i = 0; i < match_len; i++, op++)
+      page[op] = page[op - offset];
+  }
+  return op == PAGE_SIZE;
+}
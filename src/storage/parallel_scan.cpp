@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "storage/parallel_scan.h"
+
+ParallelScan::ParallelScan(TableHeap *table_heap, uint32_t num_workers) : table_heap_(table_heap) {
+  num_workers_ = num_workers != 0 ? num_workers : std::thread::hardware_concurrency();
+  if (num_workers_ == 0) {
+    num_workers_ = 1;
+  }
+}
+
+std::vector<RowId> ParallelScan::Filter(const std::function<bool(page_id_t)> &page_filter,
+                                        const std::function<bool(const Row &)> &predicate, Transaction *txn) {
+  return Run([&](const page_id_t *begin, const page_id_t *end, std::vector<RowId> &result) {
+    for (auto page_id = begin; page_id != end; page_id++) {
+      if (!page_filter(*page_id)) {
+        continue;
+      }
+      table_heap_->ScanPage(*page_id, [&](const Row &row) {
+        if (predicate(row)) {
+          result.emplace_back(row.GetRowId());
+        }
+      }, txn);
+    }
+  });
+}
+
+std::vector<RowId> ParallelScan::Filter(const std::function<bool(page_id_t)> &page_filter, uint32_t column_idx,
+                                        const char *op, const Field &operand, Transaction *txn) {
+  return Run([&](const page_id_t *begin, const page_id_t *end, std::vector<RowId> &result) {
+    // batch 中只有条件涉及的一列
+    RowBatch batch(table_heap_->GetSchema(), {column_idx});
+    auto consume = [&](RowBatch &full) {
+      full.Filter(0, op, operand);
+      for (uint32_t i = 0; i < full.GetSelectedCount(); i++) {
+        result.emplace_back(full.GetRowId(full.GetSelection()[i]));
+      }
+    };
+    for (auto page_id = begin; page_id != end; page_id++) {
+      if (page_filter(*page_id)) {
+        table_heap_->ScanBatch(*page_id, batch, consume, txn);
+      }
+    }
+    if (batch.GetSize() > 0) {
+      consume(batch);
+    }
+  });
+}
+
+std::vector<RowId> ParallelScan::Run(
+        const std::function<void(const page_id_t *begin, const page_id_t *end, std::vector<RowId> &result)> &scan_morsel) {
+  // 拷贝一份页列表，扫描期间不受插入新页的影响
+  std::vector<page_id_t> page_ids = table_heap_->GetPageIds();
+  size_t num_morsels = (page_ids.size() + MORSEL_SIZE - 1) / MORSEL_SIZE;
+  size_t num_workers = std::min<size_t>(num_workers_, num_morsels);
+  std::atomic<size_t> next_morsel{0};
+  std::vector<std::vector<RowId>> results(std::max<size_t>(num_workers, 1));
+
+  auto worker = [&](std::vector<RowId> &result) {
+    while (true) {
+      size_t morsel = next_morsel.fetch_add(1);
+      if (morsel >= num_morsels) {
+        break;
+      }
+      size_t end = std::min(page_ids.size(), (morsel + 1) * MORSEL_SIZE);
+      scan_morsel(page_ids.data() + morsel * MORSEL_SIZE, page_ids.data() + end, result);
+    }
+  };
+
+  if (num_workers <= 1) {
+    // 页数太少，不值得创建线程
+    worker(results[0]);
+  } else {
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; i++) {
+      threads.emplace_back(worker, std::ref(results[i]));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  // 合并各个线程的结果
+  std::vector<RowId> merged;
+  size_t total = 0;
+  for (auto &result : results) {
+    total += result.size();
+  }
+  merged.reserve(total);
+  for (auto &result : results) {
+    merged.insert(merged.end(), result.begin(), result.end());
+  }
+  std::sort(merged.begin(), merged.end());
+  return merged;
+}
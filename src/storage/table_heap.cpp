@@ -15,63 +15,121 @@ bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
 //    page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page->GetNextPageId()));
 //    page->WLatch();
 //  }
+  if (!NeedEncode(row))
+    return (layout_ != kLayoutPAX || pax_layout_->Fits(row)) && InsertStoredTuple(row, row, txn);
+  // 字典列换成编码，过长的 char 值先写入溢出页，页内只保存指针
+  std::vector<Field> fields;
+  if (!EncodeTuple(row, fields))
+    return false;
+  Row stored(fields);
+  if ((layout_ == kLayoutPAX && !pax_layout_->Fits(stored)) || !InsertStoredTuple(stored, row, txn)) {
+    FreeToast(stored);
+    return false;
+  }
+  row.SetRowId(stored.GetRowId());
+  return true;
+}
+
+bool TableHeap::InsertStoredTuple(Row &stored, const Row &row, Transaction *txn) {
   if (!max_free_page_.empty()) {//找到最前的page，当最前的page不为空时，直接插入
     auto top_page = max_free_page_.top();
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(top_page.page_id_));
-    if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {//当插入page成功后返回true
-      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-      page->WUnlatch();
+    auto page = buffer_pool_manager_->FetchPage(top_page.page_id_);
+    page->WLatch();
+    bool inserted = layout_ == kLayoutPAX ?
+                    reinterpret_cast<PaxPage *>(page)->InsertTuple(stored, *pax_layout_, txn, lock_manager_, log_manager_) :
+                    reinterpret_cast<TablePage *>(page)->InsertTuple(stored, stored_schema_, txn, lock_manager_, log_manager_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+    max_free_page_.pop();
+    if (inserted) {//当插入page成功后返回true
+      zone_map_.Insert(top_page.page_id_, row);
       top_page.size_ -= 1;//top_page的大小减一
-      max_free_page_.pop();
       if (top_page.size_ > 0)
         max_free_page_.push(top_page);//当top_page的大小大于0时将top_page压入max_free_page
       return true;
     }
-}
+    // 已满的页在 RecreateQueue 时重新加入队列
+  }
   //当top_page为空时新建一个top_page并插入
   page_id_t page_id;
   //新建一个page
-  auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(page_id));
+  auto new_page = buffer_pool_manager_->NewPage(page_id);
   if (!new_page)
     return false;
   //page的id为最后的page_id
-  new_page->Init(page_id, last_page_id_, log_manager_, txn);
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
-  page->SetNextPageId(new_page->GetPageId());//new_page更新为last_page
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  InitPage(new_page, page_id, last_page_id_, txn);
+  auto page = buffer_pool_manager_->FetchPage(last_page_id_);
+  SetNextPageId(page, page_id);//new_page更新为last_page
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
   //将tuple插入到新的page中
-  bool ans = new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
-  buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
-  max_free_page_.push(MaxHeapNode(page_id, PAGE_SIZE - 1));
+  bool ans = layout_ == kLayoutPAX ?
+             reinterpret_cast<PaxPage *>(new_page)->InsertTuple(stored, *pax_layout_, txn, lock_manager_, log_manager_) :
+             reinterpret_cast<TablePage *>(new_page)->InsertTuple(stored, stored_schema_, txn, lock_manager_, log_manager_);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  max_free_page_.push(MaxHeapNode(page_id, GetPageCapacity() - 1));
   last_page_id_ = page_id;
+  page_ids_.push_back(page_id);
+  if (ans)
+    zone_map_.Insert(page_id, row);
   return ans;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     return false;
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  Row old_row(rid);
+  if (GetTuple(page, &old_row, txn))
+    zone_map_.Remove(rid.GetPageId(), old_row);
+  bool result = layout_ == kLayoutPAX ?
+                reinterpret_cast<PaxPage *>(page)->MarkDelete(rid, *pax_layout_, txn, lock_manager_, log_manager_) :
+                reinterpret_cast<TablePage *>(page)->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  return true;
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  return result;
 }
 
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  Row* old_row = new Row(rid);
-  if (!GetTuple(old_row, txn))//将原来的tuple复制到old_row
+  Row old_row(rid);
+  if (!GetTuple(&old_row, txn, false))//将原来的tuple复制到old_row，溢出页中的值不需要读出
     return false;
-  int err_code;
+  std::unique_ptr<Row> encoded;
+  if (NeedEncode(row)) {
+    std::vector<Field> fields;
+    if (!EncodeTuple(row, fields))
+      return false;
+    encoded.reset(new Row(fields));
+  }
+  Row &stored = encoded ? *encoded : row;
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
+  int err_code = 0;
+  bool flag;
   page->WLatch();
-  bool flag = page->UpdateTuple(row, old_row, schema_, err_code, txn, lock_manager_, log_manager_);//将page中的old_row更新为新的row
+  if (layout_ == kLayoutPAX) {
+    // pax 页中的值定长，原地更新；放不下的值走删除再插入
+    flag = reinterpret_cast<PaxPage *>(page)->UpdateTuple(stored, rid, *pax_layout_, txn, lock_manager_, log_manager_);
+    err_code = pax_layout_->Fits(stored) ? 0 : 1;
+  } else {
+    Row tmp_row(rid);
+    flag = reinterpret_cast<TablePage *>(page)->UpdateTuple(stored, &tmp_row, stored_schema_, err_code, txn, lock_manager_,
+                                                            log_manager_);//将page中的old_row更新为新的row
+  }
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), flag);
+  if (flag) {
+    // 原地更新，zone map 中替换旧的元组
+    row.SetRowId(rid);
+    FreeToast(old_row);  // 旧值的溢出页不再被引用
+    zone_map_.Remove(rid.GetPageId(), old_row);
+    zone_map_.Insert(rid.GetPageId(), row);
+  } else if (encoded) {
+    FreeToast(stored);
+  }
   // update for extra requests
   if (!flag && err_code == 1) //当更新不正确时删除更新
   {
@@ -87,100 +145,495 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
 
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // Step1: Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));//找到当前page
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());//找到当前page
   assert(page != nullptr);
   // Step2: Delete the tuple from the page.
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);//将当前的page中的元组删除
+  Row old_row(rid);
+  bool visible = GetTuple(page, &old_row, txn);
+  if (visible)  // 已经 MarkDelete 的元组在标记时就已从 zone map 移除
+    zone_map_.Remove(rid.GetPageId(), old_row);
+  if (may_toast_) {
+    // 已经 MarkDelete 的元组读不到，先撤销标记以找到它引用的溢出页，随后整个元组都会被删除
+    if (!visible) {
+      reinterpret_cast<TablePage *>(page)->RollbackDelete(rid, txn, log_manager_);
+      visible = GetTuple(page, &old_row, txn);
+    }
+    if (visible)
+      FreeToast(old_row);
+  }
+  if (layout_ == kLayoutPAX)
+    reinterpret_cast<PaxPage *>(page)->ApplyDelete(rid, *pax_layout_, txn, log_manager_);
+  else
+    reinterpret_cast<TablePage *>(page)->ApplyDelete(rid, txn, log_manager_);//将当前的page中的元组删除
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);//更新page
-  vector<MaxHeapNode> nodes;
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);//更新page
 }
 
 void TableHeap::RecreateQueue() {
   priority_queue<MaxHeapNode> new_queue;
-  auto page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(first_page_id_));
-  while (true) {
-    auto size = PAGE_SIZE;
-    auto r_id = new RowId;
-    if (!page->GetFirstTupleRid(r_id)) {
-      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-      break;
-    }
-    while (page->GetNextTupleRid(*r_id, r_id)) {
-      size--;
-    }
-    if (size > 0)
-      new_queue.push(MaxHeapNode(page->GetPageId(), size));
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    if (page->GetNextPageId() == INVALID_PAGE_ID)
-      break;
-    page = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page->GetNextPageId()));
+  for (auto page_id : page_ids_) {
+    size_t used = zone_map_.GetRowCount(page_id);
+    if (used < GetPageCapacity())
+      new_queue.push(MaxHeapNode(page_id, GetPageCapacity() - used));
   }
   max_free_page_ = new_queue;
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   assert(page != nullptr);
   // Rollback the delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  if (layout_ == kLayoutPAX)
+    reinterpret_cast<PaxPage *>(page)->RollbackDelete(rid, *pax_layout_, txn, log_manager_);
+  else
+    reinterpret_cast<TablePage *>(page)->RollbackDelete(rid, txn, log_manager_);
+  Row row(rid);
+  if (GetTuple(page, &row, txn))
+    zone_map_.Insert(rid.GetPageId(), row);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
 }
 
 void TableHeap::FreeHeap() {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  while (page->GetNextPageId() != INVALID_PAGE_ID) //page未删除完全时持续删除
-  {
-    auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page->GetNextPageId()));//next_page指向下一个page
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    buffer_pool_manager_->DeletePage(page->GetPageId());//删除当前的page
-    page = next_page;
+  // 页链表已经记录在 page_ids_ 中，DeletePage 会释放不在缓冲池中的页
+  for (auto page_id : page_ids_) {
+    if (may_toast_)  // 先释放元组引用的溢出页
+      ScanPage(page_id, [&](const Row &row) { FreeToast(row); }, nullptr);
+    buffer_pool_manager_->DeletePage(page_id);
   }
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-  buffer_pool_manager_->DeletePage(page->GetPageId());//删除最后的page
+  for (auto &column : dictionary_columns_)
+    FreeOverflow(column.first_page_id_);
+  page_ids_.clear();
+  zone_map_.Clear();
+}
+
+bool TableHeap::GetTuple(Row *row, Transaction *txn, bool detoast) {
+  bool result = ReadTuple(row, txn, true);
+  if (result && detoast)
+    DetoastRow(row);
+  return result;
 }
 
-bool TableHeap::GetTuple(Row *row, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));//得到row所在的page的id
+bool TableHeap::ReadTuple(Row *row, Transaction *txn, bool decode) {
+  auto page = buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId());//得到row所在的page的id
   assert(page != nullptr);
   page->RLatch();
-  bool result = page->GetTuple(row, schema_, txn, lock_manager_);//从page中获得row的值
+  bool result = GetTuple(page, row, txn, decode);//从page中获得row的值
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   return result;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
-  //得到第一页
-  TablePage* first = (reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_)));
-  //建立一个指向行的指针
-  auto first_id = new RowId;
-  //直到遇见1才停
-  //bool GetFirstTupleRid(RowId *first_rid);
-  while (true)
-  {
-    if (first->GetFirstTupleRid(first_id)) break; /*找到了第一个*/
-    if (first->GetNextPageId() == INVALID_PAGE_ID) /*已经是最后一页了，并且没有找到第一个元组*/
-    {
-      delete first_id;  /*释放空间*/
-      return TableIterator(nullptr, this);  /*返回null*/
+void TableHeap::Detoast(Field *field) {
+  if (!field->IsToasted())
+    return;
+  auto pointer = field->GetToastPointer();
+  char *buf = new char[pointer.len_];
+  uint32_t offset = 0;
+  page_id_t page_id = pointer.first_page_id_;
+  // 沿着溢出页链表依次读出各段
+  while (page_id != INVALID_PAGE_ID && offset < pointer.len_) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Overflow page not found.");
+    page->RLatch();
+    offset += page->ReadData(buf + offset);
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  ASSERT(offset == pointer.len_, "Broken overflow page chain.");
+  Field value(field->GetTypeId(), buf, pointer.len_, true);
+  *field = value;
+  delete[] buf;
+}
+
+bool TableHeap::ScanPage(page_id_t page_id, const std::function<void(const Row &)> &visitor, Transaction *txn) {
+  return ScanPage(page_id, visitor, txn, true);
+}
+
+bool TableHeap::ScanPage(page_id_t page_id, const std::function<void(const Row &)> &visitor, Transaction *txn,
+                         bool decode) {
+  auto page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr)
+    return false;
+  page->RLatch();
+  RowId r_id;
+  ArenaMemHeap arena;
+  if (GetFirstTupleRid(page, &r_id)) {
+    do {
+      arena.Reset();  // 上一行已经析构，复用 arena 的内存
+      Row row(r_id, &arena);
+      GetTuple(page, &row, txn, decode);
+      visitor(row);
+    } while (GetNextTupleRid(page, r_id, &r_id));
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
+}
+
+bool TableHeap::ScanColumn(page_id_t page_id, uint32_t column_idx,
+                           const std::function<void(const RowId &, const Field &)> &visitor, Transaction *txn) {
+  if (layout_ != kLayoutPAX) {
+    // 行存按偏移直接定位该列，不需要解码整行
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      return false;
+    page->RLatch();
+    RowId r_id;
+    if (page->GetFirstTupleRid(&r_id)) {
+      Field field(stored_schema_->GetColumn(column_idx)->GetType());
+      do {
+        page->GetField(r_id, column_idx, stored_schema_, field);
+        Detoast(&field);
+        if (dictionaries_[column_idx] == nullptr) {
+          visitor(r_id, field);
+          continue;
+        }
+        Field value(field);
+        DecodeField(column_idx, &value);
+        visitor(r_id, value);
+      } while (page->GetNextTupleRid(r_id, &r_id));
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return true;
+  }
+  auto page = reinterpret_cast<PaxPage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr)
+    return false;
+  page->RLatch();
+  RowId r_id;
+  if (page->GetFirstTupleRid(*pax_layout_, &r_id)) {
+    Field field(stored_schema_->GetColumn(column_idx)->GetType());
+    do {
+      page->GetField(r_id, column_idx, *pax_layout_, field);
+      if (dictionaries_[column_idx] == nullptr) {
+        visitor(r_id, field);
+        continue;
+      }
+      Field value(field);
+      DecodeField(column_idx, &value);
+      visitor(r_id, value);
+    } while (page->GetNextTupleRid(*pax_layout_, r_id, &r_id));
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
+}
+
+bool TableHeap::ScanBatch(page_id_t page_id, RowBatch &batch, const std::function<void(RowBatch &)> &visitor,
+                          Transaction *txn) {
+  // 字典列以编码的形式放入 batch，谓词直接比较编码
+  BindDictionaries(batch);
+  return ScanPage(page_id, [&](const Row &row) {
+    for (auto column_id : batch.GetColumnIds())
+      Detoast(row.GetField(column_id));
+    batch.Append(row);
+    if (batch.IsFull()) {
+      visitor(batch);
+      batch.Reset();
+    }
+  }, txn, false);
+}
+
+void TableHeap::FetchBatch(const std::vector<RowId> &rids, RowBatch &batch,
+                           const std::function<void(RowBatch &)> &visitor, Transaction *txn) {
+  BindDictionaries(batch);
+  ArenaMemHeap arena;
+  for (auto &rid : rids) {
+    arena.Reset();
+    Row row(rid, &arena);
+    if (!ReadTuple(&row, txn, false))
+      continue;
+    for (auto column_id : batch.GetColumnIds())
+      Detoast(row.GetField(column_id));
+    batch.Append(row);
+    if (batch.IsFull()) {
+      visitor(batch);
+      batch.Reset();
     }
-    //更新page
-    first = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(first->GetNextPageId()));
-  }
-  Row* r = new Row(*first_id);  // update: row 需要通过 GetTuple 得到数据
-  GetTuple(r, txn);
-  //构建迭代器
-  return TableIterator(r, this);}  // update: 返回一个拷贝构造
-//  //释放空间
-//  delete first_id;
-//  //返回迭代器
-//  return ite;}
+  }
+}
+
+TableIterator TableHeap::Begin(Transaction *txn) {
+  RowId first_id;
+  if (!GetNextRowId(INVALID_ROWID, &first_id))  /*没有任何元组*/
+    return TableIterator(nullptr, this);
+  //构建迭代器，row 需要通过 GetTuple 得到数据
+  return TableIterator(first_id, this, txn);
+}
 
 TableIterator TableHeap::End() {
   //flag: 行指针为空
-  return TableIterator(nullptr, this);}
+  return TableIterator(nullptr, this);
+}
+
+void TableHeap::InitPage(Page *page, page_id_t page_id, page_id_t prev_id, Transaction *txn) {
+  if (compression_ != kCompressionNone)
+    buffer_pool_manager_->SetCompressed(page_id);
+  if (layout_ == kLayoutPAX)
+    reinterpret_cast<PaxPage *>(page)->Init(page_id, prev_id, log_manager_, txn);
+  else
+    reinterpret_cast<TablePage *>(page)->Init(page_id, prev_id, log_manager_, txn);
+}
+
+page_id_t TableHeap::GetNextPageId(Page *page) {
+  if (layout_ == kLayoutPAX)
+    return reinterpret_cast<PaxPage *>(page)->GetNextPageId();
+  return reinterpret_cast<TablePage *>(page)->GetNextPageId();
+}
+
+void TableHeap::SetNextPageId(Page *page, page_id_t next_page_id) {
+  if (layout_ == kLayoutPAX)
+    reinterpret_cast<PaxPage *>(page)->SetNextPageId(next_page_id);
+  else
+    reinterpret_cast<TablePage *>(page)->SetNextPageId(next_page_id);
+}
+
+bool TableHeap::GetTuple(Page *page, Row *row, Transaction *txn, bool decode) {
+  bool result = layout_ == kLayoutPAX ?
+                reinterpret_cast<PaxPage *>(page)->GetTuple(row, *pax_layout_, txn, lock_manager_) :
+                reinterpret_cast<TablePage *>(page)->GetTuple(row, stored_schema_, txn, lock_manager_);
+  if (result && decode)
+    DecodeRow(row);
+  return result;
+}
+
+bool TableHeap::GetFirstTupleRid(Page *page, RowId *first_rid) {
+  if (layout_ == kLayoutPAX)
+    return reinterpret_cast<PaxPage *>(page)->GetFirstTupleRid(*pax_layout_, first_rid);
+  return reinterpret_cast<TablePage *>(page)->GetFirstTupleRid(first_rid);
+}
+
+bool TableHeap::GetNextTupleRid(Page *page, const RowId &cur_rid, RowId *next_rid) {
+  if (layout_ == kLayoutPAX)
+    return reinterpret_cast<PaxPage *>(page)->GetNextTupleRid(*pax_layout_, cur_rid, next_rid);
+  return reinterpret_cast<TablePage *>(page)->GetNextTupleRid(cur_rid, next_rid);
+}
+
+bool TableHeap::GetNextRowId(const RowId &cur_rid, RowId *next_rid) {
+  page_id_t page_id = cur_rid.GetPageId() == INVALID_PAGE_ID ? first_page_id_ : cur_rid.GetPageId();
+  auto page = buffer_pool_manager_->FetchPage(page_id);
+  page->RLatch();
+  bool found = cur_rid.GetPageId() == INVALID_PAGE_ID ? GetFirstTupleRid(page, next_rid)
+                                                      : GetNextTupleRid(page, cur_rid, next_rid);
+  // 当前页没有更多元组，沿着页链表向后查找
+  while (!found) {
+    page_id_t next_page_id = GetNextPageId(page);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID)
+      return false;
+    page = buffer_pool_manager_->FetchPage(next_page_id);
+    page->RLatch();
+    found = GetFirstTupleRid(page, next_rid);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return true;
+}
+
+bool TableHeap::NeedEncode(const Row &row) const {
+  if (!dictionary_columns_.empty())
+    return true;
+  if (!may_toast_)
+    return false;
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    auto field = row.GetField(i);
+    ASSERT(!field->IsToasted(), "Row to store must be detoasted.");
+    if (Type::IsCharType(field->GetTypeId()) && !field->IsNull() && field->GetLength() > TOAST_THRESHOLD)
+      return true;
+  }
+  return false;
+}
+
+bool TableHeap::EncodeTuple(const Row &row, std::vector<Field> &fields) {
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    auto field = row.GetField(i);
+    bool encoded = true;
+    if (dictionaries_[i] != nullptr && field->IsNull()) {
+      fields.emplace_back(TypeId::kTypeInt);
+    } else if (dictionaries_[i] != nullptr) {
+      bool inserted;
+      uint32_t code = dictionaries_[i]->Insert(field->GetData(), field->GetLength(), inserted);
+      // 新的值先持久化字典，再写入引用它的元组
+      for (auto &column : dictionary_columns_) {
+        if (inserted && column.column_idx_ == i)
+          encoded = SaveDictionary(column);
+      }
+      fields.emplace_back(TypeId::kTypeInt, static_cast<int32_t>(code));
+    } else if (!Type::IsCharType(field->GetTypeId()) || field->IsNull() || field->GetLength() <= TOAST_THRESHOLD) {
+      fields.emplace_back(*field);
+    } else {
+      page_id_t first_page_id = WriteOverflow(field->GetData(), field->GetLength());
+      encoded = first_page_id != INVALID_PAGE_ID;
+      fields.emplace_back(field->GetTypeId(), ToastPointer{first_page_id, field->GetLength()});
+    }
+    if (!encoded) {
+      // 分配失败，释放已经写入的值
+      fields.pop_back();
+      for (auto &written : fields) {
+        if (written.IsToasted())
+          FreeOverflow(written.GetToastPointer().first_page_id_);
+      }
+      fields.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+void TableHeap::DetoastRow(Row *row) {
+  if (!may_toast_)
+    return;
+  for (auto field : row->GetFields()) {
+    Detoast(field);
+  }
+}
+
+void TableHeap::DecodeRow(Row *row) {
+  for (auto &column : dictionary_columns_) {
+    DecodeField(column.column_idx_, row->GetField(column.column_idx_));
+  }
+}
+
+void TableHeap::DecodeField(uint32_t column_idx, Field *field) {
+  ASSERT(field->GetTypeId() == TypeId::kTypeInt, "Field is not a dictionary code.");
+  TypeId type = schema_->GetColumn(column_idx)->GetType();
+  if (field->IsNull()) {
+    Field value(type);
+    *field = value;
+    return;
+  }
+  auto dictionary = dictionaries_[column_idx];
+  auto code = static_cast<uint32_t>(field->value_.integer_);
+  // 短的值直接存放在 field 内，不需要分配内存
+  Field value(type, const_cast<char *>(dictionary->GetValue(code)), dictionary->GetLength(code), true);
+  *field = value;
+}
+
+void TableHeap::BindDictionaries(RowBatch &batch) const {
+  for (uint32_t i = 0; i < batch.GetColumnCount(); i++) {
+    auto dictionary = dictionaries_[batch.GetColumnIds()[i]];
+    if (dictionary != nullptr && batch.GetColumn(i).GetDictionary() != dictionary)
+      batch.SetDictionary(i, dictionary);
+  }
+}
+
+void TableHeap::InitStorage(const std::vector<DictionaryColumn> &dictionaries) {
+  dictionaries_.assign(schema_->GetColumnCount(), nullptr);
+  stored_schema_ = schema_;
+  if (!dictionaries.empty()) {
+    // 页内的字典列保存为 int 编码
+    std::vector<Column *> columns;
+    for (auto column : schema_->GetColumns())
+      columns.push_back(new Column(column));
+    for (auto &dictionary : dictionaries) {
+      auto column = schema_->GetColumn(dictionary.column_idx_);
+      ASSERT(Type::IsCharType(column->GetType()), "Dictionary of a non-char column.");
+      delete columns[dictionary.column_idx_];
+      columns[dictionary.column_idx_] = new Column(column->GetName(), TypeId::kTypeInt, column->GetTableInd(),
+                                                   column->IsNullable(), false);
+    }
+    stored_schema_ = new Schema(columns);
+  }
+  for (auto dictionary : dictionaries) {
+    dictionaries_[dictionary.column_idx_] = new Dictionary();
+    if (dictionary.first_page_id_ == INVALID_PAGE_ID) {
+      auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(dictionary.first_page_id_));
+      ASSERT(page != nullptr, "Can not allocate dictionary page.");
+      page->Init(dictionary.first_page_id_, INVALID_PAGE_ID);
+      buffer_pool_manager_->UnpinPage(dictionary.first_page_id_, true);
+      SaveDictionary(dictionary);
+    } else {
+      std::vector<char> buf;
+      page_id_t page_id = dictionary.first_page_id_;
+      while (page_id != INVALID_PAGE_ID) {
+        auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+        ASSERT(page != nullptr, "Dictionary page not found.");
+        uint32_t offset = static_cast<uint32_t>(buf.size());
+        buf.resize(offset + page->GetDataSize());
+        page->ReadData(buf.data() + offset);
+        page_id_t next_page_id = page->GetNextPageId();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
+      }
+      Dictionary::DeserializeFrom(buf.data(), *dictionaries_[dictionary.column_idx_]);
+    }
+    dictionary_columns_.push_back(dictionary);
+  }
+  if (layout_ == kLayoutPAX)
+    pax_layout_ = new PaxLayout(stored_schema_);
+}
+
+bool TableHeap::SaveDictionary(const DictionaryColumn &column) {
+  auto dictionary = dictionaries_[column.column_idx_];
+  std::vector<char> buf(dictionary->GetSerializedSize());
+  dictionary->SerializeTo(buf.data());
+  auto len = static_cast<uint32_t>(buf.size());
+  uint32_t first_len = std::min<uint32_t>(len, OverflowPage::SIZE_MAX_DATA);
+  // 首页之外的部分写入新的页链，最后再改写首页，失败时旧的字典保持完整
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  if (len > first_len) {
+    next_page_id = WriteOverflow(buf.data() + first_len, len - first_len);
+    if (next_page_id == INVALID_PAGE_ID)
+      return false;
+  }
+  auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(column.first_page_id_));
+  ASSERT(page != nullptr, "Dictionary page not found.");
+  page->WLatch();
+  page_id_t old_next_page_id = page->GetNextPageId();
+  page->SetNextPageId(next_page_id);
+  page->WriteData(buf.data(), first_len);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(column.first_page_id_, true);
+  FreeOverflow(old_next_page_id);
+  return true;
+}
+
+page_id_t TableHeap::WriteOverflow(const char *data, uint32_t len) {
+  // 从最后一段开始写，这样每一页创建时就知道下一页的 id
+  uint32_t chunks = (len + OverflowPage::SIZE_MAX_DATA - 1) / OverflowPage::SIZE_MAX_DATA;
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  for (uint32_t i = chunks; i > 0; i--) {
+    page_id_t page_id;
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(page_id));
+    if (page == nullptr) {
+      FreeOverflow(next_page_id);
+      return INVALID_PAGE_ID;
+    }
+    uint32_t offset = (i - 1) * OverflowPage::SIZE_MAX_DATA;
+    page->WLatch();
+    page->Init(page_id, next_page_id);
+    page->WriteData(data + offset, std::min<uint32_t>(len - offset, OverflowPage::SIZE_MAX_DATA));
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    next_page_id = page_id;
+  }
+  return next_page_id;
+}
+
+void TableHeap::FreeOverflow(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      return;
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+void TableHeap::FreeToast(const Row &row) {
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    auto field = row.GetField(i);
+    if (field->IsToasted())
+      FreeOverflow(field->GetToastPointer().first_page_id_);
+  }
+}
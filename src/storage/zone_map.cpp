@@ -0,0 +1,142 @@
+#include <cstring>
+
+#include "storage/zone_map.h"
+
+ZoneMap::~ZoneMap() {
+  Clear();
+}
+
+void ZoneMap::ResetZone(PageZone &zone) {
+  for (auto &column : zone.columns_) {
+    delete column.min_;
+    delete column.max_;
+    column.min_ = column.max_ = nullptr;
+    column.null_count_ = 0;
+    column.unbounded_ = false;
+  }
+  zone.row_count_ = 0;
+}
+
+void ZoneMap::SetBound(Field *&bound, const Field &value) {
+  delete bound;
+  // char 需要深拷贝，否则会指向 row 的内存
+  if (Type::IsCharType(value.GetTypeId())) {
+    bound = new Field(value.GetTypeId(), const_cast<char *>(value.GetData()), value.GetLength(), true);
+  } else {
+    bound = new Field(value);
+  }
+}
+
+void ZoneMap::Insert(page_id_t page_id, const Row &row) {
+  auto &zone = zones_[page_id];
+  if (zone.columns_.empty()) {
+    zone.columns_.resize(schema_->GetColumnCount());
+  }
+  zone.row_count_++;
+  for (uint32_t i = 0; i < zone.columns_.size() && i < row.GetFieldCount(); i++) {
+    auto field = row.GetField(i);
+    auto &column = zone.columns_[i];
+    if (field->IsNull()) {
+      column.null_count_++;
+      continue;
+    }
+    if (field->IsToasted()) {
+      // 溢出页中的值不读出，该页的这一列不再按值裁剪
+      column.unbounded_ = true;
+      continue;
+    }
+    // 扩展当前页该列的上下界
+    if (column.min_ == nullptr || field->CompareLessThan(*column.min_) == CmpBool::kTrue) {
+      SetBound(column.min_, *field);
+    }
+    if (column.max_ == nullptr || field->CompareGreaterThan(*column.max_) == CmpBool::kTrue) {
+      SetBound(column.max_, *field);
+    }
+  }
+}
+
+void ZoneMap::Remove(page_id_t page_id, const Row &row) {
+  auto iter = zones_.find(page_id);
+  if (iter == zones_.end()) {
+    return;
+  }
+  auto &zone = iter->second;
+  if (zone.row_count_ <= 1) {
+    // 页已经为空，直接重置
+    ResetZone(zone);
+    return;
+  }
+  zone.row_count_--;
+  for (uint32_t i = 0; i < zone.columns_.size() && i < row.GetFieldCount(); i++) {
+    if (row.GetField(i)->IsNull() && zone.columns_[i].null_count_ > 0) {
+      zone.columns_[i].null_count_--;
+    }
+  }
+}
+
+void ZoneMap::Erase(page_id_t page_id) {
+  auto iter = zones_.find(page_id);
+  if (iter == zones_.end()) {
+    return;
+  }
+  ResetZone(iter->second);
+  zones_.erase(iter);
+}
+
+void ZoneMap::Clear() {
+  for (auto &zone : zones_) {
+    ResetZone(zone.second);
+  }
+  zones_.clear();
+}
+
+bool ZoneMap::MayMatch(page_id_t page_id, uint32_t column_idx, const char *op, const Field &value) const {
+  auto iter = zones_.find(page_id);
+  if (iter == zones_.end()) {
+    // 没有记录的页无法判断
+    return true;
+  }
+  auto &zone = iter->second;
+  if (zone.row_count_ == 0) {
+    return false;
+  }
+  if (column_idx >= zone.columns_.size()) {
+    return true;
+  }
+  auto &column = zone.columns_[column_idx];
+  bool has_value = column.null_count_ < zone.row_count_ && (column.min_ != nullptr || column.unbounded_);
+  if (strcmp(op, "is") == 0) {
+    return column.null_count_ > 0;
+  }
+  if (strcmp(op, "not") == 0) {
+    return has_value;
+  }
+  if (!has_value || value.IsNull()) {
+    // 与 null 的比较结果均不为 true
+    return false;
+  }
+  if (column.unbounded_) {
+    return true;
+  }
+  if (strcmp(op, "=") == 0) {
+    return column.min_->CompareLessThanEquals(value) == CmpBool::kTrue &&
+           column.max_->CompareGreaterThanEquals(value) == CmpBool::kTrue;
+  } else if (strcmp(op, "<>") == 0) {
+    return !(column.min_->CompareEquals(value) == CmpBool::kTrue &&
+             column.max_->CompareEquals(value) == CmpBool::kTrue);
+  } else if (strcmp(op, ">") == 0) {
+    return column.max_->CompareGreaterThan(value) == CmpBool::kTrue;
+  } else if (strcmp(op, ">=") == 0) {
+    return column.max_->CompareGreaterThanEquals(value) == CmpBool::kTrue;
+  } else if (strcmp(op, "<") == 0) {
+    return column.min_->CompareLessThan(value) == CmpBool::kTrue;
+  } else if (strcmp(op, "<=") == 0) {
+    return column.min_->CompareLessThanEquals(value) == CmpBool::kTrue;
+  }
+  return true;
+}
+
+uint32_t ZoneMap::GetRowCount(page_id_t page_id) const {
+  auto iter = zones_.find(page_id);
+  return iter == zones_.end() ? 0 : iter->second.row_count_;
+}
@@ -0,0 +1,74 @@
+#include "utils/crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define CRC32C_X86
+#endif
+
+// Castagnoli 多项式的反射形式
+static constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+struct Crc32cTable {
+  uint32_t entries_[256];
+
+  constexpr Crc32cTable() : entries_() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++) {
+        crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLY : 0);
+      }
+      entries_[i] = crc;
+    }
+  }
+};
+
+static constexpr Crc32cTable CRC32C_TABLE;
+
+uint32_t Crc32c::ComputeSoftware(const char *data, size_t len) {
+  uint32_t crc = ~0u;
+  for (size_t i = 0; i < len; i++) {
+    crc = CRC32C_TABLE.entries_[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+#ifdef CRC32C_X86
+
+__attribute__((target("sse4.2")))
+static uint32_t ComputeSse42(const char *data, size_t len) {
+  uint64_t crc = ~0u;
+  size_t i = 0;
+  // 每条指令处理 8 字节，剩余部分逐字节处理
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    crc = _mm_crc32_u64(crc, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc);
+  for (; i < len; i++) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(data[i]));
+  }
+  return ~crc32;
+}
+
+#endif  // CRC32C_X86
+
+bool Crc32c::UseSse42() {
+#ifdef CRC32C_X86
+  static const bool use_sse42 = __builtin_cpu_supports("sse4.2");
+  return use_sse42;
+#else
+  return false;
+#endif
+}
+
+uint32_t Crc32c::Compute(const char *data, size_t len) {
+#ifdef CRC32C_X86
+  if (UseSse42()) {
+    return ComputeSse42(data, len);
+  }
+#endif
+  return ComputeSoftware(data, len);
+}
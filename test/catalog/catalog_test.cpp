@@ -105,7 +105,8 @@ TEST(CatalogTest, CatalogIndexTest) {
   std::vector<Column *> columns = {
           ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
           ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
-          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false),
+          ALLOC_COLUMN(heap)("bio", TypeId::kTypeChar, 300, 3, true, false)
   };
   auto schema = std::make_shared<Schema>(columns);
   Transaction txn;
@@ -119,6 +120,10 @@ TEST(CatalogTest, CatalogIndexTest) {
   ASSERT_EQ(DB_TABLE_NOT_EXIST, r1);
   auto r2 = catalog_01->CreateIndex("table-1", "index-1", bad_index_keys, &txn, index_info);
   ASSERT_EQ(DB_COLUMN_NAME_NOT_EXIST, r2);
+  // a key which does not fit any key type is rejected and nothing is registered
+  std::vector<std::string> long_index_keys{"id", "bio"};
+  ASSERT_EQ(DB_KEY_TOO_LONG, catalog_01->CreateIndex("table-1", "index-1", long_index_keys, &txn, index_info));
+  ASSERT_EQ(DB_INDEX_NOT_FOUND, catalog_01->GetIndex("table-1", "index-1", index_info));
   auto r3 = catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info);
   ASSERT_EQ(DB_SUCCESS, r3);
   for (int i = 0; i < 10; i++) {
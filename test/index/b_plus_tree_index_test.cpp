@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <random>
+#include <set>
 #include <string>
 
 #include "common/instance.h"
@@ -34,6 +37,86 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   ASSERT_EQ(0, comparator(k1, k2));
 }
 
+TEST(BPlusTreeTests, BPlusTreeIndexKeyOrderTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("i", TypeId::kTypeInt, 0, true, false),
+          ALLOC_COLUMN(heap)("f", TypeId::kTypeFloat, 1, true, false),
+          ALLOC_COLUMN(heap)("b", TypeId::kTypeBigInt, 2, true, false),
+          ALLOC_COLUMN(heap)("d", TypeId::kTypeDouble, 3, true, false),
+          ALLOC_COLUMN(heap)("c", TypeId::kTypeChar, 8, 4, true, false)
+  };
+  const TableSchema table_schema(columns);
+  std::mt19937 rng(2022);
+  auto random_field = [&](TypeId type) {
+    switch (rng() % 8 == 0 ? kTypeInvalid : type) {
+      case kTypeInt:
+        return Field(type, static_cast<int32_t>(rng() % 21) - 10);
+      case kTypeFloat:
+        return Field(type, static_cast<float>(static_cast<int32_t>(rng() % 21) - 10) / 4);
+      case kTypeBigInt:
+        return Field(type, (static_cast<int64_t>(rng() % 5) - 2) << 40);
+      case kTypeDouble:
+        return Field(type, rng() % 10 == 0 ? -0.0 : static_cast<double>(static_cast<int32_t>(rng() % 21) - 10) / 3);
+      default: {
+        if (type != kTypeChar)
+          return Field(type);
+        // short values over a tiny alphabet, padded to the column length like stored values
+        char buf[8] = {0};
+        uint32_t len = rng() % 4;
+        for (uint32_t i = 0; i < len; i++) {
+          buf[i] = static_cast<char>('a' + rng() % 2);
+        }
+        return Field(type, buf, 8, true);
+      }
+    }
+  };
+  // the order of encoded keys is the order of the fields, null first
+  auto field_cmp = [](const Field &lhs, const Field &rhs) {
+    if (lhs.IsNull() || rhs.IsNull())
+      return static_cast<int>(!lhs.IsNull()) - static_cast<int>(!rhs.IsNull());
+    if (lhs.CompareLessThan(rhs) == CmpBool::kTrue)
+      return -1;
+    return lhs.CompareGreaterThan(rhs) == CmpBool::kTrue ? 1 : 0;
+  };
+  auto sign = [](int cmp) { return (cmp > 0) - (cmp < 0); };
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    for (uint32_t j = i; j < columns.size(); j++) {
+      std::vector<uint32_t> key_map{i, j};
+      auto *key_schema = Schema::ShallowCopySchema(&table_schema, key_map, &heap);
+      INDEX_COMPARATOR_TYPE comparator(key_schema);
+      for (int k = 0; k < 2000; k++) {
+        std::vector<Field> lhs_fields{random_field(columns[i]->GetType()), random_field(columns[j]->GetType())};
+        std::vector<Field> rhs_fields{random_field(columns[i]->GetType()), random_field(columns[j]->GetType())};
+        int expected = field_cmp(lhs_fields[0], rhs_fields[0]);
+        if (expected == 0)
+          expected = field_cmp(lhs_fields[1], rhs_fields[1]);
+        INDEX_KEY_TYPE lhs, rhs;
+        lhs.SerializeFromKey(Row(lhs_fields), key_schema);
+        rhs.SerializeFromKey(Row(rhs_fields), key_schema);
+        ASSERT_EQ(expected, sign(comparator(lhs, rhs)));
+      }
+    }
+  }
+  // embedded zeros of a varchar are escaped
+  auto *varchar = ALLOC_COLUMN(heap)("v", TypeId::kTypeVarchar, 8, 0, true, false);
+  const TableSchema varchar_schema(std::vector<Column *>{varchar});
+  std::vector<uint32_t> key_map{0};
+  auto *key_schema = Schema::ShallowCopySchema(&varchar_schema, key_map, &heap);
+  std::vector<Field> a{Field(kTypeVarchar, const_cast<char *>("a"), 1, true)};
+  std::vector<Field> b{Field(kTypeVarchar, const_cast<char *>("a\0b"), 3, true)};
+  std::vector<Field> c{Field(kTypeVarchar, const_cast<char *>("a\x01"), 2, true)};
+  INDEX_KEY_TYPE ka, kb, kc;
+  ka.SerializeFromKey(Row(a), key_schema);
+  kb.SerializeFromKey(Row(b), key_schema);
+  kc.SerializeFromKey(Row(c), key_schema);
+  INDEX_COMPARATOR_TYPE comparator(key_schema);
+  ASSERT_LT(comparator(ka, kb), 0);
+  ASSERT_LT(comparator(kb, kc), 0);
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   using INDEX_KEY_TYPE = GenericKey<32>;
   using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
@@ -78,4 +161,314 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     ASSERT_EQ(i, (*iter).second.GetSlotNum());
     i++;
   }
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BPlusTreeIndexKeyTypeTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("ts", TypeId::kTypeTimestamp, 1, false, false),
+          ALLOC_COLUMN(heap)("score", TypeId::kTypeInt, 2, true, false),
+          ALLOC_COLUMN(heap)("code", TypeId::kTypeChar, 10, 3, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 4, true, false),
+          ALLOC_COLUMN(heap)("note", TypeId::kTypeVarchar, 255, 5, true, false)
+  };
+  const TableSchema table_schema(columns);
+  auto key_type = [&](std::vector<uint32_t> key_map) {
+    return ChooseIndexKeyType(Schema::ShallowCopySchema(&table_schema, key_map, &heap));
+  };
+  ASSERT_EQ(kKeyInt32, key_type({0}));
+  ASSERT_EQ(kKeyInt64, key_type({1}));
+  // a nullable integer needs the null flag of the generic encoding
+  ASSERT_EQ(kKeyGeneric8, key_type({2}));
+  ASSERT_EQ(kKeyGeneric16, key_type({3}));
+  ASSERT_EQ(kKeyGeneric32, key_type({0, 3}));
+  ASSERT_EQ(kKeyGeneric128, key_type({0, 4}));
+  ASSERT_EQ(kKeyInvalid, key_type({4, 5}));
+  // an integer key index behaves like a generic key index
+  using BP_TREE_INDEX = BPlusTreeIndex<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>>;
+  DBStorageEngine engine(db_name);
+  std::vector<uint32_t> index_key_map{0};
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  const int n = 2000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i - n / 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(2022));
+  for (auto key : keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(key + n, 0), nullptr));
+  }
+  std::vector<Field> duplicate{Field(TypeId::kTypeInt, keys[0])};
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(Row(duplicate), RowId(0, 1), nullptr));
+  int expected = -n / 2;
+  for (auto iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter) {
+    ASSERT_EQ(expected, (*iter).first.value_);
+    ASSERT_EQ(expected + n, (*iter).second.GetPageId());
+    expected++;
+  }
+  ASSERT_EQ(n / 2, expected);
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBulkLoadTest) {
+  using BP_TREE_INDEX = BPlusTreeIndex<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)
+  };
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> index_key_map{0};
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  const int n = 5000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(2022));
+  auto scan = [&](const IndexEntryEmitter &emit) {
+    for (int i = 0; i < n; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+      emit(Row(fields), RowId(keys[i], 0));
+      // a duplicated key keeps the entry scanned first
+      if (i % 7 == 0) {
+        emit(Row(fields), RowId(keys[i], 1));
+      }
+    }
+  };
+  // sorted in memory, then with runs of 100 entries spilled to temporary files
+  std::vector<size_t> budgets{INDEX_BULK_LOAD_MEMORY, 100 * sizeof(std::pair<IntegerKey<int32_t>, RowId>)};
+  for (index_id_t index_id = 0; index_id < budgets.size(); index_id++) {
+    auto *index = ALLOC(heap, BP_TREE_INDEX)(index_id, index_schema, engine.bpm_);
+    ASSERT_EQ(DB_SUCCESS, index->BulkLoad(scan, nullptr, 0.7, budgets[index_id]));
+    ASSERT_EQ(DB_FAILED, index->BulkLoad(scan, nullptr));
+    int expected = 0;
+    for (auto iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter) {
+      ASSERT_EQ(expected, (*iter).first.value_);
+      ASSERT_EQ(RowId(expected, 0).Get(), (*iter).second.Get());
+      expected++;
+    }
+    ASSERT_EQ(n, expected);
+    // the bulk loaded tree grows and shrinks as usual
+    for (int i = n; i < 2 * n; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i, 0), nullptr));
+    }
+    for (int i = 0; i < 2 * n; i += 2) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+      ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(i, 0), nullptr));
+    }
+    for (int i = 0; i < 2 * n; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+      std::vector<RowId> result;
+      ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(Row(fields), result, nullptr));
+    }
+    ASSERT_EQ(engine.bpm_->CheckAllUnpinned(), true);
+  }
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexNonUniqueTest) {
+  using BP_TREE_INDEX = BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16>>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("score", TypeId::kTypeInt, 0, false, false)
+  };
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> index_key_map{0};
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  // the row id is appended to the key of a non-unique index
+  ASSERT_EQ(kKeyInt32, ChooseIndexKeyType(index_schema));
+  ASSERT_EQ(kKeyGeneric16, ChooseIndexKeyType(index_schema, false));
+  const int n = 500, dup = 3;
+  std::vector<std::pair<int, RowId>> entries;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < dup; j++) {
+      entries.emplace_back(i - n / 2, RowId(i, j));
+    }
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(2022));
+  auto check = [&](BP_TREE_INDEX *index, int removed_slot) {
+    for (int i = 0; i < n; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i - n / 2)};
+      std::vector<RowId> result;
+      ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(fields), result, nullptr));
+      // all the entries of a key are returned in row id order
+      std::vector<RowId> expected;
+      for (int j = 0; j < dup; j++) {
+        if (i % 2 != 0 || j != removed_slot)
+          expected.emplace_back(i, j);
+      }
+      ASSERT_EQ(expected.size(), result.size());
+      for (size_t j = 0; j < expected.size(); j++) {
+        ASSERT_EQ(expected[j].Get(), result[j].Get());
+      }
+    }
+    std::vector<Field> missing{Field(TypeId::kTypeInt, n)};
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(Row(missing), result, nullptr));
+  };
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_, false);
+  for (auto &entry : entries) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, entry.first)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), entry.second, nullptr));
+  }
+  check(index, -1);
+  // only the entry of the given row id is removed
+  for (int i = 0; i < n; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i - n / 2)};
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(i, 1), nullptr));
+  }
+  check(index, 1);
+  // bulk loading keeps the duplicated keys
+  auto *loaded = ALLOC(heap, BP_TREE_INDEX)(1, index_schema, engine.bpm_, false);
+  ASSERT_EQ(DB_SUCCESS, loaded->BulkLoad([&](const IndexEntryEmitter &emit) {
+    for (auto &entry : entries) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, entry.first)};
+      emit(Row(fields), entry.second);
+    }
+  }, nullptr));
+  check(loaded, -1);
+  ASSERT_EQ(engine.bpm_->CheckAllUnpinned(), true);
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRangeScanTest) {
+  using BP_TREE_INDEX = BPlusTreeIndex<IntegerKey<int32_t>, RowId, IntegerComparator<int32_t>>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)
+  };
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> index_key_map{0};
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  // even keys only, so that bounds fall both on and between keys
+  const int n = 3000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(2 * i);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(2022));
+  for (auto key : keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(key, 0), nullptr));
+  }
+  // remove a third of the keys so that leaves are merged
+  std::set<int> present;
+  for (auto key : keys) {
+    if (key % 3 == 0) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+      ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(key, 0), nullptr));
+    } else {
+      present.insert(key);
+    }
+  }
+  auto check = [&](const int *lo, bool lo_inclusive, const int *hi, bool hi_inclusive, bool reverse) {
+    std::vector<int> expected;
+    for (auto key : present) {
+      if ((!lo || key > *lo || (lo_inclusive && key == *lo)) && (!hi || key < *hi || (hi_inclusive && key == *hi)))
+        expected.push_back(key);
+    }
+    if (reverse)
+      std::reverse(expected.begin(), expected.end());
+    std::vector<Field> lo_fields{Field(TypeId::kTypeInt, lo ? *lo : 0)};
+    std::vector<Field> hi_fields{Field(TypeId::kTypeInt, hi ? *hi : 0)};
+    Row lo_row(lo_fields), hi_row(hi_fields);
+    size_t i = 0;
+    for (auto iter = index->ScanRange(lo ? &lo_row : nullptr, lo_inclusive, hi ? &hi_row : nullptr, hi_inclusive,
+                                      reverse);
+         iter != index->GetEndIterator(); ++iter) {
+      ASSERT_LT(i, expected.size());
+      ASSERT_EQ(expected[i], (*iter).first.value_);
+      ASSERT_EQ(RowId(expected[i], 0).Get(), (*iter).second.Get());
+      i++;
+    }
+    ASSERT_EQ(expected.size(), i);
+  };
+  std::vector<int> bounds{-1, 0, 1, 2, 4, 999, 1000, 1001, 2 * n - 2, 2 * n - 1, 2 * n};
+  for (bool reverse : {false, true}) {
+    check(nullptr, true, nullptr, true, reverse);
+    for (auto lo : bounds) {
+      for (bool lo_inclusive : {false, true}) {
+        check(&lo, lo_inclusive, nullptr, true, reverse);
+        check(nullptr, true, &lo, lo_inclusive, reverse);
+        for (auto hi : bounds) {
+          for (bool hi_inclusive : {false, true}) {
+            check(&lo, lo_inclusive, &hi, hi_inclusive, reverse);
+          }
+        }
+      }
+    }
+  }
+  ASSERT_EQ(engine.bpm_->CheckAllUnpinned(), true);
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexPrefixScanTest) {
+  using BP_TREE_INDEX = BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("tenant_id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("created_at", TypeId::kTypeBigInt, 1, true, false)
+  };
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> index_key_map{0, 1};
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  const int tenants = 20, n = 100;
+  // created_at of the entry, the first one of every tenant is null
+  auto created_at = [](int i) { return static_cast<int64_t>(i) * 3 - 100; };
+  for (bool unique : {true, false}) {
+    auto *index = ALLOC(heap, BP_TREE_INDEX)(unique, index_schema, engine.bpm_, unique);
+    std::vector<std::pair<int, int>> entries;
+    for (int t = 0; t < tenants; t++) {
+      for (int i = 0; i < n; i++) {
+        entries.emplace_back(t - tenants / 2, i);
+      }
+    }
+    std::shuffle(entries.begin(), entries.end(), std::mt19937(2022));
+    for (auto &entry : entries) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, entry.first),
+                                entry.second == 0 ? Field(TypeId::kTypeBigInt)
+                                                  : Field(TypeId::kTypeBigInt, created_at(entry.second))};
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(entry.first + tenants / 2, entry.second), nullptr));
+    }
+    for (int t = 0; t < tenants; t++) {
+      int tenant = t - tenants / 2;
+      // equality on the first column returns all entries of the tenant in key order
+      std::vector<Field> prefix{Field(TypeId::kTypeInt, tenant)};
+      std::vector<RowId> result;
+      ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(prefix), result, nullptr));
+      ASSERT_EQ(static_cast<size_t>(n), result.size());
+      for (int i = 0; i < n; i++) {
+        ASSERT_EQ(RowId(t, i).Get(), result[i].Get());
+      }
+      // tenant_id = t and created_at between a range, the bounds fall on and between keys
+      for (int lo = 0; lo < n; lo += 17) {
+        for (int hi = lo; hi < n; hi += 13) {
+          std::vector<Field> lo_fields{Field(TypeId::kTypeInt, tenant), Field(TypeId::kTypeBigInt, created_at(lo))};
+          std::vector<Field> hi_fields{Field(TypeId::kTypeInt, tenant), Field(TypeId::kTypeBigInt, created_at(hi) + 1)};
+          Row lo_row(lo_fields), hi_row(hi_fields);
+          int expected = std::max(lo + 1, 1);
+          for (auto iter = index->ScanRange(&lo_row, false, &hi_row, false); iter != index->GetEndIterator();
+               ++iter) {
+            ASSERT_EQ(RowId(t, expected).Get(), (*iter).second.Get());
+            expected++;
+          }
+          ASSERT_EQ(hi + 1, expected);
+        }
+      }
+      // the range of a prefix bound covers all entries starting with it
+      Row prefix_row(prefix);
+      int expected = n - 1;
+      for (auto iter = index->ScanRange(&prefix_row, true, &prefix_row, true, true); iter != index->GetEndIterator();
+           ++iter) {
+        ASSERT_EQ(RowId(t, expected).Get(), (*iter).second.Get());
+        expected--;
+      }
+      ASSERT_EQ(-1, expected);
+    }
+  }
+  ASSERT_EQ(engine.bpm_->CheckAllUnpinned(), true);
+}
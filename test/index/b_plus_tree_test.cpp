@@ -1,7 +1,10 @@
+#include <thread>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/b_plus_tree.h"
 #include "index/basic_comparator.h"
+#include "index/generic_key.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -67,4 +70,221 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans, nullptr, idx));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, ConcurrentTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  // small pages so that splits and merges reach the root
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 6, 6);
+  const int n = 4000;
+  const int num_threads = 4;
+  std::atomic<bool> done{false};
+  std::atomic<bool> failed{false};
+  // readers must always find the even keys, which are never removed, and a
+  // full scan in either direction must return them in order however the
+  // leaves change under it
+  auto reader = [&](int seed) {
+    std::mt19937 rng(seed);
+    while (!done) {
+      int key = static_cast<int>(rng() % (n / 2)) * 2;
+      vector<int> result;
+      int idx;
+      if (!tree.GetValue(key, result, nullptr, idx) || result[0] != key)
+        failed = true;
+      int last = -1;
+      int even = 0;
+      for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+        if ((*iter).first <= last)
+          failed = true;
+        last = (*iter).first;
+        even += last % 2 == 0;
+      }
+      if (even != n / 2)
+        failed = true;
+      last = n;
+      even = 0;
+      for (auto iter = tree.Range(nullptr, true, nullptr, true, true); iter != tree.End(); ++iter) {
+        if ((*iter).first >= last)
+          failed = true;
+        last = (*iter).first;
+        even += last % 2 == 0;
+      }
+      if (even != n / 2)
+        failed = true;
+    }
+  };
+  auto run = [&](const std::function<void(int)> &writer) {
+    done = false;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; t++)
+      threads.emplace_back(reader, t);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < num_threads; t++)
+      writers.emplace_back(writer, t);
+    for (auto &thread : writers)
+      thread.join();
+    done = true;
+    for (auto &thread : threads)
+      thread.join();
+  };
+  // insert even keys first, so that readers always find them
+  for (int i = 0; i < n; i += 2)
+    tree.Insert(i, i);
+  run([&](int t) {
+    vector<int> keys;
+    for (int i = 1 + 2 * t; i < n; i += 2 * num_threads)
+      keys.push_back(i);
+    ShuffleArray(keys);
+    for (auto key : keys)
+      tree.Insert(key, key);
+  });
+  ASSERT_FALSE(failed);
+  ASSERT_TRUE(tree.Check());
+  int count = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(count, (*iter).first);
+    count++;
+  }
+  ASSERT_EQ(n, count);
+  // remove the odd keys concurrently
+  run([&](int t) {
+    vector<int> keys;
+    for (int i = 1 + 2 * t; i < n; i += 2 * num_threads)
+      keys.push_back(i);
+    ShuffleArray(keys);
+    for (auto key : keys)
+      tree.Remove(key);
+  });
+  ASSERT_FALSE(failed);
+  ASSERT_TRUE(tree.Check());
+  count = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ(count * 2, (*iter).first);
+    count++;
+  }
+  ASSERT_EQ(n / 2, count);
+  // the prev links of the leaves are kept by splits and merges
+  for (auto iter = tree.Range(nullptr, true, nullptr, true, true); iter != tree.End(); ++iter) {
+    count--;
+    ASSERT_EQ(count * 2, (*iter).first);
+  }
+  ASSERT_EQ(0, count);
+}
+
+TEST(BPlusTreeTests, VariableLengthKeyTest) {
+  using KeyType = GenericKey<64>;
+  using Tree = BPlusTree<KeyType, RowId, GenericComparator<64>>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, RowId, GenericComparator<64>>;
+  DBStorageEngine engine(db_name);
+  GenericComparator<64> comparator(nullptr);
+  Tree tree(0, engine.bpm_, comparator);
+  // byte ordered keys of different lengths sharing long prefixes
+  auto make_key = [](int i) {
+    KeyType key;
+    memset(key.data, 0, sizeof(key.data));
+    snprintf(key.data, sizeof(key.data), "tenant-%02d/customer-%06d%s", i % 7, i, i % 3 ? "" : "/archived");
+    return key;
+  };
+  auto less = [&](int lhs, int rhs) { return comparator(make_key(lhs), make_key(rhs)) < 0; };
+  // count the leaves and check the order of all keys
+  auto scan = [&](Tree &t, const vector<int> &expected) {
+    vector<int> sorted = expected;
+    std::sort(sorted.begin(), sorted.end(), less);
+    size_t pos = 0;
+    for (auto iter = t.Begin(); iter != t.End(); ++iter, ++pos) {
+      EXPECT_LT(pos, sorted.size());
+      if (pos >= sorted.size())
+        break;
+      EXPECT_EQ(0, comparator((*iter).first, make_key(sorted[pos])));
+      EXPECT_EQ(sorted[pos], (*iter).second.GetPageId());
+    }
+    EXPECT_EQ(sorted.size(), pos);
+    uint64_t version;
+    Page *page = t.FindLeafPage(KeyType{}, version, true);
+    int leaves = 0;
+    while (page != nullptr) {
+      leaves++;
+      page_id_t next = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+      engine.bpm_->UnpinPage(page->GetPageId(), false);
+      page = next == INVALID_PAGE_ID ? nullptr : engine.bpm_->FetchPage(next);
+    }
+    return leaves;
+  };
+  const int n = 20000;
+  vector<int> keys;
+  for (int i = 0; i < n; i++)
+    keys.push_back(i);
+  ShuffleArray(keys);
+  for (auto i : keys)
+    ASSERT_TRUE(tree.Insert(make_key(i), RowId(i, 0)));
+  ASSERT_FALSE(tree.Insert(make_key(keys[0]), RowId(0, 0)));
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    vector<RowId> result;
+    int idx;
+    ASSERT_TRUE(tree.GetValue(make_key(i), result, nullptr, idx));
+    ASSERT_EQ(i, result[0].GetPageId());
+  }
+  // truncated prefixes hold more keys in a leaf than pairs of fixed length
+  int fixed_per_leaf = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(RowId)) - 1;
+  int leaves = scan(tree, keys);
+  ASSERT_LT(leaves, n / fixed_per_leaf);
+  // remove three quarters of the keys, the pages left must still be found
+  vector<int> kept(keys.begin() + 3 * n / 4, keys.end());
+  for (int i = 0; i < 3 * n / 4; i++)
+    tree.Remove(make_key(keys[i]));
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i += 7) {
+    vector<RowId> result;
+    int idx;
+    bool removed = std::find(kept.begin(), kept.end(), i) == kept.end();
+    ASSERT_EQ(!removed, tree.GetValue(make_key(i), result, nullptr, idx));
+  }
+  ASSERT_LT(scan(tree, kept), leaves / 2);
+  // bulk loading fills the pages by bytes
+  Tree loaded(1, engine.bpm_, comparator);
+  vector<int> sorted = keys;
+  std::sort(sorted.begin(), sorted.end(), less);
+  size_t pos = 0;
+  ASSERT_TRUE(loaded.BulkLoad(n, [&](std::pair<KeyType, RowId> &item) {
+    item.first = make_key(sorted[pos]);
+    item.second = RowId(sorted[pos++], 0);
+    return true;
+  }, 1.0));
+  ASSERT_TRUE(loaded.Check());
+  ASSERT_LE(scan(loaded, keys), leaves);
+  for (int i = 0; i < n; i += 13) {
+    vector<RowId> result;
+    int idx;
+    ASSERT_TRUE(loaded.GetValue(make_key(i), result, nullptr, idx));
+    ASSERT_EQ(i, result[0].GetPageId());
+  }
+}
+
+TEST(BPlusTreeTests, BulkLoadOutOfPagesTest) {
+  // a pool too small to pin one page of every level while loading a tree of several levels
+  DBStorageEngine engine(db_name, true, 3);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 4, 4);
+  // the lowest free page, pages of the partial tree are allocated from it
+  page_id_t first_page_id;
+  ASSERT_NE(nullptr, engine.bpm_->NewPage(first_page_id));
+  engine.bpm_->UnpinPage(first_page_id, false);
+  ASSERT_TRUE(engine.bpm_->DeletePage(first_page_id));
+  const int n = 100;
+  int pos = 0;
+  ASSERT_FALSE(tree.BulkLoad(n, [&](std::pair<int, int> &item) {
+    item = {pos, pos};
+    pos++;
+    return true;
+  }, 1.0));
+  ASSERT_TRUE(tree.IsEmpty());
+  for (page_id_t page_id = first_page_id; page_id < first_page_id + 8; page_id++)
+    ASSERT_TRUE(engine.bpm_->IsPageFree(page_id)) << "page " << page_id;
+  // the root latch is released, the tree is still usable
+  ASSERT_TRUE(tree.Insert(1, 1));
+  vector<int> result;
+  int idx;
+  ASSERT_TRUE(tree.GetValue(1, result, nullptr, idx));
+  ASSERT_EQ(1, result[0]);
+}
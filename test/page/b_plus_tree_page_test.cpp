@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "index/basic_comparator.h"
+#include "index/generic_key.h"
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "utils/utils.h"
+
+// sorted distinct keys including the extremes of T, and probes around each of them
+template<typename T>
+static void MakeKeys(int size, std::vector<T> &keys, std::vector<T> &probes) {
+  std::set<T> set{std::numeric_limits<T>::min(), std::numeric_limits<T>::max()};
+  while (static_cast<int>(set.size()) < size)
+    set.insert(static_cast<T>(RandomUtils::RandomInt(-1000000, 1000000)) * 3);
+  keys.assign(set.begin(), set.end());
+  keys.resize(std::min<size_t>(size, keys.size()));
+  probes = {std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), 0};
+  for (auto key : keys) {
+    probes.push_back(key);
+    if (key != std::numeric_limits<T>::min())
+      probes.push_back(key - 1);
+    if (key != std::numeric_limits<T>::max())
+      probes.push_back(key + 1);
+  }
+}
+
+TEST(PageTests, LeafPageKeyIndexTest) {
+  using KeyType = int;
+  using ValueType = int;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, BasicComparator<int>>;
+  char *buf = new char[PAGE_SIZE];
+  auto *leaf = reinterpret_cast<LeafPage *>(buf);
+  BasicComparator<int> comparator;
+  for (int size : {0, 1, 2, 7, 8, 9, 16, 17, 31, 100, static_cast<int>(LEAF_PAGE_SIZE) + 1}) {
+    std::vector<int> keys, probes;
+    MakeKeys(size, keys, probes);
+    leaf->Init(0);
+    for (auto key : keys)
+      ASSERT_TRUE(leaf->Append(key, key / 3));
+    for (auto probe : probes) {
+      int expected = static_cast<int>(std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin());
+      ASSERT_EQ(expected, leaf->KeyIndex(probe, comparator)) << "size " << size << " probe " << probe;
+      int value;
+      int index;
+      bool found = std::binary_search(keys.begin(), keys.end(), probe);
+      ASSERT_EQ(found, leaf->Lookup(probe, value, comparator, index));
+      if (found) {
+        ASSERT_EQ(probe / 3, value);
+      }
+    }
+  }
+  delete[] buf;
+}
+
+TEST(PageTests, InternalPageLookupTest) {
+  using KeyType = IntegerKey<int64_t>;
+  using ValueType = page_id_t;
+  using InternalPage = BPlusTreeInternalPage<KeyType, ValueType, IntegerComparator<int64_t>>;
+  char *buf = new char[PAGE_SIZE];
+  auto *internal = reinterpret_cast<InternalPage *>(buf);
+  IntegerComparator<int64_t> comparator(nullptr);
+  for (int size : {1, 2, 3, 4, 5, 8, 9, 33, 100, static_cast<int>(INTERNAL_PAGE_SIZE) + 1}) {
+    std::vector<int64_t> keys, probes;
+    MakeKeys(size, keys, probes);
+    internal->Init(0);
+    for (int i = 0; i < size; i++) {
+      KeyType key;
+      key.value_ = keys[i];
+      ASSERT_TRUE(internal->Append(key, i));
+    }
+    // the first key is ignored, the child is the last one whose key <= probe
+    for (auto probe : probes) {
+      int expected = static_cast<int>(std::upper_bound(keys.begin() + 1, keys.end(), probe) - keys.begin()) - 1;
+      KeyType key;
+      key.value_ = probe;
+      ASSERT_EQ(expected, internal->Lookup(key, comparator)) << "size " << size << " probe " << probe;
+    }
+  }
+  delete[] buf;
+}
@@ -0,0 +1,51 @@
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "page/table_page.h"
+
+TEST(PageTests, TablePageSlotReuseTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto page = std::make_unique<TablePage>();
+  page->Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  // fill the page with small rows
+  uint32_t slot_count = 0;
+  while (true) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, static_cast<int32_t>(slot_count))};
+    Row row(fields);
+    if (!page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr))
+      break;
+    ASSERT_EQ(slot_count, row.GetRowId().GetSlotNum());
+    slot_count++;
+  }
+  ASSERT_GT(slot_count, 64);
+  // free every third slot, one of them is only marked as deleted
+  for (uint32_t i = 0; i < slot_count; i += 3) {
+    ASSERT_TRUE(page->MarkDelete(RowId(0, i), nullptr, nullptr, nullptr));
+    if (i != 66)
+      page->ApplyDelete(RowId(0, i), nullptr, nullptr);
+  }
+  RowId rid;
+  uint32_t visible = 0;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    ASSERT_NE(0, rid.GetSlotNum() % 3);
+    visible++;
+  }
+  ASSERT_EQ(slot_count - (slot_count + 2) / 3, visible);
+  // freed slots are reused from the lowest one, the marked slot is skipped
+  for (uint32_t i = 0; i < slot_count; i += 3) {
+    if (i == 66)
+      continue;
+    std::vector<Field> fields{Field(TypeId::kTypeInt, -1)};
+    Row row(fields);
+    ASSERT_TRUE(page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+    ASSERT_EQ(i, row.GetRowId().GetSlotNum());
+  }
+  page->RollbackDelete(RowId(0, 66), nullptr, nullptr);
+  Row row(RowId(0, 66));
+  ASSERT_TRUE(page->GetTuple(&row, schema.get(), nullptr, nullptr));
+  Field expect(TypeId::kTypeInt, 66);
+  ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(expect));
+}
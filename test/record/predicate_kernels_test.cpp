@@ -0,0 +1,102 @@
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "record/field.h"
+#include "record/predicate_kernels.h"
+#include "utils/utils.h"
+
+static const char *ops[] = {"=", "<>", "<", "<=", ">", ">="};
+
+static bool Expect(const Field &value, const char *op, const Field &operand) {
+  CmpBool result = CmpBool::kNull;
+  if (strcmp(op, "=") == 0) {
+    result = value.CompareEquals(operand);
+  } else if (strcmp(op, "<>") == 0) {
+    result = value.CompareNotEquals(operand);
+  } else if (strcmp(op, "<") == 0) {
+    result = value.CompareLessThan(operand);
+  } else if (strcmp(op, "<=") == 0) {
+    result = value.CompareLessThanEquals(operand);
+  } else if (strcmp(op, ">") == 0) {
+    result = value.CompareGreaterThan(operand);
+  } else if (strcmp(op, ">=") == 0) {
+    result = value.CompareGreaterThanEquals(operand);
+  }
+  return result == CmpBool::kTrue;
+}
+
+static bool TestBit(const uint64_t *bits, uint32_t idx) { return (bits[idx / 64] >> (idx % 64)) & 1; }
+
+TEST(PredicateKernelsTest, NumericKernelTest) {
+  // not a multiple of 64, so that both the vector loop and the scalar tail are used
+  const uint32_t count = 1000;
+  std::vector<int32_t> ints(count);
+  std::vector<float> floats(count);
+  std::vector<int64_t> bigints(count);
+  std::vector<double> doubles(count);
+  for (uint32_t i = 0; i < count; i++) {
+    ints[i] = RandomUtils::RandomInt(-50, 50);
+    floats[i] = static_cast<float>(ints[i]) / 4;
+    // values beyond the range of int32, so that the high half decides most comparisons
+    bigints[i] = (static_cast<int64_t>(ints[i]) << 32) + RandomUtils::RandomInt(0, 1);
+    doubles[i] = static_cast<double>(ints[i]) / 3;
+  }
+  uint64_t matches[(count + 63) / 64];
+  for (auto op : ops) {
+    Field int_operand(TypeId::kTypeInt, 7);
+    PredicateKernels::FilterInt32(ints.data(), count, ParseCompareOp(op), 7, matches);
+    for (uint32_t i = 0; i < count; i++) {
+      ASSERT_EQ(Expect(Field(TypeId::kTypeInt, ints[i]), op, int_operand), TestBit(matches, i)) << op << " " << i;
+    }
+    ASSERT_EQ(0, matches[count / 64] >> (count % 64));
+    Field float_operand(TypeId::kTypeFloat, 1.75f);
+    PredicateKernels::FilterFloat(floats.data(), count, ParseCompareOp(op), 1.75f, matches);
+    for (uint32_t i = 0; i < count; i++) {
+      ASSERT_EQ(Expect(Field(TypeId::kTypeFloat, floats[i]), op, float_operand), TestBit(matches, i)) << op << " " << i;
+    }
+    Field bigint_operand(TypeId::kTypeBigInt, (static_cast<int64_t>(7) << 32) + 1);
+    PredicateKernels::FilterInt64(bigints.data(), count, ParseCompareOp(op), (static_cast<int64_t>(7) << 32) + 1,
+                                  matches);
+    for (uint32_t i = 0; i < count; i++) {
+      ASSERT_EQ(Expect(Field(TypeId::kTypeBigInt, bigints[i]), op, bigint_operand), TestBit(matches, i)) << op << " " << i;
+    }
+    Field double_operand(TypeId::kTypeDouble, 7.0 / 3);
+    PredicateKernels::FilterDouble(doubles.data(), count, ParseCompareOp(op), 7.0 / 3, matches);
+    for (uint32_t i = 0; i < count; i++) {
+      ASSERT_EQ(Expect(Field(TypeId::kTypeDouble, doubles[i]), op, double_operand), TestBit(matches, i)) << op << " " << i;
+    }
+  }
+}
+
+TEST(PredicateKernelsTest, CharKernelTest) {
+  const uint32_t count = 300, width = 40;
+  std::vector<char> values(count * width, 0);
+  std::vector<uint32_t> offsets(count + 1, 0);
+  char operand[width];
+  memset(operand, 0, width);
+  memcpy(operand, "name-0015", 9);
+  for (uint32_t i = 0; i < count; i++) {
+    // char(n) values are padded with zeros, values differ in the first bytes and after the first 32 bytes
+    std::string name = "name-" + std::to_string(1000 + i % 50).substr(1);
+    memcpy(values.data() + i * width, name.c_str(), name.size());
+    values[i * width + 35] = static_cast<char>(i % 3 == 0);
+    offsets[i + 1] = (i + 1) * width;
+  }
+  uint64_t fixed[(count + 63) / 64], variable[(count + 63) / 64];
+  for (auto op : ops) {
+    PredicateKernels::FilterFixedChars(values.data(), width, count, ParseCompareOp(op), operand, width, fixed);
+    PredicateKernels::FilterChars(values.data(), offsets.data(), count, ParseCompareOp(op), operand, width, variable);
+    Field operand_field(TypeId::kTypeChar, operand, width, false);
+    for (uint32_t i = 0; i < count; i++) {
+      Field value(TypeId::kTypeChar, values.data() + i * width, width, false);
+      ASSERT_EQ(Expect(value, op, operand_field), TestBit(fixed, i)) << op << " " << i;
+      ASSERT_EQ(TestBit(fixed, i), TestBit(variable, i)) << op << " " << i;
+    }
+  }
+  // shorter operand, eg: a prefix
+  PredicateKernels::FilterFixedChars(values.data(), width, count, CompareOp::kGreaterThan, "name-", 5, fixed);
+  for (uint32_t i = 0; i < count; i++) {
+    ASSERT_TRUE(TestBit(fixed, i));
+  }
+}
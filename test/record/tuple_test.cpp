@@ -142,4 +142,226 @@ TEST(TupleTest, RowTest) {
     ASSERT_EQ(schema->GetColumn(i)->IsNullable(), sch->GetColumn(i)->IsNullable());
     ASSERT_EQ(schema->GetColumn(i)->GetTableInd(), sch->GetColumn(i)->GetTableInd());
   }
-}
\ No newline at end of file
+}
+TEST(TupleTest, ArenaRowTest) {
+  SimpleMemHeap heap;
+  TablePage table_page;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  const int row_nums = 50;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name-" + std::to_string(i);
+    std::vector<Field> fields = {
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  }
+  // rows decoded one after another share a single arena which is reset between rows
+  alignas(std::max_align_t) char buf[128];
+  ArenaMemHeap arena(buf, sizeof(buf), 64);
+  for (int i = 0; i < row_nums; i++) {
+    arena.Reset();
+    Row row(RowId(0, i), &arena);
+    ASSERT_TRUE(table_page.GetTuple(&row, schema.get(), nullptr, nullptr));
+    for (auto field : row.GetFields()) {
+      auto addr = reinterpret_cast<char *>(field);
+      ASSERT_TRUE(addr >= buf && addr < buf + sizeof(buf));
+    }
+    std::string name = "name-" + std::to_string(i);
+    Field expect(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false);
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(expect));
+  }
+  // allocations larger than the inline buffer spill into chunks
+  arena.Reset();
+  ASSERT_NE(nullptr, arena.Allocate(1000));
+  auto small = reinterpret_cast<char *>(arena.Allocate(8));
+  ASSERT_FALSE(small >= buf && small < buf + sizeof(buf));
+  arena.Reset();
+  small = reinterpret_cast<char *>(arena.Allocate(8));
+  ASSERT_EQ(buf, small);
+}
+
+TEST(TupleTest, RowFormatTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 0, true, false),
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 1, false, false),
+          ALLOC_COLUMN(heap)("desc", TypeId::kTypeChar, 64, 2, true, false),
+          ALLOC_COLUMN(heap)("score", TypeId::kTypeFloat, 3, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  ASSERT_FALSE(schema->GetRowCodec().IsAllFixed());
+  // version, null bitmap, int, float and 2 offset table entries
+  ASSERT_EQ(1 + 1 + 4 + 4 + 2 * 2, schema->GetRowCodec().GetFixedSize());
+  std::vector<Field> fields = {
+          Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+          Field(TypeId::kTypeInt, 188),
+          Field(TypeId::kTypeChar),
+          Field(TypeId::kTypeFloat, 19.99f)
+  };
+  Row row(fields);
+  char buf[PAGE_SIZE];
+  uint32_t size = row.SerializeTo(buf, schema.get());
+  ASSERT_EQ(schema->GetRowCodec().GetFixedSize() + strlen("minisql"), size);
+  ASSERT_EQ(size, row.GetSerializedSize(schema.get()));
+  Row row2(INVALID_ROWID);
+  ASSERT_EQ(size, row2.DeserializeFrom(buf, schema.get()));
+  ASSERT_EQ(fields.size(), row2.GetFieldCount());
+  ASSERT_TRUE(row2.GetField(2)->IsNull());
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    if (!fields[i].IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, row2.GetField(i)->CompareEquals(fields[i]));
+    }
+    // single field access does not depend on the fields before it
+    Field field(schema->GetColumn(i)->GetType());
+    schema->GetRowCodec().DecodeField(buf, i, field, false);
+    ASSERT_EQ(fields[i].IsNull(), field.IsNull());
+    if (!fields[i].IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, field.CompareEquals(fields[i]));
+    }
+  }
+  // rows written in the format without version are still readable
+  char legacy[] = {0, 0, 1, 0,
+                   3, 0, 0, 0, 'a', 'b', 'c',
+                   42, 0, 0, 0,
+                   0, 0, static_cast<char>(0x80), 0x3f};
+  Row row3(INVALID_ROWID);
+  ASSERT_EQ(sizeof(legacy), row3.DeserializeFrom(legacy, schema.get()));
+  ASSERT_EQ(3, row3.GetField(0)->GetLength());
+  ASSERT_EQ(CmpBool::kTrue, row3.GetField(1)->CompareEquals(Field(TypeId::kTypeInt, 42)));
+  ASSERT_TRUE(row3.GetField(2)->IsNull());
+  ASSERT_EQ(CmpBool::kTrue, row3.GetField(3)->CompareEquals(Field(TypeId::kTypeFloat, 1.0f)));
+}
+
+TEST(TupleTest, FixedRowCodecTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("score", TypeId::kTypeFloat, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  const RowCodec &codec = schema->GetRowCodec();
+  ASSERT_TRUE(codec.IsAllFixed());
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, -7), Field(TypeId::kTypeFloat)};
+  Row row(fields);
+  char buf[64];
+  ASSERT_EQ(codec.GetFixedSize(), row.GetSerializedSize(schema.get()));
+  ASSERT_EQ(codec.GetFixedSize(), row.SerializeTo(buf, schema.get()));
+  Row row2(INVALID_ROWID);
+  ASSERT_EQ(codec.GetFixedSize(), row2.DeserializeFrom(buf, schema.get()));
+  ASSERT_EQ(CmpBool::kTrue, row2.GetField(0)->CompareEquals(fields[0]));
+  ASSERT_TRUE(row2.GetField(1)->IsNull());
+}
+
+TEST(TupleTest, WideTypeTest) {
+  int32_t days;
+  ASSERT_TRUE(TypeDate::Parse("1970-01-01", days));
+  ASSERT_EQ(0, days);
+  ASSERT_TRUE(TypeDate::Parse("2000-02-29", days));
+  ASSERT_EQ(11016, days);
+  ASSERT_FALSE(TypeDate::Parse("2001-02-29", days));
+  ASSERT_FALSE(TypeDate::Parse("2001-1-2", days));
+  ASSERT_FALSE(TypeDate::Parse("2001-01-02x", days));
+  char text[TypeTimestamp::MAX_TEXT_LEN];
+  for (auto date : {"1969-12-31", "1900-03-01", "2024-12-31", "0001-01-01"}) {
+    ASSERT_TRUE(TypeDate::Parse(date, days));
+    TypeDate::Format(days, text);
+    ASSERT_STREQ(date, text);
+  }
+  int64_t micros;
+  ASSERT_TRUE(TypeTimestamp::Parse("1970-01-02", micros));
+  ASSERT_EQ(86400LL * 1000000, micros);
+  ASSERT_FALSE(TypeTimestamp::Parse("2024-01-01 24:00:00", micros));
+  for (auto timestamp : {"1969-12-31 23:59:59.500000", "2024-06-30 08:05:09", "2038-01-19 03:14:08.000001"}) {
+    ASSERT_TRUE(TypeTimestamp::Parse(timestamp, micros));
+    TypeTimestamp::Format(micros, text);
+    ASSERT_STREQ(timestamp, text);
+  }
+  // timestamps are ordered as their integer values
+  int64_t earlier;
+  ASSERT_TRUE(TypeTimestamp::Parse("2024-06-30 08:05:08.9", earlier));
+  ASSERT_TRUE(TypeTimestamp::Parse("2024-06-30 08:05:09", micros));
+  ASSERT_EQ(CmpBool::kTrue, Field(TypeId::kTypeTimestamp, earlier).CompareLessThan(Field(TypeId::kTypeTimestamp, micros)));
+
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeBigInt, 0, false, false),
+          ALLOC_COLUMN(heap)("amount", TypeId::kTypeDouble, 1, true, false),
+          ALLOC_COLUMN(heap)("day", TypeId::kTypeDate, 2, true, false),
+          ALLOC_COLUMN(heap)("at", TypeId::kTypeTimestamp, 3, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  ASSERT_TRUE(schema->GetRowCodec().IsAllFixed());
+  ASSERT_EQ(1 + 1 + 8 + 8 + 4 + 8, schema->GetRowCodec().GetFixedSize());
+  std::vector<Field> fields = {
+          Field(TypeId::kTypeBigInt, static_cast<int64_t>(1) << 40),
+          Field(TypeId::kTypeDouble, 0.1 + 0.2),
+          Field(TypeId::kTypeDate),
+          Field(TypeId::kTypeTimestamp, micros)
+  };
+  Row row(fields);
+  char buf[PAGE_SIZE];
+  uint32_t size = row.SerializeTo(buf, schema.get());
+  ASSERT_EQ(schema->GetRowCodec().GetFixedSize(), size);
+  Row row2(INVALID_ROWID);
+  ASSERT_EQ(size, row2.DeserializeFrom(buf, schema.get()));
+  ASSERT_TRUE(row2.GetField(2)->IsNull());
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    if (!fields[i].IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, row2.GetField(i)->CompareEquals(fields[i]));
+    }
+  }
+}
+
+TEST(TupleTest, VarcharTest) {
+  // short values owned by a field are stored in the field itself
+  char short_value[] = "minisql";
+  Field small(TypeId::kTypeVarchar, short_value, strlen(short_value), true);
+  auto begin = reinterpret_cast<const char *>(&small);
+  ASSERT_TRUE(small.GetData() >= begin && small.GetData() < begin + sizeof(Field));
+  std::string long_str(Field::INLINE_CHARS_LEN + 1, 'x');
+  Field large(TypeId::kTypeVarchar, const_cast<char *>(long_str.data()), long_str.size(), true);
+  begin = reinterpret_cast<const char *>(&large);
+  ASSERT_FALSE(large.GetData() >= begin && large.GetData() < begin + sizeof(Field));
+  // copies and swaps keep the value
+  Field copy(small);
+  ASSERT_EQ(CmpBool::kTrue, copy.CompareEquals(small));
+  Field swapped(TypeId::kTypeVarchar);
+  swapped = copy;
+  ASSERT_EQ(7, swapped.GetLength());
+  ASSERT_EQ(0, memcmp("minisql", swapped.GetData(), 7));
+  ASSERT_TRUE(copy.IsNull());
+  // a view does not copy
+  Field view(TypeId::kTypeVarchar, short_value, strlen(short_value), false);
+  ASSERT_EQ(short_value, view.GetData());
+
+  // only the actual length is stored
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeVarchar, 64, 0, true, false),
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 1, false, false),
+          ALLOC_COLUMN(heap)("desc", TypeId::kTypeVarchar, 64, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields = {
+          Field(TypeId::kTypeVarchar, short_value, strlen(short_value), true),
+          Field(TypeId::kTypeInt, 1),
+          Field(TypeId::kTypeVarchar, const_cast<char *>(long_str.data()), long_str.size(), true)
+  };
+  Row row(fields);
+  char buf[PAGE_SIZE];
+  uint32_t size = row.SerializeTo(buf, schema.get());
+  ASSERT_EQ(schema->GetRowCodec().GetFixedSize() + strlen(short_value) + long_str.size(), size);
+  Row row2(INVALID_ROWID);
+  ASSERT_EQ(size, row2.DeserializeFrom(buf, schema.get()));
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    ASSERT_EQ(fields[i].GetTypeId(), row2.GetField(i)->GetTypeId());
+    ASSERT_EQ(CmpBool::kTrue, row2.GetField(i)->CompareEquals(fields[i]));
+  }
+}
@@ -1,7 +1,11 @@
+#include <fstream>
 #include <unordered_set>
 
 #include "gtest/gtest.h"
 #include "storage/disk_manager.h"
+#include "storage/page_compressor.h"
+#include "utils/crc32c.h"
+#include "utils/utils.h"
 
 TEST(DiskManagerTest, BitMapPageTest) {
   const size_t size = 512;
@@ -55,4 +59,111 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+  remove((db_name + ".crc").c_str());
+}
+TEST(DiskManagerTest, PageCompressionTest) {
+  // a page like a slotted page: a header, short records with repeated values and free space in the middle
+  char page[PAGE_SIZE], decompressed[PAGE_SIZE], buf[PAGE_SIZE];
+  memset(page, 0, PAGE_SIZE);
+  for (uint32_t i = 0; i < 200; i++) {
+    std::string record = "id=" + std::to_string(i) + ",status=" + (i % 3 == 0 ? "open" : "closed");
+    memcpy(page + PAGE_SIZE - (i + 1) * 16, record.c_str(), std::min<size_t>(record.size(), 16));
+    MACH_WRITE_UINT32(page + 24 + i * 4, PAGE_SIZE - (i + 1) * 16);
+  }
+  uint32_t size = PageCompressor::Compress(page, buf, PAGE_SIZE);
+  ASSERT_GT(size, 0);
+  ASSERT_LT(size, PAGE_SIZE / 2);
+  ASSERT_TRUE(PageCompressor::Decompress(buf, size, decompressed));
+  ASSERT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+  ASSERT_FALSE(PageCompressor::Decompress(buf, size / 2, decompressed));
+  // random bytes do not compress
+  char random[PAGE_SIZE];
+  RandomUtils::RandomString(random, PAGE_SIZE);
+  ASSERT_EQ(0, PageCompressor::Compress(random, buf, PAGE_SIZE - DiskManager::SECTOR_SIZE));
+  // compressed pages are decompressed transparently, incompressible pages are stored as they are
+  std::string db_name = "disk_test.db";
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  page_id_t compressed = disk_mgr->AllocatePage(), plain = disk_mgr->AllocatePage();
+  disk_mgr->WritePage(compressed, page, true);
+  disk_mgr->WritePage(plain, random, true);
+  bool is_compressed;
+  ASSERT_TRUE(disk_mgr->ReadPage(compressed, decompressed, &is_compressed));
+  ASSERT_TRUE(is_compressed);
+  ASSERT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+  ASSERT_TRUE(disk_mgr->ReadPage(plain, decompressed, &is_compressed));
+  ASSERT_FALSE(is_compressed);
+  ASSERT_EQ(0, memcmp(random, decompressed, PAGE_SIZE));
+  // rewriting a compressed page as it is
+  disk_mgr->WritePage(compressed, page);
+  ASSERT_TRUE(disk_mgr->ReadPage(compressed, decompressed, &is_compressed));
+  ASSERT_FALSE(is_compressed);
+  ASSERT_EQ(0, memcmp(page, decompressed, PAGE_SIZE));
+  delete disk_mgr;
+  remove(db_name.c_str());
+  remove((db_name + ".crc").c_str());
+}
+
+TEST(DiskManagerTest, PageChecksumTest) {
+  ASSERT_EQ(0xE3069283, Crc32c::Compute("123456789", 9));
+  ASSERT_EQ(0xE3069283, Crc32c::ComputeSoftware("123456789", 9));
+  // the hardware path handles every length and alignment the same as the table
+  char random[PAGE_SIZE];
+  RandomUtils::RandomString(random, PAGE_SIZE);
+  for (uint32_t len : {0u, 1u, 7u, 8u, 13u, 100u, static_cast<uint32_t>(PAGE_SIZE) - 3}) {
+    ASSERT_EQ(Crc32c::ComputeSoftware(random + 3, len), Crc32c::Compute(random + 3, len));
+  }
+  std::string db_name = "disk_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  char page[PAGE_SIZE], buf[PAGE_SIZE];
+  memset(page, 0, PAGE_SIZE);
+  const int num_pages = 100;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id = disk_mgr->AllocatePage();
+    ASSERT_EQ(i, page_id);
+    memcpy(page, &i, sizeof(i));
+    disk_mgr->WritePage(page_id, i % 2 == 0 ? page : random, i % 4 == 0);
+  }
+  std::vector<page_id_t> corrupted;
+  ASSERT_EQ(num_pages, disk_mgr->CheckPages(corrupted, 4));
+  ASSERT_TRUE(corrupted.empty());
+  delete disk_mgr;
+  // flip a byte of a plain page and of a compressed page behind the disk manager
+  const page_id_t corrupted_ids[] = {4, 17};
+  std::fstream db_io(db_name, std::ios::binary | std::ios::in | std::ios::out);
+  for (auto page_id : corrupted_ids) {
+    // logical page i is stored in physical page i + i / BITMAP_SIZE + 2
+    db_io.seekg((page_id + 2) * PAGE_SIZE + 5);
+    char byte = static_cast<char>(db_io.get());
+    db_io.seekp((page_id + 2) * PAGE_SIZE + 5);
+    db_io.put(static_cast<char>(byte ^ 0x10));
+  }
+  db_io.close();
+  disk_mgr = new DiskManager(db_name);
+  ASSERT_FALSE(disk_mgr->ReadPage(4, buf));
+  ASSERT_FALSE(disk_mgr->ReadPage(17, buf));
+  ASSERT_TRUE(disk_mgr->ReadPage(16, buf));
+  ASSERT_EQ(0, memcmp(&buf[0], "\x10\0\0\0", 4));
+  corrupted.clear();
+  ASSERT_EQ(num_pages, disk_mgr->CheckPages(corrupted));
+  ASSERT_EQ(std::vector<page_id_t>(corrupted_ids, corrupted_ids + 2), corrupted);
+  // rewriting a page repairs it
+  disk_mgr->WritePage(4, page);
+  ASSERT_TRUE(disk_mgr->ReadPage(4, buf));
+  corrupted.clear();
+  disk_mgr->CheckPages(corrupted, 1);
+  ASSERT_EQ(1, corrupted.size());
+  delete disk_mgr;
+  // a new database file does not keep the checksums of the removed one
+  remove(db_name.c_str());
+  disk_mgr = new DiskManager(db_name);
+  ASSERT_EQ(0, disk_mgr->AllocatePage());
+  disk_mgr->WritePage(0, random);
+  ASSERT_TRUE(disk_mgr->ReadPage(0, buf));
+  corrupted.clear();
+  ASSERT_EQ(1, disk_mgr->CheckPages(corrupted));
+  ASSERT_TRUE(corrupted.empty());
+  delete disk_mgr;
+  remove(db_name.c_str());
+  remove((db_name + ".crc").c_str());
+}
@@ -1,3 +1,4 @@
+#include <map>
 #include <vector>
 #include <unordered_map>
 
@@ -5,6 +6,7 @@
 #include "gtest/gtest.h"
 #include "record/field.h"
 #include "record/schema.h"
+#include "storage/parallel_scan.h"
 #include "storage/table_heap.h"
 #include "utils/utils.h"
 
@@ -68,3 +70,426 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   remove(db_file_name.c_str());
 }
 
+
+TEST(TableHeapTest, ZoneMapPruneTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeFloat)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  auto &zone_map = table_heap->GetZoneMap();
+  ASSERT_GT(table_heap->GetPageIds().size(), 1);
+  // rows are loaded in id order, so only one page may contain a given id
+  Field key(TypeId::kTypeInt, row_nums / 2);
+  int may_match = 0, total = 0;
+  for (auto page_id : table_heap->GetPageIds()) {
+    total += zone_map.GetRowCount(page_id);
+    may_match += zone_map.MayMatch(page_id, 0, "=", key);
+    ASSERT_TRUE(zone_map.MayMatch(page_id, 1, "is", key));
+    ASSERT_FALSE(zone_map.MayMatch(page_id, 1, "not", key));
+  }
+  ASSERT_EQ(row_nums, total);
+  ASSERT_EQ(1, may_match);
+  // pruning must agree with a full scan
+  int count = 0;
+  for (auto page_id : table_heap->GetPageIds()) {
+    if (!zone_map.MayMatch(page_id, 0, ">=", key))
+      continue;
+    table_heap->ScanPage(page_id, [&](const Row &row) {
+      if (row.GetField(0)->CompareGreaterThanEquals(key) == CmpBool::kTrue)
+        count++;
+    }, nullptr);
+  }
+  ASSERT_EQ(row_nums / 2, count);
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, FreeHeapTest) {
+  // a pool much smaller than the heap, so most pages are evicted before the heap is freed
+  const uint32_t pool_size = 16;
+  DBStorageEngine engine(db_file_name, true, pool_size);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::string name(64, 'x');
+  for (int i = 0; table_heap->GetPageIds().size() < 4 * pool_size; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  auto page_ids = table_heap->GetPageIds();
+  table_heap->FreeHeap();
+  for (auto page_id : page_ids)
+    ASSERT_TRUE(engine.bpm_->IsPageFree(page_id)) << "page " << page_id;
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, PaxLayoutTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 1000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap,
+                                            kLayoutPAX);
+  std::unordered_map<int64_t, int> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name-" + std::to_string(i);
+    Fields fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+            i % 10 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, i * 0.5f)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids[row.GetRowId().Get()] = i;
+  }
+  // value longer than the declared length does not fit into the minipage
+  std::string long_name(32, 'x');
+  Fields long_fields{Field(TypeId::kTypeInt, -1),
+                     Field(TypeId::kTypeChar, const_cast<char *>(long_name.c_str()), long_name.size(), true),
+                     Field(TypeId::kTypeFloat, 0.f)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(table_heap->InsertTuple(long_row, nullptr));
+  ASSERT_EQ(row_nums, row_ids.size());
+  ASSERT_GT(table_heap->GetPageIds().size(), 1);
+  for (auto &kv : row_ids) {
+    Row row(RowId(kv.first));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    std::string name = "name-" + std::to_string(kv.second);
+    Field id(TypeId::kTypeInt, kv.second);
+    Field expect(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true);
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(id));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(expect));
+    ASSERT_EQ(kv.second % 10 == 0, row.GetField(2)->IsNull());
+  }
+  // delete every other row, then iterate and scan a single column
+  int deleted = 0;
+  for (auto &kv : row_ids) {
+    if (kv.second % 2 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(RowId(kv.first), nullptr));
+      table_heap->ApplyDelete(RowId(kv.first), nullptr);
+      deleted++;
+    }
+  }
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    ASSERT_EQ(1, row_ids[iter->GetRowId().Get()] % 2);
+    count++;
+  }
+  ASSERT_EQ(row_nums - deleted, count);
+  count = 0;
+  for (auto page_id : table_heap->GetPageIds()) {
+    table_heap->ScanColumn(page_id, 0, [&](const RowId &rid, const Field &field) {
+      Field expect(TypeId::kTypeInt, row_ids[rid.Get()]);
+      ASSERT_EQ(CmpBool::kTrue, field.CompareEquals(expect));
+      count++;
+    }, nullptr);
+  }
+  ASSERT_EQ(row_nums - deleted, count);
+  // reload the heap from its first page
+  TableHeap *loaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr,
+                                        &heap, kLayoutPAX);
+  ASSERT_EQ(table_heap->GetPageIds(), loaded->GetPageIds());
+  count = 0;
+  for (auto iter = loaded->Begin(nullptr); iter != loaded->End(); ++iter) {
+    count++;
+  }
+  ASSERT_EQ(row_nums - deleted, count);
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, ToastTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 100;
+  const uint32_t doc_len = 3 * PAGE_SIZE;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("doc", TypeId::kTypeChar, doc_len, 1, true, false),
+          ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, 16, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::unordered_map<int64_t, std::string> docs;
+  for (int i = 0; i < row_nums; i++) {
+    std::string doc(doc_len - i, 'a' + i % 26);
+    Fields fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(doc.c_str()), doc.size(), true),
+            Field(TypeId::kTypeChar, const_cast<char *>("note"), 4, true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    docs[row.GetRowId().Get()] = doc;
+  }
+  // rows only keep pointers, so many of them share a heap page
+  ASSERT_LT(table_heap->GetPageIds().size(), 3);
+  for (auto &kv : docs) {
+    Row row(RowId(kv.first));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr, false));
+    ASSERT_TRUE(row.GetField(1)->IsToasted());
+    ASSERT_FALSE(row.GetField(2)->IsToasted());
+    table_heap->Detoast(row.GetField(1));
+    ASSERT_FALSE(row.GetField(1)->IsToasted());
+    ASSERT_EQ(kv.second.size(), row.GetField(1)->GetLength());
+    ASSERT_EQ(0, memcmp(kv.second.c_str(), row.GetField(1)->GetData(), kv.second.size()));
+  }
+  // reloading rebuilds the zone map without reading overflow pages, toasted columns are never pruned
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr,
+                                          &heap);
+  std::string missing(doc_len, '~');
+  Field missing_doc(TypeId::kTypeChar, const_cast<char *>(missing.c_str()), missing.size(), true);
+  uint32_t reloaded_rows = 0;
+  for (auto page_id : reloaded->GetPageIds()) {
+    reloaded_rows += reloaded->GetZoneMap().GetRowCount(page_id);
+    ASSERT_FALSE(reloaded->GetZoneMap().MayMatch(page_id, 0, "=", Field(TypeId::kTypeInt, -1)));
+    if (reloaded->GetZoneMap().GetRowCount(page_id) > 0) {
+      ASSERT_TRUE(reloaded->GetZoneMap().MayMatch(page_id, 1, "=", missing_doc));
+      ASSERT_TRUE(reloaded->GetZoneMap().MayMatch(page_id, 1, "not", missing_doc));
+    }
+  }
+  ASSERT_EQ(row_nums, reloaded_rows);
+  // update replaces the chain, delete frees it
+  auto rid = RowId(docs.begin()->first);
+  std::string new_doc(doc_len / 2, 'z');
+  Fields new_fields{
+          Field(TypeId::kTypeInt, -1),
+          Field(TypeId::kTypeChar, const_cast<char *>(new_doc.c_str()), new_doc.size(), true),
+          Field(TypeId::kTypeChar)
+  };
+  Row new_row(new_fields);
+  Row old_row(rid);
+  ASSERT_TRUE(table_heap->GetTuple(&old_row, nullptr, false));
+  auto old_chain = old_row.GetField(1)->GetToastPointer().first_page_id_;
+  ASSERT_TRUE(table_heap->UpdateTuple(new_row, rid, nullptr));
+  ASSERT_TRUE(engine.bpm_->IsPageFree(old_chain));
+  Row updated(new_row.GetRowId());
+  ASSERT_TRUE(table_heap->GetTuple(&updated, nullptr));
+  ASSERT_EQ(new_doc.size(), updated.GetField(1)->GetLength());
+  ASSERT_TRUE(updated.GetField(2)->IsNull());
+  Row lazy(new_row.GetRowId());
+  ASSERT_TRUE(table_heap->GetTuple(&lazy, nullptr, false));
+  auto new_chain = lazy.GetField(1)->GetToastPointer().first_page_id_;
+  ASSERT_TRUE(table_heap->MarkDelete(updated.GetRowId(), nullptr));
+  table_heap->ApplyDelete(updated.GetRowId(), nullptr);
+  ASSERT_TRUE(engine.bpm_->IsPageFree(new_chain));
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, ParallelScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("balance", TypeId::kTypeFloat, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(0.f, 1000.f))};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  ASSERT_GT(table_heap->GetPageIds().size(), 2 * ParallelScan::MORSEL_SIZE);
+  Field balance(TypeId::kTypeFloat, 500.f);
+  auto predicate = [&](const Row &row) {
+    return row.GetField(1)->CompareGreaterThan(balance) == CmpBool::kTrue;
+  };
+  std::vector<RowId> expected;
+  for (auto page_id : table_heap->GetPageIds()) {
+    table_heap->ScanPage(page_id, [&](const Row &row) {
+      if (predicate(row))
+        expected.push_back(row.GetRowId());
+    }, nullptr);
+  }
+  std::sort(expected.begin(), expected.end());
+  auto all_pages = [](page_id_t) { return true; };
+  for (uint32_t workers : {1u, 4u, 16u}) {
+    ASSERT_EQ(expected, ParallelScan(table_heap, workers).Filter(all_pages, predicate, nullptr));
+    ASSERT_EQ(expected, ParallelScan(table_heap, workers).Filter(all_pages, 1, ">", balance, nullptr));
+  }
+  // skipped pages are not scanned
+  Field key(TypeId::kTypeInt, row_nums - 10);
+  auto result = ParallelScan(table_heap, 4).Filter(
+      [&](page_id_t page_id) { return table_heap->GetZoneMap().MayMatch(page_id, 0, ">=", key); },
+      [](const Row &) { return true; }, nullptr);
+  ASSERT_GE(result.size(), 10);
+  ASSERT_LT(result.size(), row_nums / 2);
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, RowBatchTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+          ALLOC_COLUMN(heap)("balance", TypeId::kTypeFloat, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name-" + std::to_string(i % 10);
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  i % 3 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  // batches filled from pages only hold the requested columns
+  RowBatch batch(schema.get(), {2, 1});
+  int batches = 0, scanned = 0, selected = 0, nulls = 0;
+  Field balance(TypeId::kTypeFloat, 1000.f);
+  Field name(TypeId::kTypeChar, const_cast<char *>("name-7"), 6, false);
+  std::vector<RowId> rids;
+  auto consume = [&](RowBatch &full) {
+    batches++;
+    scanned += full.GetSize();
+    for (uint32_t i = 0; i < full.GetSize(); i++) {
+      nulls += full.GetColumn(0).IsNull(i);
+    }
+    full.Filter(0, ">", balance);
+    full.Filter(1, "=", name);
+    for (uint32_t i = 0; i < full.GetSelectedCount(); i++) {
+      uint32_t row = full.GetSelection()[i];
+      ASSERT_GT(full.GetColumn(0).GetFloats()[row], 1000.f);
+      ASSERT_EQ(0, memcmp("name-7", full.GetColumn(1).GetChars(row), 6));
+      rids.push_back(full.GetRowId(row));
+    }
+    selected += full.GetSelectedCount();
+  };
+  for (auto page_id : table_heap->GetPageIds()) {
+    ASSERT_TRUE(table_heap->ScanBatch(page_id, batch, consume, nullptr));
+  }
+  if (batch.GetSize() > 0)
+    consume(batch);
+  ASSERT_GT(batches, 1);
+  ASSERT_EQ(row_nums, scanned);
+  ASSERT_EQ(row_nums / 3, nulls);
+  // i % 10 == 7, i > 1000 and i % 3 != 0
+  int expected = 0;
+  for (int i = 1001; i < row_nums; i++)
+    expected += i % 10 == 7 && i % 3 != 0;
+  ASSERT_EQ(expected, selected);
+  // batches filled from rids keep their order
+  batch.Reset();
+  std::reverse(rids.begin(), rids.end());
+  std::vector<RowId> fetched;
+  table_heap->FetchBatch(rids, batch, [](RowBatch &) {}, nullptr);
+  batch.Filter(1, "is", name);
+  ASSERT_EQ(0, batch.GetSelectedCount());
+  for (uint32_t i = 0; i < batch.GetSize(); i++)
+    fetched.push_back(batch.GetRowId(i));
+  ASSERT_EQ(rids, fetched);
+  remove(db_file_name.c_str());
+}
+
+TEST(TableHeapTest, DictionaryTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("region", TypeId::kTypeVarchar, 32, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  const char *regions[] = {"north", "south", "east", "west", "a-region-with-a-long-name"};
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap,
+                                            kLayoutNSM, {1});
+  for (int i = 0; i < row_nums; i++) {
+    const char *region = regions[i % 5];
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  i % 7 == 0 ? Field(TypeId::kTypeVarchar)
+                             : Field(TypeId::kTypeVarchar, const_cast<char *>(region), strlen(region), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  ASSERT_EQ(5, table_heap->GetDictionary(1)->GetSize());
+  ASSERT_EQ(nullptr, table_heap->GetDictionary(0));
+  // reload the heap, dictionaries are read back from their pages
+  auto dictionaries = table_heap->GetDictionaryColumns();
+  table_heap = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr, &heap,
+                                 kLayoutNSM, dictionaries);
+  ASSERT_EQ(5, table_heap->GetDictionary(1)->GetSize());
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    int i = count++;
+    auto region = iter->GetField(1);
+    ASSERT_EQ(TypeId::kTypeVarchar, region->GetTypeId());
+    if (i % 7 == 0) {
+      ASSERT_TRUE(region->IsNull());
+    } else {
+      ASSERT_EQ(strlen(regions[i % 5]), region->GetLength());
+      ASSERT_EQ(0, memcmp(regions[i % 5], region->GetData(), region->GetLength()));
+    }
+  }
+  ASSERT_EQ(row_nums, count);
+  // batch columns hold codes, predicates are evaluated on codes
+  RowBatch batch(schema.get(), {1});
+  std::map<std::string, int> selected;
+  Field south(TypeId::kTypeVarchar, const_cast<char *>("south"), 5, false);
+  Field missing(TypeId::kTypeVarchar, const_cast<char *>("middle"), 6, false);
+  auto consume = [&](RowBatch &full) {
+    for (const char *op : {"=", "<>", "<", ">="}) {
+      for (auto operand : {&south, &missing}) {
+        uint64_t matches[BATCH_SIZE / 64];
+        full.GetColumn(0).Filter(op, *operand, matches);
+        for (uint32_t i = 0; i < full.GetSize(); i++) {
+          selected[op + std::string(operand->GetData(), operand->GetLength())] += (matches[i / 64] >> (i % 64)) & 1;
+        }
+      }
+    }
+    ASSERT_NE(nullptr, full.GetColumn(0).GetDictionary());
+    full.Reset();
+  };
+  for (auto page_id : table_heap->GetPageIds()) {
+    ASSERT_TRUE(table_heap->ScanBatch(page_id, batch, consume, nullptr));
+  }
+  if (batch.GetSize() > 0)
+    consume(batch);
+  std::map<std::string, int> expected;
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 7 == 0)
+      continue;
+    Field value(TypeId::kTypeVarchar, const_cast<char *>(regions[i % 5]), strlen(regions[i % 5]), false);
+    for (auto operand : {&south, &missing}) {
+      std::string name(operand->GetData(), operand->GetLength());
+      expected["=" + name] += value.CompareEquals(*operand) == CmpBool::kTrue;
+      expected["<>" + name] += value.CompareNotEquals(*operand) == CmpBool::kTrue;
+      expected["<" + name] += value.CompareLessThan(*operand) == CmpBool::kTrue;
+      expected[">=" + name] += value.CompareGreaterThanEquals(*operand) == CmpBool::kTrue;
+    }
+  }
+  ASSERT_EQ(expected, selected);
+  // a new value is added to the dictionary on update
+  Fields fields{Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeVarchar, const_cast<char *>("middle"), 6, false)};
+  Row row(fields);
+  RowId rid = table_heap->Begin(nullptr)->GetRowId();
+  ASSERT_TRUE(table_heap->UpdateTuple(row, rid, nullptr));
+  ASSERT_EQ(6, table_heap->GetDictionary(1)->GetSize());
+  Row updated(row.GetRowId());
+  ASSERT_TRUE(table_heap->GetTuple(&updated, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, updated.GetField(1)->CompareEquals(missing));
+  remove(db_file_name.c_str());
+}